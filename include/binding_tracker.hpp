@@ -0,0 +1,155 @@
+#pragma once
+#include "shader_types.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Per binding list change log. Every (type, stage) descriptor range carries the list version at which it
+// was last modified, which lets a context tell which ranges changed since it last saw the list.
+class BindingVersionTable
+{
+public:
+	static constexpr uint32_t StageCount = static_cast<uint32_t>(ShaderStage::Compute) + 1;
+	static constexpr uint32_t TypeCount = static_cast<uint32_t>(ShaderParameterType::Sampler) + 1;
+	static constexpr uint32_t RangeCount = StageCount * TypeCount;
+	static constexpr uint32_t AllRanges = (1u << RangeCount) - 1;
+
+private:
+	static inline std::atomic<uint64_t> nextId = 1;
+
+	uint64_t id;
+	uint64_t version = 0;
+	uint64_t rangeVersions[RangeCount] = {};
+
+public:
+	BindingVersionTable() : id(nextId.fetch_add(1, std::memory_order_relaxed))
+	{
+	}
+
+	static constexpr uint32_t IndexOf(ShaderParameterType type, ShaderStage stage)
+	{
+		return static_cast<uint32_t>(type) * StageCount + static_cast<uint32_t>(stage);
+	}
+
+	static constexpr uint32_t MaskOf(ShaderParameterType type, ShaderStage stage)
+	{
+		return 1u << IndexOf(type, stage);
+	}
+
+	// Ranges of the given type across all stages.
+	static constexpr uint32_t MaskOf(ShaderParameterType type)
+	{
+		return ((1u << StageCount) - 1) << (static_cast<uint32_t>(type) * StageCount);
+	}
+
+	// Ranges of all types for the given stage.
+	static constexpr uint32_t MaskOf(ShaderStage stage)
+	{
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < TypeCount; i++)
+		{
+			mask |= MaskOf(static_cast<ShaderParameterType>(i), stage);
+		}
+		return mask;
+	}
+
+	uint64_t GetId() const noexcept { return id; }
+	uint64_t GetVersion() const noexcept { return version; }
+
+	void MarkDirty(ShaderParameterType type, ShaderStage stage)
+	{
+		rangeVersions[IndexOf(type, stage)] = ++version;
+	}
+
+	void MarkDirty(ShaderParameterType type)
+	{
+		++version;
+		for (uint32_t i = 0; i < StageCount; i++)
+		{
+			rangeVersions[IndexOf(type, static_cast<ShaderStage>(i))] = version;
+		}
+	}
+
+	void MarkAllDirty()
+	{
+		++version;
+		for (auto& rangeVersion : rangeVersions)
+		{
+			rangeVersion = version;
+		}
+	}
+
+	uint32_t GetDirtySince(uint64_t since) const
+	{
+		if (since == version)
+		{
+			return 0;
+		}
+
+		uint32_t dirty = 0;
+		for (uint32_t i = 0; i < RangeCount; i++)
+		{
+			if (rangeVersions[i] > since)
+			{
+				dirty |= 1u << i;
+			}
+		}
+		return dirty;
+	}
+};
+
+// Per context record of the binding list that was submitted last, together with the override set that was
+// applied on top of it. Anything that may disturb the bound slots behind the tracker's back (output merger
+// changes, ClearState, command list execution) must Invalidate it.
+class BindingTracker
+{
+	uint64_t listId = 0;
+	uint64_t version = 0;
+	uint64_t overridesId = 0;
+	uint64_t overridesVersion = 0;
+	uint32_t overrideRanges = 0;
+
+public:
+	// Returns the ranges of 'table' that have to be submitted and records the table as bound. 'overrideRanges'
+	// are the ranges the override table may patch, they are resubmitted when the override table is swapped.
+	uint32_t Acquire(const BindingVersionTable& table, const BindingVersionTable* overrides = nullptr, uint32_t overrideRanges = 0)
+	{
+		uint32_t dirty = BindingVersionTable::AllRanges;
+		if (listId == table.GetId())
+		{
+			dirty = table.GetDirtySince(version);
+		}
+
+		const uint64_t id = overrides ? overrides->GetId() : 0;
+		if (id != overridesId)
+		{
+			dirty |= this->overrideRanges | overrideRanges;
+		}
+		else if (overrides)
+		{
+			dirty |= overrides->GetDirtySince(overridesVersion);
+		}
+
+		listId = table.GetId();
+		version = table.GetVersion();
+		overridesId = id;
+		overridesVersion = overrides ? overrides->GetVersion() : 0;
+		this->overrideRanges = overrideRanges;
+		return dirty;
+	}
+
+	bool IsBound(const BindingVersionTable& table) const noexcept
+	{
+		return listId == table.GetId();
+	}
+
+	void Invalidate() noexcept
+	{
+		listId = 0;
+		version = 0;
+		overridesId = 0;
+		overridesVersion = 0;
+		overrideRanges = 0;
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
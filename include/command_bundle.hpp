@@ -0,0 +1,108 @@
+#pragma once
+#include "command_stream.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+enum class BundleParamType : uint8_t
+{
+	Constants,
+	BindingSet,
+	BindingGroup,
+	VertexBuffer,
+};
+
+struct BundleParam
+{
+	uint32_t index = UINT32_MAX;
+};
+
+// Command stream that is recorded once and executed many times. Parameters are declared up front and referenced
+// by the parameter overloads of the record methods, patching a parameter rewrites every packet referencing it in
+// place, so the next execution sees the new value without re-recording. The plain record methods stay available for
+// everything that never changes. Compile translates the packets into a native bundle of the device, which resolves
+// the backend objects once and executes them in a single call on the command list. Patching re-translates only the
+// packets of the patched parameter. Until compiled, Execute replays the packets through the CommandList interface.
+class CommandBundle : public CommandStream
+{
+	struct Param
+	{
+		BundleParamType type;
+		uint32_t size;
+		std::vector<CommandPacket*> packets;
+		// Position of each packet in the stream.
+		std::vector<uint32_t> indices;
+	};
+
+	std::vector<Param> params;
+	PrismObj<NativeCommandBundle> native;
+	uint32_t nativePacketCount = 0;
+
+	Param& GetParam(BundleParam param, BundleParamType type);
+	const void* GetInitialConstants(BundleParam param);
+	void AddPacket(Param& entry, CommandPacket* packet);
+	void UpdateNative(const Param& entry);
+
+public:
+	explicit CommandBundle(CommandArena& arena) : CommandStream(arena)
+	{
+	}
+
+	size_t GetParamCount() const noexcept { return params.size(); }
+
+	// Rewinds the bundle for re-recording, the parameters and the native bundle are dropped with the packets.
+	void Reset() noexcept
+	{
+		CommandStream::Reset();
+		params.clear();
+		native.Release();
+	}
+
+	void Release() noexcept
+	{
+		CommandStream::Release();
+		params.clear();
+		native.Release();
+	}
+
+	bool IsCompiled() const noexcept { return native; }
+
+	// Translates the recorded packets into a native bundle of 'device'. Recording more packets afterwards requires
+	// compiling again.
+	void Compile(GraphicsDevice* device);
+
+	// Runs the native bundle on 'commandList', which must belong to the device compiled for, or replays the packets
+	// if the bundle was not compiled.
+	void Execute(CommandList* commandList) const;
+
+	// A block of 'size' bytes, bound as push constants.
+	BundleParam AddConstants(uint32_t size);
+	BundleParam AddBindingSet();
+	BundleParam AddBindingGroup();
+	// A vertex buffer together with its offset, the stride is fixed at recording.
+	BundleParam AddVertexBuffer();
+
+	using CommandStream::SetPushConstants;
+	using CommandStream::SetBindingSet;
+	using CommandStream::SetBindingGroup;
+	using CommandStream::SetVertexBuffer;
+
+	// Records push constants whose data is the current value of 'param', zero until patched.
+	void SetPushConstants(ShaderStageFlags stages, uint32_t offset, BundleParam param);
+	void SetBindingSet(BundleParam param);
+	void SetBindingGroup(uint32_t index, BundleParam param);
+	void SetVertexBuffer(uint32_t slot, BundleParam param, uint32_t stride);
+
+	// Writes 'size' bytes at 'offset' into the constants block.
+	void PatchConstants(BundleParam param, const void* data, uint32_t size, uint32_t offset = 0);
+	void PatchBindingSet(BundleParam param, BindingSet* bindingSet);
+	void PatchBindingGroup(BundleParam param, BindingGroup* group);
+	void PatchVertexBuffer(BundleParam param, Buffer* buffer, uint32_t offset);
+
+	template<typename T>
+	void PatchConstants(BundleParam param, const T& data, uint32_t offset = 0)
+	{
+		PatchConstants(param, &data, sizeof(T), offset);
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,41 @@
+#pragma once
+#include "prism.hpp"
+#include <functional>
+#include <mutex>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Splits [0, count) into one contiguous range per worker and runs 'body(worker, begin, end)' for every range, the
+// calling thread takes worker 0. A worker count of zero picks the hardware concurrency, the count is capped so that
+// no worker gets fewer than 'minItemsPerWorker' items. The first exception thrown by a worker is rethrown.
+void ParallelFor(uint32_t count, uint32_t workerCount, uint32_t minItemsPerWorker, const std::function<void(uint32_t worker, uint32_t begin, uint32_t end)>& body);
+
+// Recycles deferred command lists across frames. Creating a deferred context is expensive, resetting a recorded one
+// is not, so lists handed out by Acquire go back to the pool on Reset instead of being destroyed.
+class CommandListPool
+{
+	GraphicsDevice* device;
+	std::mutex mutex;
+	std::vector<PrismObj<CommandList>> lists;
+	std::vector<CommandList*> freeLists;
+
+public:
+	explicit CommandListPool(GraphicsDevice* device) : device(device)
+	{
+	}
+
+	size_t GetSize() const noexcept { return lists.size(); }
+
+	// Returns a deferred list ready for recording, Begin has already been called. Safe to call from any thread.
+	CommandList* Acquire();
+
+	// Hands every acquired list back to the pool. Only call once the lists were executed, their recorded commands
+	// are dropped by the next Begin.
+	void Reset();
+
+	// Records 'count' items on up to 'workerCount' pooled lists in parallel, 'record(list, begin, end)' records one
+	// contiguous range. The lists are executed on 'target' in range order, so the result matches recording serially.
+	void RecordParallel(CommandList* target, uint32_t count, uint32_t workerCount, uint32_t minItemsPerWorker, const std::function<void(CommandList* list, uint32_t begin, uint32_t end)>& record);
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,394 @@
+#pragma once
+#include "prism.hpp"
+#include <mutex>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+enum class CommandOp : uint16_t
+{
+	SetGraphicsPipelineState,
+	SetComputePipelineState,
+	SetBindingSet,
+	SetBindingGroup,
+	SetVertexBuffer,
+	SetIndexBuffer,
+	SetRenderTarget,
+	SetViewports,
+	SetScissorRects,
+	SetPrimitiveTopology,
+	SetPushConstants,
+	DrawInstanced,
+	DrawIndexedInstanced,
+	DrawInstancedIndirect,
+	DrawIndexedInstancedIndirect,
+	Dispatch,
+	DispatchIndirect,
+	ClearRenderTargetView,
+	ClearDepthStencilView,
+	ClearUnorderedAccessViewUint,
+	CopyResource,
+	CopySubresourceRegion,
+	BeginEvent,
+	EndEvent,
+};
+
+// Every packet starts with this header, 'size' covers the header, the fixed payload and any trailing data and is
+// a multiple of CommandPacketAlignment, so the next packet directly follows.
+struct CommandPacket
+{
+	CommandOp op;
+	uint16_t size;
+};
+
+static constexpr uint32_t CommandPacketAlignment = 8;
+
+struct SetGraphicsPipelineStatePacket : CommandPacket { GraphicsPipelineState* state; };
+struct SetComputePipelineStatePacket : CommandPacket { ComputePipelineState* state; };
+struct SetBindingSetPacket : CommandPacket { BindingSet* bindingSet; };
+struct SetBindingGroupPacket : CommandPacket { uint32_t index; BindingGroup* group; };
+struct SetVertexBufferPacket : CommandPacket { uint32_t slot; uint32_t stride; uint32_t offset; Buffer* buffer; };
+struct SetIndexBufferPacket : CommandPacket { Format format; uint32_t offset; Buffer* buffer; };
+struct SetRenderTargetPacket : CommandPacket { RenderTargetView* rtv; DepthStencilView* dsv; };
+// Followed by 'count' viewports.
+struct SetViewportsPacket : CommandPacket { uint32_t count; };
+// Followed by 'count' rects.
+struct SetScissorRectsPacket : CommandPacket { uint32_t count; };
+struct SetPrimitiveTopologyPacket : CommandPacket { PrimitiveTopology topology; };
+// Followed by 'size' bytes of data.
+struct SetPushConstantsPacket : CommandPacket { ShaderStageFlags stages; uint32_t offset; uint32_t size; };
+struct DrawInstancedPacket : CommandPacket { uint32_t vertexCount; uint32_t instanceCount; uint32_t vertexOffset; uint32_t instanceOffset; };
+struct DrawIndexedInstancedPacket : CommandPacket { uint32_t indexCount; uint32_t instanceCount; uint32_t indexOffset; int32_t vertexOffset; uint32_t instanceOffset; };
+struct DrawIndirectPacket : CommandPacket { uint32_t offset; Buffer* args; };
+struct DispatchPacket : CommandPacket { uint32_t x; uint32_t y; uint32_t z; };
+struct DispatchIndirectPacket : CommandPacket { uint32_t offset; Buffer* args; };
+struct ClearRenderTargetViewPacket : CommandPacket { Color color; RenderTargetView* rtv; };
+struct ClearDepthStencilViewPacket : CommandPacket { DepthStencilViewClearFlags flags; char stencil; float depth; DepthStencilView* dsv; };
+struct ClearUnorderedAccessViewUintPacket : CommandPacket { uint32_t values[4]; UnorderedAccessView* uav; };
+struct CopyResourcePacket : CommandPacket { Resource* dst; Resource* src; };
+struct CopySubresourceRegionPacket : CommandPacket { uint32_t dstSubresource; uint32_t dstX; uint32_t dstY; uint32_t dstZ; uint32_t srcSubresource; CopyFlags flags; bool hasBox; Box box; Resource* dst; Resource* src; };
+// Followed by the null terminated name.
+struct BeginEventPacket : CommandPacket { uint32_t length; };
+struct EndEventPacket : CommandPacket { };
+
+struct CommandChunk
+{
+	CommandChunk* next;
+	uint32_t used;
+	uint32_t capacity;
+
+	uint8_t* GetData() noexcept { return reinterpret_cast<uint8_t*>(this + 1); }
+	const uint8_t* GetData() const noexcept { return reinterpret_cast<const uint8_t*>(this + 1); }
+};
+
+// Pool of fixed size chunks shared by the command streams of a renderer. Streams only come back here when their
+// current chunk is full, so the lock is taken a handful of times per frame, never per command.
+class CommandArena
+{
+	std::mutex mutex;
+	CommandChunk* freeList = nullptr;
+	size_t chunkCount = 0;
+
+public:
+	static constexpr uint32_t ChunkSize = 64 * 1024;
+
+	CommandArena() = default;
+	~CommandArena();
+
+	CommandArena(const CommandArena&) = delete;
+	CommandArena& operator=(const CommandArena&) = delete;
+
+	size_t GetChunkCount() const noexcept { return chunkCount; }
+
+	CommandChunk* Acquire();
+	// Returns a whole chain of chunks linked through 'next'.
+	void Release(CommandChunk* chunks);
+};
+
+// Backend independent command buffer: commands are appended as packed packets to chunks owned by the stream and
+// replayed against any CommandList later. A stream must only be recorded by one thread at a time, different
+// streams may be recorded in parallel. Objects are stored by pointer and must stay alive until the replay.
+// Packets returned by the record methods stay at their address until Reset or Release and may be patched in place.
+class CommandStream
+{
+	CommandArena* arena;
+	CommandChunk* first = nullptr;
+	CommandChunk* current = nullptr;
+	uint32_t packetCount = 0;
+
+	void NextChunk(uint32_t size);
+
+	void* Allocate(uint32_t size)
+	{
+		size = (size + CommandPacketAlignment - 1) & ~(CommandPacketAlignment - 1);
+		if (!current || current->capacity - current->used < size)
+		{
+			NextChunk(size);
+		}
+
+		auto packet = static_cast<CommandPacket*>(static_cast<void*>(current->GetData() + current->used));
+		packet->size = static_cast<uint16_t>(size);
+		current->used += size;
+		packetCount++;
+		return packet;
+	}
+
+	template<typename T>
+	T* Record(CommandOp op, uint32_t extra = 0)
+	{
+		static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= CommandPacketAlignment, "Command packets must be trivially copyable");
+		auto packet = static_cast<T*>(Allocate(sizeof(T) + extra));
+		packet->op = op;
+		return packet;
+	}
+
+public:
+	explicit CommandStream(CommandArena& arena) : arena(&arena)
+	{
+	}
+
+	~CommandStream();
+
+	CommandStream(const CommandStream&) = delete;
+	CommandStream& operator=(const CommandStream&) = delete;
+
+	uint32_t GetPacketCount() const noexcept { return packetCount; }
+	bool IsEmpty() const noexcept { return packetCount == 0; }
+
+	// Rewinds the stream but keeps its chunks, recording the next frame does not touch the arena again.
+	void Reset() noexcept;
+
+	// Rewinds the stream and hands every chunk back to the arena.
+	void Release() noexcept;
+
+	// Issues every recorded command on 'commandList' in recording order.
+	void Replay(CommandList* commandList) const;
+
+	// Calls 'visitor' with every recorded packet in recording order.
+	template<typename TVisitor>
+	void ForEachPacket(TVisitor&& visitor) const
+	{
+		for (auto chunk = first; chunk; chunk = chunk->next)
+		{
+			const uint8_t* cursor = chunk->GetData();
+			const uint8_t* end = cursor + chunk->used;
+			while (cursor < end)
+			{
+				auto packet = reinterpret_cast<const CommandPacket*>(cursor);
+				cursor += packet->size;
+				visitor(packet);
+			}
+
+			// Chunks past the current one are left over from before the last Reset.
+			if (chunk == current)
+			{
+				break;
+			}
+		}
+	}
+
+	void SetGraphicsPipelineState(GraphicsPipelineState* state)
+	{
+		Record<SetGraphicsPipelineStatePacket>(CommandOp::SetGraphicsPipelineState)->state = state;
+	}
+
+	void SetComputePipelineState(ComputePipelineState* state)
+	{
+		Record<SetComputePipelineStatePacket>(CommandOp::SetComputePipelineState)->state = state;
+	}
+
+	SetBindingSetPacket* SetBindingSet(BindingSet* bindingSet)
+	{
+		auto packet = Record<SetBindingSetPacket>(CommandOp::SetBindingSet);
+		packet->bindingSet = bindingSet;
+		return packet;
+	}
+
+	SetBindingGroupPacket* SetBindingGroup(uint32_t index, BindingGroup* group)
+	{
+		auto packet = Record<SetBindingGroupPacket>(CommandOp::SetBindingGroup);
+		packet->index = index;
+		packet->group = group;
+		return packet;
+	}
+
+	SetVertexBufferPacket* SetVertexBuffer(uint32_t slot, Buffer* buffer, uint32_t stride, uint32_t offset)
+	{
+		auto packet = Record<SetVertexBufferPacket>(CommandOp::SetVertexBuffer);
+		packet->slot = slot;
+		packet->stride = stride;
+		packet->offset = offset;
+		packet->buffer = buffer;
+		return packet;
+	}
+
+	void SetIndexBuffer(Buffer* buffer, Format format, uint32_t offset)
+	{
+		auto packet = Record<SetIndexBufferPacket>(CommandOp::SetIndexBuffer);
+		packet->format = format;
+		packet->offset = offset;
+		packet->buffer = buffer;
+	}
+
+	void SetRenderTarget(RenderTargetView* rtv, DepthStencilView* dsv)
+	{
+		auto packet = Record<SetRenderTargetPacket>(CommandOp::SetRenderTarget);
+		packet->rtv = rtv;
+		packet->dsv = dsv;
+	}
+
+	void SetViewport(const Viewport& viewport)
+	{
+		SetViewports(1, &viewport);
+	}
+
+	void SetViewports(uint32_t count, const Viewport* viewports)
+	{
+		auto packet = Record<SetViewportsPacket>(CommandOp::SetViewports, count * sizeof(Viewport));
+		packet->count = count;
+		memcpy(packet + 1, viewports, count * sizeof(Viewport));
+	}
+
+	void SetScissorRects(const Rect* rects, uint32_t count)
+	{
+		auto packet = Record<SetScissorRectsPacket>(CommandOp::SetScissorRects, count * sizeof(Rect));
+		packet->count = count;
+		memcpy(packet + 1, rects, count * sizeof(Rect));
+	}
+
+	void SetPrimitiveTopology(PrimitiveTopology topology)
+	{
+		Record<SetPrimitiveTopologyPacket>(CommandOp::SetPrimitiveTopology)->topology = topology;
+	}
+
+	SetPushConstantsPacket* SetPushConstants(ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data)
+	{
+		if (size > CommandList::MaxPushConstantsSize)
+		{
+			throw std::runtime_error("Push constants exceed MaxPushConstantsSize.");
+		}
+
+		auto packet = Record<SetPushConstantsPacket>(CommandOp::SetPushConstants, size);
+		packet->stages = stages;
+		packet->offset = offset;
+		packet->size = size;
+		memcpy(packet + 1, data, size);
+		return packet;
+	}
+
+	void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset, uint32_t instanceOffset)
+	{
+		auto packet = Record<DrawInstancedPacket>(CommandOp::DrawInstanced);
+		packet->vertexCount = vertexCount;
+		packet->instanceCount = instanceCount;
+		packet->vertexOffset = vertexOffset;
+		packet->instanceOffset = instanceOffset;
+	}
+
+	void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, int32_t vertexOffset, uint32_t instanceOffset)
+	{
+		auto packet = Record<DrawIndexedInstancedPacket>(CommandOp::DrawIndexedInstanced);
+		packet->indexCount = indexCount;
+		packet->instanceCount = instanceCount;
+		packet->indexOffset = indexOffset;
+		packet->vertexOffset = vertexOffset;
+		packet->instanceOffset = instanceOffset;
+	}
+
+	void DrawInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs)
+	{
+		auto packet = Record<DrawIndirectPacket>(CommandOp::DrawInstancedIndirect);
+		packet->offset = alignedByteOffsetForArgs;
+		packet->args = bufferForArgs;
+	}
+
+	void DrawIndexedInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs)
+	{
+		auto packet = Record<DrawIndirectPacket>(CommandOp::DrawIndexedInstancedIndirect);
+		packet->offset = alignedByteOffsetForArgs;
+		packet->args = bufferForArgs;
+	}
+
+	void Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ)
+	{
+		auto packet = Record<DispatchPacket>(CommandOp::Dispatch);
+		packet->x = threadGroupCountX;
+		packet->y = threadGroupCountY;
+		packet->z = threadGroupCountZ;
+	}
+
+	void DispatchIndirect(Buffer* dispatchArgs, uint32_t offset)
+	{
+		auto packet = Record<DispatchIndirectPacket>(CommandOp::DispatchIndirect);
+		packet->offset = offset;
+		packet->args = dispatchArgs;
+	}
+
+	void ClearRenderTargetView(RenderTargetView* rtv, const Color& color)
+	{
+		auto packet = Record<ClearRenderTargetViewPacket>(CommandOp::ClearRenderTargetView);
+		packet->color = color;
+		packet->rtv = rtv;
+	}
+
+	void ClearDepthStencilView(DepthStencilView* dsv, DepthStencilViewClearFlags flags, float depth, char stencil)
+	{
+		auto packet = Record<ClearDepthStencilViewPacket>(CommandOp::ClearDepthStencilView);
+		packet->flags = flags;
+		packet->stencil = stencil;
+		packet->depth = depth;
+		packet->dsv = dsv;
+	}
+
+	void ClearUnorderedAccessViewUint(UnorderedAccessView* uav, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+	{
+		auto packet = Record<ClearUnorderedAccessViewUintPacket>(CommandOp::ClearUnorderedAccessViewUint);
+		packet->values[0] = r;
+		packet->values[1] = g;
+		packet->values[2] = b;
+		packet->values[3] = a;
+		packet->uav = uav;
+	}
+
+	void CopyResource(Resource* dstResource, Resource* srcResource)
+	{
+		auto packet = Record<CopyResourcePacket>(CommandOp::CopyResource);
+		packet->dst = dstResource;
+		packet->src = srcResource;
+	}
+
+	void CopySubresourceRegion(Resource* dstResource, uint32_t dstSubresource, uint32_t dstX, uint32_t dstY, uint32_t dstZ, Resource* srcResource, uint32_t srcSubresource, const Box* srcBox = nullptr, CopyFlags flags = CopyFlags::None)
+	{
+		auto packet = Record<CopySubresourceRegionPacket>(CommandOp::CopySubresourceRegion);
+		packet->dstSubresource = dstSubresource;
+		packet->dstX = dstX;
+		packet->dstY = dstY;
+		packet->dstZ = dstZ;
+		packet->srcSubresource = srcSubresource;
+		packet->flags = flags;
+		packet->hasBox = srcBox != nullptr;
+		packet->box = srcBox ? *srcBox : Box{};
+		packet->dst = dstResource;
+		packet->src = srcResource;
+	}
+
+	// A null name records an empty event name, as the backends do.
+	void BeginEvent(const char* name)
+	{
+		const auto length = name ? static_cast<uint32_t>(std::min<size_t>(strlen(name), 255)) : 0u;
+		auto packet = Record<BeginEventPacket>(CommandOp::BeginEvent, length + 1);
+		packet->length = length;
+		auto text = reinterpret_cast<char*>(packet + 1);
+		if (length)
+		{
+			memcpy(text, name, length);
+		}
+		text[length] = '\0';
+	}
+
+	void EndEvent()
+	{
+		Record<EndEventPacket>(CommandOp::EndEvent);
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,43 @@
+#pragma once
+#include "resource_binding_list.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Ranges are built once from the declared layout for all six stages, so a range is found directly by its
+// BindingVersionTable index and binding walks the prebuilt slot runs without any name lookups.
+class D3D11BindingGroup final : public BindingGroup
+{
+    D3D11DescriptorStorage storage;
+    std::span<D3D11DescriptorRange> ranges;
+    SlotMask slots[BindingVersionTable::RangeCount];
+    uint32_t rangeMask = 0;
+    BindingVersionTable versions;
+
+    void SetByName(ShaderParameterType type, const char* name, void* resource, uint32_t initialCount = static_cast<uint32_t>(-1));
+
+public:
+    explicit D3D11BindingGroup(const BindingGroupDesc& desc);
+
+    void SetCBV(const char* name, Buffer* buffer) override;
+    void SetSampler(const char* name, SamplerState* sampler) override;
+    void SetSRV(const char* name, ShaderResourceView* view) override;
+    void SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount = static_cast<uint32_t>(-1)) override;
+
+    const BindingVersionTable& GetVersions() const noexcept { return versions; }
+
+    // Ranges that declare at least one slot.
+    uint32_t GetRangeMask() const noexcept { return rangeMask; }
+
+    // Absolute slots owned by the group, one mask per BindingVersionTable range.
+    const SlotMask* GetSlots() const noexcept { return slots; }
+
+    // A binding list is compatible when every slot it shares with the group is declared under the same name.
+    bool IsCompatible(const D3D11ResourceBindingList& bindingList) const;
+
+    void Bind(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges) const;
+
+    // Pipeline states leave the group slots alone, so the command list clears the group UAVs when it leaves compute.
+    void UnbindComputeUAVs(const ComPtr<ID3D11DeviceContext3>& context) const;
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,66 @@
+#pragma once
+#include "resource_binding_list.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Overrides are stored by name and resolved against a binding list's ranges on first use. The resolution is
+// cached until the set or the binding list layout changes, a set is only ever used by its own command list.
+class D3D11BindingSet final : public BindingSet
+{
+    struct Entry
+    {
+        std::string name;
+        ShaderParameterType type;
+        void* resource;
+        uint32_t initialCount;
+        uint32_t firstConstant;
+        uint32_t numConstants;
+    };
+
+    std::vector<Entry> entries;
+    BindingVersionTable versions;
+    uint32_t rangeMask = 0;
+
+    uint64_t resolvedListId = 0;
+    uint64_t resolvedLayoutVersion = 0;
+    uint64_t resolvedVersion = 0;
+    std::vector<D3D11BindingOverride> resolved;
+
+    void SetEntry(const char* name, ShaderParameterType type, void* resource, uint32_t initialCount, uint32_t firstConstant = 0, uint32_t numConstants = 0);
+
+public:
+    void SetCBV(const char* name, Buffer* buffer) override;
+    void SetCBV(const char* name, const TransientConstants& constants) override;
+    void SetSampler(const char* name, SamplerState* sampler) override;
+    void SetSRV(const char* name, ShaderResourceView* view) override;
+    void SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount = static_cast<uint32_t>(-1)) override;
+    void Clear() override;
+
+    const BindingVersionTable& GetVersions() const noexcept { return versions; }
+
+    // Ranges that may be patched by this set, regardless of the binding list it is applied to.
+    uint32_t GetRangeMask() const noexcept { return rangeMask; }
+
+    // Returns the overrides that apply to 'bindingList', sorted by range index.
+    std::span<const D3D11BindingOverride> Resolve(const D3D11ResourceBindingList& bindingList);
+};
+
+inline uint32_t AcquireBindings(BindingTracker& tracker, const D3D11ResourceBindingList& bindingList, const D3D11BindingSet* bindingSet)
+{
+    if (!bindingSet)
+    {
+        return tracker.Acquire(bindingList.GetVersions());
+    }
+    return tracker.Acquire(bindingList.GetVersions(), &bindingSet->GetVersions(), bindingSet->GetRangeMask());
+}
+
+inline std::span<const D3D11BindingOverride> ResolveOverrides(D3D11BindingSet* bindingSet, const D3D11ResourceBindingList& bindingList)
+{
+    if (!bindingSet)
+    {
+        return {};
+    }
+    return bindingSet->Resolve(bindingList);
+}
+
+HEXA_PRISM_NAMESPACE_END
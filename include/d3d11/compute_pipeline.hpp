@@ -1,5 +1,7 @@
 #pragma once
 #include "common.hpp"
+#include "variable_list.hpp"
+#include <mutex>
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -11,12 +13,15 @@ class D3D11ComputePipeline final : public ComputePipeline
 	ComPtr<ID3D11ComputeShader> cs;
 
 	PrismObj<Blob> computeShaderBlob;
+	std::shared_ptr<const D3D11VariableLayout> variableLayout;
+	std::mutex variableLayoutMutex;
 	bool valid;
 
 public:
 	D3D11ComputePipeline(D3D11GraphicsDevice* device, const ComputePipelineDesc& desc);
 
 	void Compile();
+	std::shared_ptr<const D3D11VariableLayout> GetVariableLayout();
 };
 
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+#include "common.hpp"
+#include "../upload_ring.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+class D3D11Buffer;
+
+// Per command list allocator for transient constants. Where the driver supports constant buffer offsetting the
+// data is sub-allocated from large dynamic buffers with no-overwrite maps and bound as a sub-range, otherwise every
+// write discards a pooled buffer of the next power of two size and binds it whole. With 'retainRanges' no memory is
+// reused before Reset: a full ring continues in the next buffer of a chain and every emulated write takes its own
+// pooled buffer, both are kept for the next recordings. Without it the ring wraps in place and each size class has
+// a single buffer, so a write invalidates earlier ranges it lands on.
+class D3D11ConstantRing
+{
+public:
+    static constexpr uint32_t DefaultCapacity = 1u << 20;
+    static constexpr uint32_t ConstantSize = 16;
+    // *SetConstantBuffers1 requires offsets and sizes to be multiples of 16 constants.
+    static constexpr uint32_t OffsetAlignment = 16 * ConstantSize;
+    static constexpr uint32_t MaxSize = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * ConstantSize;
+
+private:
+    static constexpr uint32_t SizeClassCount = 9;
+
+    ComPtr<ID3D11Device> device;
+    bool offsetting = false;
+    bool retainRanges;
+    UploadRing ring;
+    std::vector<PrismObj<D3D11Buffer>> buffers;
+    uint32_t currentBuffer = 0;
+    bool ringUsed = false;
+    uint64_t discardGeneration = 0;
+    std::vector<PrismObj<D3D11Buffer>> sizeClasses[SizeClassCount];
+    uint32_t sizeClassUsed[SizeClassCount] = {};
+
+    PrismObj<D3D11Buffer> CreateBuffer(uint32_t size);
+    TransientConstants WriteEmulated(ID3D11DeviceContext* context, const void* data, uint32_t size);
+
+public:
+    D3D11ConstantRing(ID3D11Device* device, bool retainRanges, uint32_t capacity = DefaultCapacity);
+
+    bool SupportsOffsets() const noexcept { return offsetting; }
+    const UploadRing& GetRing() const noexcept { return ring; }
+    // Incremented by every write that discarded memory earlier ranges may live in. Only happens without 'retainRanges'.
+    uint64_t GetDiscardGeneration() const noexcept { return discardGeneration; }
+
+    TransientConstants Write(ID3D11DeviceContext* context, const void* data, uint32_t size);
+
+    // Must be called whenever the context starts recording, a deferred context has to discard before its first
+    // no-overwrite map. Ranges written before are invalid afterwards.
+    void Reset() noexcept;
+};
+
+HEXA_PRISM_NAMESPACE_END
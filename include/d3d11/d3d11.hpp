@@ -5,6 +5,11 @@
 #include "graphics_pipeline_state.hpp"
 #include "compute_pipeline.hpp"
 #include "compute_pipeline_state.hpp"
+#include "binding_group.hpp"
+#include "constant_ring.hpp"
+#include "readback.hpp"
+#include "upload_context.hpp"
+#include "../command_stream.hpp"
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -146,13 +151,164 @@ public:
 	void* GetNativePointer() override { return query.Get(); }
 };
 
-class D3D11CommandList : public CommandList
+class D3D11Fence : public Fence
+{
+	ComPtr<ID3D11Fence> fence;
+	HANDLE event;
+	std::mutex mutex;
+public:
+	D3D11Fence(ComPtr<ID3D11Fence>&& fence, HANDLE event) : fence(std::move(fence)), event(event)
+	{
+	}
+	~D3D11Fence() override;
+
+	uint64_t GetCompletedValue() override;
+	bool Wait(uint64_t value, uint32_t timeoutMs = Infinite) override;
+	ID3D11Fence* GetFence() const { return fence.Get(); }
+	void* GetNativePointer() override { return fence.Get(); }
+};
+
+// Command stream translated for D3D11: every packet becomes one command holding the native objects, strides,
+// offsets and converted enums it needs, so executing the bundle is a single loop on the command list. State still
+// goes through the state cache of the command list, bindings are committed before each draw and dispatch.
+class D3D11NativeBundle : public NativeCommandBundle
+{
+	friend class D3D11CommandList;
+
+	struct BindingGroupCommand { uint32_t index; D3D11BindingGroup* group; };
+	struct VertexBufferCommand { uint32_t slot; UINT stride; UINT offset; ID3D11Buffer* buffer; };
+	struct IndexBufferCommand { DXGI_FORMAT format; UINT offset; ID3D11Buffer* buffer; };
+	struct RenderTargetCommand { ID3D11RenderTargetView* rtv; ID3D11DepthStencilView* dsv; };
+	// Range of the side arrays, which keep the backend independent values for the state cache next to the native ones.
+	struct RangeCommand { uint32_t first; uint32_t count; };
+	// Points at the data trailing the stream packet, patched constants need no translation.
+	struct PushConstantsCommand { ShaderStageFlags stages; uint32_t offset; uint32_t size; const void* data; };
+	struct DrawCommand { UINT vertexCount; UINT instanceCount; UINT vertexOffset; UINT instanceOffset; };
+	struct DrawIndexedCommand { UINT indexCount; UINT instanceCount; UINT indexOffset; INT vertexOffset; UINT instanceOffset; };
+	struct IndirectCommand { UINT offset; ID3D11Buffer* args; };
+	struct DispatchCommand { UINT x; UINT y; UINT z; };
+	struct ClearRenderTargetCommand { FLOAT color[4]; ID3D11RenderTargetView* rtv; };
+	struct ClearDepthStencilCommand { UINT flags; UINT8 stencil; FLOAT depth; ID3D11DepthStencilView* dsv; };
+	struct ClearUnorderedAccessCommand { UINT values[4]; ID3D11UnorderedAccessView* uav; };
+	struct CopyCommand { ID3D11Resource* dst; ID3D11Resource* src; };
+
+	struct CopyRegion
+	{
+		ID3D11Resource* dst;
+		ID3D11Resource* src;
+		UINT dstSubresource;
+		UINT dstX;
+		UINT dstY;
+		UINT dstZ;
+		UINT srcSubresource;
+		UINT flags;
+		bool hasBox;
+		D3D11_BOX box;
+	};
+
+	struct Command
+	{
+		CommandOp op;
+		union
+		{
+			D3D11GraphicsPipelineState* graphicsState;
+			D3D11ComputePipelineState* computeState;
+			D3D11BindingSet* bindingSet;
+			BindingGroupCommand bindingGroup;
+			VertexBufferCommand vertexBuffer;
+			IndexBufferCommand indexBuffer;
+			RenderTargetCommand renderTarget;
+			RangeCommand range;
+			D3D11_PRIMITIVE_TOPOLOGY topology;
+			PushConstantsCommand pushConstants;
+			DrawCommand draw;
+			DrawIndexedCommand drawIndexed;
+			IndirectCommand indirect;
+			DispatchCommand dispatch;
+			ClearRenderTargetCommand clearRenderTarget;
+			ClearDepthStencilCommand clearDepthStencil;
+			ClearUnorderedAccessCommand clearUnorderedAccess;
+			CopyCommand copy;
+			// Index into the copy regions or the event names.
+			uint32_t index;
+		};
+	};
+
+	std::vector<Command> commands;
+	std::vector<Viewport> viewports;
+	std::vector<D3D11_VIEWPORT> d3dViewports;
+	std::vector<Rect> scissorRects;
+	std::vector<D3D11_RECT> d3dScissorRects;
+	std::vector<CopyRegion> copyRegions;
+	std::vector<std::wstring> eventNames;
+
+	// 'added' is false when an existing command is translated again, it then reuses its side array entries.
+	void Translate(Command& command, const CommandPacket* packet, bool added);
+
+public:
+	explicit D3D11NativeBundle(const CommandStream& stream);
+	~D3D11NativeBundle() override = default;
+
+	void Update(uint32_t index, const CommandPacket* packet) override;
+};
+
+class D3D11CommandList final : public CommandList
 {
 	ComPtr<ID3D11DeviceContext4> context;
 	ComPtr<ID3D11CommandList> commandList;
-	PipelineState* currentPSO = nullptr;
+	D3D11GraphicsPipelineState* graphicsPSO = nullptr;
+	D3D11ComputePipelineState* computePSO = nullptr;
+	D3D11BindingSet* bindingSet = nullptr;
+	StateCache stateCache;
+	BindingTracker graphicsBindings;
+	BindingTracker computeBindings;
+	// Reflected variable uploads are tracked per command list, recording never writes to a pipeline state.
+	D3D11VariableUploadCache variableUploads;
+
+	struct AttachedBindingGroup
+	{
+		D3D11BindingGroup* group = nullptr;
+		BindingTracker graphics;
+		BindingTracker compute;
+		uint64_t validatedListId = 0;
+		uint64_t validatedLayoutVersion = 0;
+	};
+
+	AttachedBindingGroup bindingGroups[BindingGroup::MaxAttachedGroups];
+	SlotMask groupSlots[BindingVersionTable::RangeCount];
+	bool hasBindingGroups = false;
+	std::unique_ptr<D3D11ConstantRing> constantRing;
+	ComPtr<ID3D11Buffer> drawCountReadback;
+
+	// CPU copy of the push constant block. It is uploaded through the constant ring once per change and bound to
+	// the reserved slot of every stage that still sees an older copy.
+	struct PushConstantState
+	{
+		uint8_t data[MaxPushConstantsSize] = {};
+		uint32_t size = 0;
+		uint32_t dirtyStages = 0;
+		uint32_t boundStages = 0;
+		uint64_t listId = 0;
+		uint64_t layoutVersion = 0;
+		TransientConstants range;
+		uint64_t discardGeneration = 0;
+	};
+
+	PushConstantState pushConstants;
+
 	CommandListType type;
+	// Deferred context of a driver without native command lists, see AdjustUpdateSource.
+	bool offsetUpdateSource = false;
 	void UnsetPipelineState();
+	void InvalidateBindings();
+	void CommitGraphicsBindings();
+	void CommitComputeBindings();
+	void CommitBindingGroups(const D3D11ResourceBindingList& bindingList, bool compute);
+	void UnbindGroupComputeUAVs();
+	void CommitPushConstants(const D3D11ResourceBindingList& bindingList, ShaderStageFlags stages);
+	static const void* AdjustUpdateSource(ID3D11Resource* resource, const D3D11_BOX& box, const void* data, uint32_t rowPitch, uint32_t depthPitch);
+	uint32_t ResolveDrawCount(uint32_t maxCount, Buffer* countBuffer, uint32_t countOffset, MultiDrawFlags flags);
+	const SlotMask* GetGroupSlots() const noexcept { return hasBindingGroups ? groupSlots : nullptr; }
 public:
 	D3D11CommandList(ComPtr<ID3D11DeviceContext4>&& context, CommandListType type);
 	~D3D11CommandList() override = default;
@@ -162,6 +318,8 @@ public:
 	void End() override;
 	void SetGraphicsPipelineState(GraphicsPipelineState* state) override;
 	void SetComputePipelineState(ComputePipelineState* state) override;
+	void SetBindingSet(BindingSet* bindingSet) override;
+	void SetBindingGroup(uint32_t index, BindingGroup* group) override;
 	void SetVertexBuffer(uint32_t slot, Buffer* buffer, uint32_t stride, uint32_t offset) override;
 	void SetIndexBuffer(Buffer* buffer, Format format, uint32_t offset) override;
 	void SetRenderTarget(RenderTargetView* rtv, DepthStencilView* dsv) override;
@@ -174,15 +332,22 @@ public:
 	void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, int32_t vertexOffset, uint32_t instanceOffset) override;
 	void DrawIndexedInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs) override;
 	void DrawInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs) override;
+	void MultiDrawIndexedIndirect(Buffer* argsBuffer, uint32_t maxCount, uint32_t stride, Buffer* countBuffer = nullptr, uint32_t argsOffset = 0, uint32_t countOffset = 0, MultiDrawFlags flags = MultiDrawFlags::None) override;
+	void MultiDrawIndirect(Buffer* argsBuffer, uint32_t maxCount, uint32_t stride, Buffer* countBuffer = nullptr, uint32_t argsOffset = 0, uint32_t countOffset = 0, MultiDrawFlags flags = MultiDrawFlags::None) override;
+	void SubmitDraws(const DrawBatch& batch) override;
 	void Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) override;
 	void DispatchIndirect(Buffer* dispatchArgs, uint32_t offset) override;
 	void ExecuteCommandList(CommandList* commandList) override;
+	void ExecuteBundle(NativeCommandBundle* bundle) override;
 	void ClearRenderTargetView(RenderTargetView* rtv, const Color& color) override;
 	void ClearDepthStencilView(DepthStencilView* dsv, DepthStencilViewClearFlags flags, float depth, char stencil) override;
 	void ClearUnorderedAccessViewUint(UnorderedAccessView* uav, uint32_t r, uint32_t g, uint32_t b, uint32_t a) override;
 	void ClearView(ResourceView* view, const Color& color, const Rect& rect) override;
 	void CopyResource(Resource* dstResource, Resource* srcResource) override;
+	void CopySubresourceRegion(Resource* dstResource, uint32_t dstSubresource, uint32_t dstX, uint32_t dstY, uint32_t dstZ, Resource* srcResource, uint32_t srcSubresource, const Box* srcBox = nullptr, CopyFlags flags = CopyFlags::None) override;
+	void UpdateSubresource(Resource* dstResource, uint32_t dstSubresource, const Box* dstBox, const void* data, uint32_t rowPitch, uint32_t depthPitch, CopyFlags flags = CopyFlags::None) override;
 	void GenerateMips(ShaderResourceView* srv) override;
+	void UnbindShaderResources() override;
 	void ClearState() override;
 	void Flush() override;
 	MappedSubresource Map(Resource* resource, uint32_t subresource, MapType mapType, MapFlags mapFlags) override;
@@ -191,9 +356,18 @@ public:
 	void EndQuery(Query* query) override;
 	bool QueryGetData(Query* query, void* data, uint32_t size, QueryGetDataFlags flags = QueryGetDataFlags::None) override;
 
+	void Signal(Fence* fence, uint64_t value) override;
+
 	void BeginEvent(const char* name) override;
 	void EndEvent() override;
 
+	StateCacheStats GetStateCacheStats() const override { return stateCache.GetStats(); }
+	void ResetStateCacheStats() override { stateCache.ResetStats(); }
+
+	using CommandList::WriteConstants;
+	TransientConstants WriteConstants(const void* data, uint32_t size) override;
+	void SetPushConstants(ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data) override;
+
 	ID3D11DeviceContext4* GetContext() const { return context.Get(); }
 	void* GetNativePointer() override { return context.Get(); }
 };
@@ -204,6 +378,8 @@ class D3D11GraphicsDevice : public GraphicsDevice
 	ComPtr<IDXGIAdapter3> adapter;
 	ComPtr<ID3D11Device4> device;
 	PrismObj<D3D11CommandList> immediateContext;
+	D3D11GlobalResourceList globalResources;
+	std::shared_ptr<D3D11StagingPool> stagingPool;
 
 public:
 	D3D11GraphicsDevice() = default;
@@ -212,16 +388,19 @@ public:
 	bool Initialize();
 
 	CommandList* GetImmediateCommandList() override;
+	D3D11GlobalResourceList& GetGlobalResourceList() override { return globalResources; }
 	PrismObj<Buffer> CreateBuffer(const BufferDesc& desc, const SubresourceData* initialData) override;
-	PrismObj<Texture1D> CreateTexture1D(const Texture1DDesc& desc) override;
-	PrismObj<Texture2D> CreateTexture2D(const Texture2DDesc& desc) override;
-	PrismObj<Texture3D> CreateTexture3D(const Texture3DDesc& desc) override;
+	PrismObj<Texture1D> CreateTexture1D(const Texture1DDesc& desc, const SubresourceData* initialData = nullptr) override;
+	PrismObj<Texture2D> CreateTexture2D(const Texture2DDesc& desc, const SubresourceData* initialData = nullptr) override;
+	PrismObj<Texture3D> CreateTexture3D(const Texture3DDesc& desc, const SubresourceData* initialData = nullptr) override;
 	PrismObj<RenderTargetView> CreateRenderTargetView(Resource* resource, const RenderTargetViewDesc& desc) override;
 	PrismObj<ShaderResourceView> CreateShaderResourceView(Resource* resource, const ShaderResourceViewDesc& desc) override;
 	PrismObj<DepthStencilView> CreateDepthStencilView(Resource* resource, const DepthStencilViewDesc& desc) override;
 	PrismObj<UnorderedAccessView> CreateUnorderedAccessView(Resource* resource, const UnorderedAccessViewDesc& desc) override;
 	PrismObj<SamplerState> CreateSamplerState(const SamplerDesc& desc) override;
 	PrismObj<CommandList> CreateCommandList() override;
+	PrismObj<BindingSet> CreateBindingSet() override;
+	PrismObj<BindingGroup> CreateBindingGroup(const BindingGroupDesc& desc) override;
 	PrismObj<GraphicsPipeline> CreateGraphicsPipeline(const GraphicsPipelineDesc& desc) override;
 	PrismObj<GraphicsPipelineState> CreateGraphicsPipelineState(GraphicsPipeline* pipeline, const GraphicsPipelineStateDesc& desc) override;
 	PrismObj<ComputePipeline> CreateComputePipeline(const ComputePipelineDesc& desc) override;
@@ -229,6 +408,10 @@ public:
 	PrismObj<SwapChain> CreateSwapChain(void* windowHandle, const SwapChainDesc& desc, const SwapChainFullscreenDesc& fullscreenDesc) override;
 	PrismObj<SwapChain> CreateSwapChain(void* windowHandle) override;
 	PrismObj<Query> CreateQuery(const QueryDesc& desc) override;
+	PrismObj<Fence> CreateFence(uint64_t initialValue = 0) override;
+	PrismObj<NativeCommandBundle> CreateNativeBundle(const CommandStream& stream) override;
+	PrismObj<UploadContext> CreateUploadContext(uint32_t chunkSize = 4u << 20, uint32_t chunkCount = 4) override;
+	PrismObj<Readback> ReadbackAsync(Resource* resource, uint32_t subresource = 0, const Box* region = nullptr) override;
 
 	ID3D11Device4* GetDevice() const { return device.Get(); }
 	IDXGIFactory4* GetFactory() const { return factory.Get(); }
@@ -1,5 +1,7 @@
 #pragma once
 #include "common.hpp"
+#include "../slot_mask.hpp"
+#include <span>
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -13,33 +15,80 @@ struct D3D11ShaderParameter
     ShaderParameterType type;
 };
 
-struct D3D11DescriptorRange
+struct D3D11DescriptorBucket
 {
-    struct ResourceRange
+    const char* name;
+    uint32_t hash;
+    uint32_t index;
+    uint32_t size;
+};
+
+// Override applied on top of a range's own resources at bind time, 'slot' is relative to the range start.
+// Constant buffer overrides with a non-zero 'numConstants' bind only that sub-range of the buffer.
+struct D3D11BindingOverride
+{
+    uint32_t range;
+    uint32_t slot;
+    void* resource;
+    uint32_t initialCount;
+    uint32_t firstConstant = 0;
+    uint32_t numConstants = 0;
+};
+
+// Bump allocator over the storage block of a binding list. Without a base it only measures, so the same
+// layout code computes the block size first and then places everything at identical offsets.
+class D3D11DescriptorArena
+{
+    uint8_t* base = nullptr;
+    size_t offset = 0;
+
+public:
+    D3D11DescriptorArena() = default;
+    explicit D3D11DescriptorArena(void* base) : base(static_cast<uint8_t*>(base))
     {
-        void** start;
-        uint32_t length;
-    };
+    }
 
-    D3D11DescriptorRange() = default;
-	D3D11DescriptorRange(ShaderStage stage, ShaderParameterType type, D3D11ShaderParameter* parameters, int parametersLength);
-    ~D3D11DescriptorRange();
+    bool IsMeasuring() const noexcept { return base == nullptr; }
+    size_t GetSize() const noexcept { return offset; }
 
-    D3D11DescriptorRange(const D3D11DescriptorRange&) = delete;
-    D3D11DescriptorRange& operator=(const D3D11DescriptorRange&) = delete;
+    template<typename T>
+    T* Allocate(size_t count)
+    {
+        offset = (offset + alignof(T) - 1) & ~(alignof(T) - 1);
+        T* result = base ? reinterpret_cast<T*>(base + offset) : nullptr;
+        offset += sizeof(T) * count;
+        return result;
+    }
 
-    D3D11DescriptorRange(D3D11DescriptorRange&& other) noexcept;
-    D3D11DescriptorRange& operator=(D3D11DescriptorRange&& other) noexcept;
+    const char* AllocateString(const char* str)
+    {
+        const size_t length = strlen(str) + 1;
+        char* result = Allocate<char>(length);
+        if (result)
+        {
+            memcpy(result, str, length);
+        }
+        return result;
+    }
+};
 
+// View over one (type, stage) descriptor table. The range does not own memory: slot data is placed in the hot
+// part of the binding list's storage block and the name lookup table in the cold part.
+struct D3D11DescriptorRange
+{
     ShaderStage stage = ShaderStage::Vertex;
     ShaderParameterType type = ShaderParameterType::CBV;
     uint32_t startSlot = 0;
     uint32_t count = 0;
-    uarray<void*> resources;
-    uarray<uint32_t> initialCounts;
+    uint32_t changes = 0;
+    uint32_t bucketCount = 0;
+    SlotMask occupied;
+    SlotMask declared;
+    void** resources = nullptr;
+    uint32_t* initialCounts = nullptr;
+    D3D11DescriptorBucket* buckets = nullptr;
 
-    std::vector<ResourceRange> ranges;
-    uarray<D3D11ShaderParameter> buckets;
+    void Initialize(D3D11DescriptorArena& hot, D3D11DescriptorArena& cold, ShaderStage stage, ShaderParameterType type, const D3D11ShaderParameter* parameters, uint32_t parametersLength);
 
     static uint32_t HashString(const char* str)
     {
@@ -52,9 +101,9 @@ struct D3D11DescriptorRange
         return hash;
     }
 
-    D3D11ShaderParameter* GetByName(const char* name) const;
+    D3D11DescriptorBucket* GetByName(const char* name) const;
 
-    bool TryGetByName(const char* name, D3D11ShaderParameter*& parameter) const;
+    bool TryGetByName(const char* name, D3D11DescriptorBucket*& parameter) const;
 
     void SetByName(const char* name, void* resource);
 
@@ -66,19 +115,31 @@ struct D3D11DescriptorRange
 
     using BindCallback = void(*)(const ComPtr<ID3D11DeviceContext3>& context, uint32_t startSlot, uint32_t count, void** resources);
 
-    void Bind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func) const;
+    // Returns the context setter for the given type and stage, UAVs are bound through BindUAV instead.
+    static BindCallback GetBindCallback(ShaderParameterType type, ShaderStage stage);
 
-    void BindUAV(const ComPtr<ID3D11DeviceContext3>& context) const;
+    // Binds a constant buffer sub-range through *SetConstantBuffers1, a zero 'numConstants' binds the whole buffer.
+    static void BindConstants(ID3D11DeviceContext3* context, ShaderStage stage, uint32_t slot, ID3D11Buffer* buffer, uint32_t firstConstant, uint32_t numConstants);
 
-    void Unbind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func) const;
+    // 'excluded' holds absolute slots owned by someone else (binding groups), they are neither bound nor cleared.
+    // Constant buffer sub-range overrides are rebound with *SetConstantBuffers1 after the runs.
+    void Bind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excluded = nullptr) const;
 
-    void UnbindUAV(const ComPtr<ID3D11DeviceContext3>& context) const;
+    void BindUAV(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excluded = nullptr) const;
+
+    // With 'overridden' set every declared slot is cleared, overrides may occupy slots the range itself left empty.
+    void Unbind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func, bool overridden = false, const SlotMask* excluded = nullptr) const;
+
+    void UnbindUAV(const ComPtr<ID3D11DeviceContext3>& context, bool overridden = false, const SlotMask* excluded = nullptr) const;
+
+    // Declared slots in absolute slot numbers.
+    SlotMask GetSlots() const { return declared << startSlot; }
 
     struct Enumerator
     {
         const D3D11DescriptorRange* descriptorRange;
         BindingValuePair current;
-        D3D11ShaderParameter* currentBucket;
+        D3D11DescriptorBucket* currentBucket;
 
         Enumerator(const D3D11DescriptorRange& descriptorRange)
             : descriptorRange(&descriptorRange), current{}, currentBucket(nullptr)
@@ -99,15 +160,15 @@ struct D3D11DescriptorRange
         {
             if (currentBucket == nullptr)
             {
-                currentBucket = descriptorRange->buckets.data();
+                currentBucket = descriptorRange->buckets;
                 if (currentBucket == nullptr) 
                     return false;
                 ReadFromBucket();
                 return true;
             }
 
-            auto index = currentBucket - descriptorRange->buckets.data();
-            if (index == descriptorRange->buckets.size() - 1)
+            auto index = currentBucket - descriptorRange->buckets;
+            if (index == descriptorRange->bucketCount - 1)
             {
                 return false;
             }
@@ -118,10 +179,10 @@ struct D3D11DescriptorRange
 
     	void ReadFromBucket()
         {
-            current.name = currentBucket->name.get();
+            current.name = currentBucket->name;
             current.stage = descriptorRange->stage;
-            current.type = currentBucket->type;
-            current.value = descriptorRange->resources[currentBucket->index];
+            current.type = descriptorRange->type;
+            current.value = descriptorRange->resources[currentBucket->index - descriptorRange->startSlot];
         }
 
     	void Reset()
@@ -136,4 +197,30 @@ struct D3D11DescriptorRange
     }
 };
 
+// Owns the single allocation backing a set of ranges. Ranges are laid out type-major over the given stages,
+// range headers and slot data first, the name tables behind them starting on a new cache line.
+class D3D11DescriptorStorage
+{
+    void* block = nullptr;
+    D3D11DescriptorRange* ranges = nullptr;
+    size_t rangeCount = 0;
+
+    static D3D11DescriptorRange* Layout(D3D11DescriptorArena& hot, D3D11DescriptorArena& cold, std::span<const ShaderStage> stages, const std::vector<D3D11ShaderParameter>& parameters);
+
+public:
+    static constexpr size_t Alignment = 64;
+
+    D3D11DescriptorStorage() = default;
+    ~D3D11DescriptorStorage() { Reset(); }
+
+    D3D11DescriptorStorage(const D3D11DescriptorStorage&) = delete;
+    D3D11DescriptorStorage& operator=(const D3D11DescriptorStorage&) = delete;
+
+    // Sorts 'parameters' by (type, stage) and builds one range per type and stage.
+    std::span<D3D11DescriptorRange> Build(std::span<const ShaderStage> stages, std::vector<D3D11ShaderParameter>& parameters);
+    void Reset();
+
+    std::span<D3D11DescriptorRange> GetRanges() const noexcept { return { ranges, rangeCount }; }
+};
+
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
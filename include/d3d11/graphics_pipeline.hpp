@@ -1,5 +1,7 @@
 #pragma once
 #include "common.hpp"
+#include "variable_list.hpp"
+#include <mutex>
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -22,6 +24,8 @@ protected:
 	PrismObj<Blob> pixelShaderBlob;
 	PrismObj<Blob> signatureBlob;
 	std::vector<InputElementDescription> inputElements;
+	std::shared_ptr<const D3D11VariableLayout> variableLayout;
+	std::mutex variableLayoutMutex;
 	bool valid;
 
 public:
@@ -30,6 +34,7 @@ public:
 
 	void Compile();
 	bool IsValid() const noexcept { return valid; }
+	std::shared_ptr<const D3D11VariableLayout> GetVariableLayout();
 };
 
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
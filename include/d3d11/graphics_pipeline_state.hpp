@@ -1,7 +1,8 @@
 #pragma once
 #include "common.hpp"
 #include "graphics_pipeline.hpp"
-#include "resource_binding_list.hpp"
+#include "binding_set.hpp"
+#include "../state_cache.hpp"
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -21,9 +22,12 @@ public:
 	D3D11GraphicsPipelineState(const PrismObj<D3D11GraphicsPipeline>& pipeline, const GraphicsPipelineStateDesc& desc);
 
 	ResourceBindingList& GetBindings() override { return *bindingList.get(); }
+	const D3D11ResourceBindingList& GetBindingList() const noexcept { return *bindingList; }
 
-	void SetState(ID3D11DeviceContext3* context);
-	void UnsetState(ID3D11DeviceContext3* context);
+	void SetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots);
+	void CommitBindings(ID3D11DeviceContext3* context, BindingTracker& tracker, D3D11VariableUploadCache& uploads, D3D11BindingSet* bindingSet, const SlotMask* groupSlots);
+	// 'replaced' is set when another graphics state is applied right after, its shaders and state objects are kept.
+	void UnsetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots, bool replaced = false);
 };
 
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
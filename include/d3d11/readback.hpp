@@ -0,0 +1,73 @@
+#pragma once
+#include "common.hpp"
+#include <mutex>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Recycles staging resources for readbacks by shape. Every map and unmap goes through the immediate context.
+class D3D11StagingPool
+{
+public:
+    struct Key
+    {
+        uint32_t dimension;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        DXGI_FORMAT format;
+
+        bool operator==(const Key& other) const noexcept = default;
+    };
+
+private:
+    struct Entry
+    {
+        Key key;
+        ComPtr<ID3D11Resource> resource;
+    };
+
+    ComPtr<ID3D11Device> device;
+    ComPtr<ID3D11DeviceContext> context;
+    std::mutex mutex;
+    std::vector<Entry> freeList;
+
+    ComPtr<ID3D11Resource> Create(const Key& key);
+
+public:
+    D3D11StagingPool(ID3D11Device* device, ID3D11DeviceContext* context) : device(device), context(context)
+    {
+    }
+
+    ID3D11DeviceContext* GetContext() const { return context.Get(); }
+    size_t GetFreeCount();
+
+    ComPtr<ID3D11Resource> Acquire(const Key& key);
+    void Recycle(const Key& key, ComPtr<ID3D11Resource>&& resource);
+
+    // Drops every idle staging resource.
+    void Trim();
+};
+
+class D3D11Readback : public Readback
+{
+    std::shared_ptr<D3D11StagingPool> pool;
+    D3D11StagingPool::Key key;
+    ComPtr<ID3D11Resource> staging;
+    ReadbackData data = {};
+    bool mapped = false;
+
+    bool TryMap(bool wait);
+
+public:
+    D3D11Readback(std::shared_ptr<D3D11StagingPool> pool, const D3D11StagingPool::Key& key, ComPtr<ID3D11Resource>&& staging)
+        : pool(std::move(pool)), key(key), staging(std::move(staging))
+    {
+    }
+    ~D3D11Readback() override;
+
+    bool IsReady() override { return mapped || TryMap(false); }
+    const ReadbackData& Wait() override;
+    const ReadbackData& GetData() const override { return data; }
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -1,5 +1,11 @@
 #pragma once
 #include "descriptor_range.hpp"
+#include "variable_list.hpp"
+#include "../binding_tracker.hpp"
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
@@ -10,19 +16,35 @@ struct D3D11ShaderParameterState
     uint32_t InitialCount;
 };
 
-struct D3D11VariableListRange
-{
-    void Release() {}
-    bool TrySetByName(const char* name, const void* value) { return false; }
-    void Upload(void* context) {}
-};
+class D3D11ResourceBindingList;
 
-class D3D11GlobalResourceList
+// Keeps a reverse index from global names to the binding lists that declare them,
+// so a global change only touches lists that actually reference the name.
+class D3D11GlobalResourceList final : public GlobalResourceList
 {
+    struct Entry
+    {
+        std::string name;
+        D3D11ShaderParameterState state;
+        std::vector<D3D11ResourceBindingList*> subscribers;
+    };
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, uint32_t> nameToId;
+
+    uint32_t GetOrCreateId(const char* name);
+    void SetState(const char* name, D3D11ShaderParameterState state);
+
 public:
-    using StateChangedHandlerList = EventHandlerList<std::function<void(const char*, D3D11ShaderParameterState, D3D11ShaderParameterState)>>;
-    static StateChangedHandlerList StateChanged;
-    static void SetState(void* bindingList) {}
+    void SetCBV(const char* name, Buffer* buffer) override;
+    void SetSampler(const char* name, SamplerState* sampler) override;
+    void SetSRV(const char* name, ShaderResourceView* view) override;
+    void SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount = static_cast<uint32_t>(-1)) override;
+
+    // Subscribes the binding list to every name it declares and applies the current global values.
+    void Register(D3D11ResourceBindingList* bindingList, const std::vector<const char*>& names, std::vector<uint32_t>& ids);
+    void Unregister(D3D11ResourceBindingList* bindingList, std::vector<uint32_t>& ids);
 };
 
 class D3D11GraphicsPipeline;
@@ -33,14 +55,25 @@ class D3D11ResourceBindingList final : public ResourceBindingList
 private:
     Pipeline* pipeline;
     PipelineStateFlags flags;
-    std::vector<D3D11DescriptorRange> rangesSRVs;
-    std::vector<D3D11DescriptorRange> rangesUAVs;
-    std::vector<D3D11DescriptorRange> rangesCBVs;
-    std::vector<D3D11DescriptorRange> rangesSamplers;
-    std::vector<D3D11VariableListRange> rangesVariables;
+    // Range headers, slot data and the name tables share one allocation, the spans point into it.
+    D3D11DescriptorStorage storage;
+    std::span<D3D11DescriptorRange> rangesSRVs;
+    std::span<D3D11DescriptorRange> rangesUAVs;
+    std::span<D3D11DescriptorRange> rangesCBVs;
+    std::span<D3D11DescriptorRange> rangesSamplers;
+    std::unique_ptr<D3D11VariableList> variables;
+    BindingVersionTable versions;
+    uint64_t layoutVersion = 0;
+    // Slots of the reserved push constant cbuffer, owned by the command list and never bound by the list itself.
+    uint32_t pushConstantSlots[BindingVersionTable::StageCount] = {};
+    ShaderStageFlags pushConstantStages = ShaderStageFlags::None;
+    ID3D11Device* device;
+    D3D11GlobalResourceList* globals;
+    std::vector<uint32_t> globalIds;
 
     EventHandlerList<std::function<void(Pipeline*)>>::EventHandlerToken onCompileToken;
-    D3D11GlobalResourceList::StateChangedHandlerList::EventHandlerToken globalStateChangedToken;
+
+    friend class D3D11GlobalResourceList;
 
 public:
     D3D11ResourceBindingList(D3D11GraphicsPipeline* pipeline, PipelineStateFlags flags);
@@ -48,14 +81,23 @@ public:
     ~D3D11ResourceBindingList() override;
 
     Pipeline* GetPipeline() const override { return pipeline; }
-
-    void Hook();
+    PipelineStateFlags GetFlags() const noexcept { return flags; }
+    const BindingVersionTable& GetVersions() const noexcept { return versions; }
+    uint64_t GetLayoutVersion() const noexcept { return layoutVersion; }
+    std::span<const D3D11DescriptorRange> GetRanges(ShaderParameterType type) const noexcept;
+    ShaderStageFlags GetPushConstantStages() const noexcept { return pushConstantStages; }
+    uint32_t GetPushConstantSlot(ShaderStage stage) const noexcept { return pushConstantSlots[static_cast<uint32_t>(stage)]; }
 
 private:
     void GlobalStateChanged(const char* name, D3D11ShaderParameterState oldState, D3D11ShaderParameterState state);
     void OnPipelineCompile(Pipeline* pipeline);
-    void Reflect(const PrismObj<Blob>& shader, ShaderStage stage);
+    void Reflect(const PrismObj<Blob>& shader, ShaderStage stage, std::vector<D3D11ShaderParameter>& parameters);
+    void Build(std::span<const ShaderStage> stages, std::vector<D3D11ShaderParameter>& parameters);
     void Clear();
+    void RegisterGlobals();
+    bool SetByName(D3D11DescriptorRange& range, const char* name, void* resource, uint32_t initialCount = static_cast<uint32_t>(-1));
+    void UpdateByName(D3D11DescriptorRange& range, const char* name, void* oldResource, void* resource, uint32_t initialCount = static_cast<uint32_t>(-1));
+    bool WriteVariable(const char* name, uint32_t stageMask, const void* value, size_t size);
 
 public:
     void SetSRV(const char* name, ShaderResourceView* srv) override;
@@ -67,13 +109,13 @@ public:
     void SetSampler(const char* name, SamplerState* sampler) override;
     void SetSampler(const char* name, void* sampler);
 
+    // Writes into the CPU shadow copy of every constant buffer declaring the variable, requires PipelineStateFlags::ReflectVariables.
+    // Like the other setters it must not run while a command list records with the pipeline state.
     template<typename T>
     void SetVariable(const char* name, const T& value)
     {
-        for (auto& var : rangesVariables)
-        {
-            var.TrySetByName(name, &value);
-        }
+        static_assert(std::is_trivially_copyable_v<T>, "Shader variables must be trivially copyable");
+        WriteVariable(name, ~0u, &value, sizeof(T));
     }
 
     void SetSRV(const char* name, ShaderStage stage, ShaderResourceView* srv) override;
@@ -84,15 +126,21 @@ public:
     template<typename T>
     void SetVariable(const char* name, ShaderStage stage, const T& value)
     {
-        rangesVariables[static_cast<size_t>(stage)].TrySetByName(name, &value);
+        static_assert(std::is_trivially_copyable_v<T>, "Shader variables must be trivially copyable");
+        WriteVariable(name, 1u << static_cast<uint32_t>(stage), &value, sizeof(T));
     }
 
-    void UploadState(void* context);
-
-    void BindGraphics(const ComPtr<ID3D11DeviceContext3>& context);
-    void UnbindGraphics(const ComPtr<ID3D11DeviceContext3>& context);
-    void BindCompute(const ComPtr<ID3D11DeviceContext3>& context);
-    void UnbindCompute(const ComPtr<ID3D11DeviceContext3>& context);
+    // Uploads the shadow copies the command list has not seen yet. Only reads the list, so command lists on different
+    // threads may share the pipeline state.
+    void UploadState(ID3D11DeviceContext3* context, D3D11VariableUploadCache& uploads) const;
+
+    // 'overrides' come from D3D11BindingSet::Resolve and are patched over the list's own resources. 'excludedSlots'
+    // holds one absolute slot mask per BindingVersionTable range, slots owned by attached binding groups are skipped.
+    void BindGraphics(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges = BindingVersionTable::AllRanges, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excludedSlots = nullptr);
+    void UnbindGraphics(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excludedSlots = nullptr);
+    void BindCompute(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges = BindingVersionTable::AllRanges, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excludedSlots = nullptr);
+    void UnbindCompute(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excludedSlots = nullptr);
+    void UnbindComputeUAVs(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides = {}, const SlotMask* excludedSlots = nullptr);
 
 	// TODO: Implement iterators
     iterator_pair GetSRVs() override { return {}; }
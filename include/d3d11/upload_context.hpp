@@ -0,0 +1,55 @@
+#pragma once
+#include "common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Buffer uploads are written into staging chunks that are used round robin. A chunk collects uploads until it is
+// full or flushed, then its copies are issued and an event query marks when the GPU is done reading it. Uploads
+// that continue the previous one, same destination and adjacent range, extend its copy instead of adding one.
+// D3D11 cannot copy from a buffer into a texture, texture uploads go through UpdateSubresource, which the driver
+// batches through its own upload memory.
+class D3D11UploadContext : public UploadContext
+{
+    struct PendingCopy
+    {
+        ID3D11Buffer* dst;
+        uint32_t dstOffset;
+        uint32_t srcOffset;
+        uint32_t size;
+    };
+
+    struct Chunk
+    {
+        ComPtr<ID3D11Buffer> buffer;
+        ComPtr<ID3D11Query> query;
+        bool busy = false;
+    };
+
+    ComPtr<ID3D11DeviceContext> context;
+    uint32_t chunkSize;
+    std::vector<Chunk> chunks;
+    std::vector<PendingCopy> pending;
+    uint32_t current = 0;
+    uint8_t* mapped = nullptr;
+    uint32_t used = 0;
+
+    UploadStats frameStats;
+    UploadStats totalStats;
+
+    bool IsChunkIdle(Chunk& chunk, bool wait);
+    void OpenChunk();
+    void Account(uint64_t bytes, uint32_t copies);
+
+public:
+    D3D11UploadContext(ID3D11Device* device, ID3D11DeviceContext* context, uint32_t chunkSize, uint32_t chunkCount);
+    ~D3D11UploadContext() override;
+
+    void UploadBuffer(Buffer* dst, uint32_t dstOffset, const void* data, uint32_t size) override;
+    void UploadTexture(Resource* dst, uint32_t subresource, const SubresourceData& data, const Box* region = nullptr) override;
+    void Flush() override;
+    UploadStats EndFrame() override;
+    const UploadStats& GetFrameStats() const override { return frameStats; }
+    const UploadStats& GetTotalStats() const override { return totalStats; }
+};
+
+HEXA_PRISM_NAMESPACE_END
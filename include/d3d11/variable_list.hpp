@@ -0,0 +1,84 @@
+#pragma once
+#include "common.hpp"
+#include <unordered_map>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct D3D11ShaderVariable
+{
+    String name;
+    uint32_t hash;
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct D3D11ConstantBufferLayout
+{
+    String name;
+    uint32_t hash;
+    uint32_t size;
+    uint32_t shadowOffset;
+    uint32_t stageMask;
+    std::vector<D3D11ShaderVariable> variables;
+};
+
+// Reflected constant buffer layouts of all stages of a pipeline. Built once per pipeline compile and shared
+// by every binding list created from it, a constant buffer declared by several stages is stored once.
+class D3D11VariableLayout
+{
+public:
+    std::vector<D3D11ConstantBufferLayout> buffers;
+    std::vector<uint8_t> defaults;
+
+    void Reflect(const PrismObj<Blob>& shader, ShaderStage stage);
+    void Finalize();
+};
+
+// Versions of the reflected constant buffers a command list has uploaded, so recording never writes to the shared
+// variable list. Invalidated whenever the buffer contents on the GPU timeline may differ from the last upload.
+class D3D11VariableUploadCache
+{
+    struct Entry
+    {
+        uint64_t version;
+        uint64_t generation;
+    };
+
+    // Keyed by variable list id and buffer index. Invalidating bumps the generation instead of clearing, so the nodes
+    // stay allocated and steady state recording does not allocate. Entries of destroyed lists are only dropped once
+    // the map grows past MaxEntries.
+    static constexpr size_t MaxEntries = 4096;
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t generation = 0;
+
+public:
+    // Returns true if the command list has uploaded this version of the buffer since the last invalidation.
+    bool IsCurrent(uint64_t listId, uint32_t index, uint64_t version) const;
+    void Record(uint64_t listId, uint32_t index, uint64_t version);
+    void Invalidate() noexcept;
+};
+
+// Per binding list CPU shadow copies of the reflected constant buffers. Writes only touch the shadow memory and bump
+// the version of the buffer, Upload pushes every buffer the command list has not seen in its current version with a
+// single WriteDiscard map. Writes and buffer creation must not run concurrently with recording that uses the list,
+// Upload only reads and may run on several command lists at once.
+class D3D11VariableList
+{
+    std::shared_ptr<const D3D11VariableLayout> layout;
+    std::vector<uint8_t> shadow;
+    std::vector<ComPtr<ID3D11Buffer>> buffers;
+    std::vector<uint64_t> versions;
+    uint64_t id;
+
+public:
+    explicit D3D11VariableList(std::shared_ptr<const D3D11VariableLayout> layout);
+
+    const D3D11VariableLayout& GetLayout() const noexcept { return *layout; }
+    ID3D11Buffer* GetBuffer(uint32_t index) const noexcept { return buffers[index].Get(); }
+
+    ID3D11Buffer* CreateBuffer(ID3D11Device* device, uint32_t index);
+    void Write(uint32_t index, const D3D11ShaderVariable& variable, const void* data, size_t size);
+    void Upload(ID3D11DeviceContext3* context, D3D11VariableUploadCache& cache) const;
+};
+
+HEXA_PRISM_NAMESPACE_END
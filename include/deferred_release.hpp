@@ -0,0 +1,64 @@
+#pragma once
+#include "prism.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Holds the last reference of objects the GPU may still use until the fence value they were retired at completed.
+// Collect drops every completed reference in one batch, optionally on a background thread, so freeing many resources
+// at once does not show up on the frame thread. Values are fence values, e.g. FrameRing::GetLastSubmittedValue() + 1
+// for the frame being recorded.
+class DeferredReleaseQueue
+{
+	struct Entry
+	{
+		uint64_t value;
+		PrismObject* object;
+	};
+
+	Fence* fence;
+	std::mutex mutex;
+	std::deque<Entry> pending;
+
+	std::mutex workerMutex;
+	std::condition_variable workerCondition;
+	std::vector<PrismObject*> workerBatch;
+	bool workerBusy = false;
+	bool stopping = false;
+	std::jthread worker;
+
+	void RunWorker();
+	static void ReleaseAll(std::vector<PrismObject*>& objects) noexcept;
+
+public:
+	// Without a fence Collect has to be given the completed value. With 'background' the releases run on a worker.
+	explicit DeferredReleaseQueue(Fence* fence = nullptr, bool background = true);
+	// Releases everything still queued, the GPU must be idle by then.
+	~DeferredReleaseQueue();
+
+	DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+	DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+
+	size_t GetPendingCount();
+
+	// Takes over one reference of 'object', it is released once 'value' completed. Safe to call from any thread.
+	void Retire(PrismObject* object, uint64_t value);
+
+	template<typename T>
+	void Retire(PrismObj<T>&& object, uint64_t value)
+	{
+		Retire(static_cast<PrismObject*>(object.Detach()), value);
+	}
+
+	// Releases every object retired at or before the completed value of the fence, returns how many were released.
+	uint32_t Collect();
+	uint32_t Collect(uint64_t completedValue);
+
+	// Blocks until the background worker released everything handed to it.
+	void Flush();
+};
+
+HEXA_PRISM_NAMESPACE_END
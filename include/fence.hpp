@@ -0,0 +1,17 @@
+#pragma once
+#include "prism_object.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Monotonic 64 bit counter the GPU advances when it reaches a CommandList::Signal, the CPU observes or waits for it.
+class Fence : public DeviceChild
+{
+public:
+	static constexpr uint32_t Infinite = UINT32_MAX;
+
+	virtual uint64_t GetCompletedValue() = 0;
+	// Blocks until the fence reached 'value' or 'timeoutMs' elapsed, returns whether the value was reached.
+	virtual bool Wait(uint64_t value, uint32_t timeoutMs = Infinite) = 0;
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,193 @@
+#pragma once
+#include "prism.hpp"
+#include "resource_pool.hpp"
+#include <functional>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct FrameGraphResource
+{
+	static constexpr uint32_t Invalid = UINT32_MAX;
+
+	uint32_t index = Invalid;
+
+	bool IsValid() const noexcept { return index != Invalid; }
+};
+
+enum class FrameGraphAccess : uint8_t
+{
+	ShaderResource,
+	RenderTarget,
+	DepthStencil,
+	UnorderedAccess,
+};
+
+// Non owning views of a graph texture, null where the desc lacks the access flag.
+struct FrameGraphTexture
+{
+	Texture2D* texture = nullptr;
+	RenderTargetView* rtv = nullptr;
+	ShaderResourceView* srv = nullptr;
+	UnorderedAccessView* uav = nullptr;
+	DepthStencilView* dsv = nullptr;
+};
+
+struct FrameGraphStats
+{
+	uint32_t passes = 0;
+	uint32_t culledPasses = 0;
+	// Transient textures declared by live passes and the pooled textures backing them after aliasing.
+	uint32_t transientTextures = 0;
+	uint32_t physicalTextures = 0;
+	// Unbinds inserted between passes.
+	uint32_t unbinds = 0;
+	bool recompiled = false;
+};
+
+class FrameGraph;
+
+class FrameGraphContext
+{
+	friend class FrameGraph;
+
+	const FrameGraph* graph;
+	CommandList* commandList;
+
+	FrameGraphContext(const FrameGraph* graph, CommandList* commandList) : graph(graph), commandList(commandList)
+	{
+	}
+
+public:
+	CommandList* GetCommandList() const noexcept { return commandList; }
+	const FrameGraphTexture& GetTexture(FrameGraphResource resource) const;
+};
+
+// Declares the resource accesses of the pass last added to the graph.
+class FrameGraphPassBuilder
+{
+	friend class FrameGraph;
+
+	FrameGraph* graph;
+	uint32_t pass;
+
+	FrameGraphPassBuilder(FrameGraph* graph, uint32_t pass) : graph(graph), pass(pass)
+	{
+	}
+
+public:
+	FrameGraphPassBuilder& Read(FrameGraphResource resource);
+	FrameGraphPassBuilder& Write(FrameGraphResource resource, FrameGraphAccess access);
+	// Keeps the pass even when nothing reads its outputs, e.g. for readbacks or presenting.
+	FrameGraphPassBuilder& SetSideEffects();
+};
+
+// Passes declare the textures they read and write, the graph derives the rest. Passes run in declaration order,
+// a pass is culled unless it has side effects, writes an imported texture or writes a texture a later live pass
+// accesses. Writes load the existing contents, so a depth prepass stays alive for the pass that depth tests against
+// it. Transient textures live from the first to the last live pass using them, textures with equal descs and
+// disjoint lifetimes share one pooled texture, so a transient texture has undefined contents until its first write.
+// Before a pass the graph unbinds shader resources it is about to write and render targets or unordered access
+// views it is about to read. The compiled graph is kept and reused while the next frame declares the same passes,
+// accesses and descs, imported views may change freely.
+class FrameGraph
+{
+	friend class FrameGraphContext;
+	friend class FrameGraphPassBuilder;
+
+	struct Resource
+	{
+		const char* name;
+		Texture2DDesc desc;
+		bool imported;
+		FrameGraphTexture views;
+	};
+
+	struct Access
+	{
+		uint32_t resource;
+		FrameGraphAccess access;
+	};
+
+	struct PassShape
+	{
+		uint32_t firstAccess;
+		uint32_t accessCount;
+		bool sideEffects;
+	};
+
+	struct Pass
+	{
+		const char* name;
+		std::function<void(FrameGraphContext&)> execute;
+		PassShape shape;
+	};
+
+	enum PassTransitions : uint8_t
+	{
+		UnbindShaderResources = 1 << 0,
+		UnbindRenderTargets = 1 << 1,
+	};
+
+	struct CompiledPass
+	{
+		uint32_t pass;
+		uint8_t transitions;
+	};
+
+	struct CompiledResource
+	{
+		Texture2DDesc desc;
+		bool imported;
+		// Physical slot of a transient texture, Invalid for imported and unused ones.
+		uint32_t slot;
+	};
+
+	TransientResourcePool* pool;
+
+	std::vector<Resource> resources;
+	std::vector<Access> accesses;
+	std::vector<Pass> passes;
+
+	// Declaration the compiled state was built from.
+	bool compiled = false;
+	std::vector<CompiledResource> compiledResources;
+	std::vector<Access> compiledAccesses;
+	std::vector<PassShape> compiledPasses;
+
+	std::vector<CompiledPass> schedule;
+	std::vector<Texture2DDesc> slotDescs;
+	std::vector<PooledTexture*> slotTextures;
+	FrameGraphStats stats;
+
+	bool MatchesCompiled() const noexcept;
+	void Cull(std::vector<bool>& live) const;
+	void AssignSlots();
+	void ComputeTransitions();
+	void ReleaseSlots() noexcept;
+
+public:
+	explicit FrameGraph(TransientResourcePool* pool);
+
+	FrameGraph(const FrameGraph&) = delete;
+	FrameGraph& operator=(const FrameGraph&) = delete;
+
+	// Names are not copied and must stay valid until Execute returned.
+	FrameGraphResource CreateTexture(const char* name, const Texture2DDesc& desc);
+	FrameGraphResource ImportTexture(const char* name, const FrameGraphTexture& views);
+
+	FrameGraphPassBuilder AddPass(const char* name, std::function<void(FrameGraphContext&)> execute);
+
+	// Builds the schedule unless the declaration matches the cached one, returns whether it was rebuilt.
+	bool Compile();
+
+	// Compiles, acquires the transient textures from the pool, records the live passes and hands the textures back.
+	// Call EndFrame on the pool once per frame to age out textures the graph stopped using.
+	void Execute(CommandList* commandList);
+
+	// Drops the declarations for the next frame, the compiled state is kept.
+	void Reset() noexcept;
+
+	const FrameGraphStats& GetStats() const noexcept { return stats; }
+};
+
+HEXA_PRISM_NAMESPACE_END
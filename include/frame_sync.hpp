@@ -0,0 +1,110 @@
+#pragma once
+#include "fence.hpp"
+#include <condition_variable>
+#include <mutex>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Fence advanced from the CPU, for backends without a GPU and for driving the frame helpers in tests.
+class CpuFence : public Fence
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	uint64_t value;
+
+public:
+	explicit CpuFence(uint64_t initialValue = 0) : value(initialValue)
+	{
+	}
+
+	// Values never go backwards, signaling a lower value is ignored.
+	void Signal(uint64_t newValue);
+
+	uint64_t GetCompletedValue() override;
+	bool Wait(uint64_t target, uint32_t timeoutMs = Infinite) override;
+	void* GetNativePointer() override { return nullptr; }
+};
+
+// Ring of N frames in flight, each with its own set of per frame resources. BeginFrame waits until the GPU is done
+// with the frame that last used the slot, so everything in it, dynamic buffers, staging and transient allocations,
+// can be recycled without stalling on the frames still in flight. Only the fence is touched, any backend works.
+template<typename TFrame>
+class FrameRing
+{
+	Fence* fence;
+	std::vector<TFrame> frames;
+	std::vector<uint64_t> frameValues;
+	uint64_t nextValue;
+	uint32_t current;
+	bool inFrame = false;
+
+public:
+	// Frame values continue after the current value of the fence.
+	FrameRing(Fence* fence, uint32_t frameCount) : fence(fence), frames(frameCount), frameValues(frameCount, 0), nextValue(fence->GetCompletedValue() + 1), current(frameCount - 1)
+	{
+		if (frameCount == 0)
+		{
+			throw std::invalid_argument("Frame ring needs at least one frame");
+		}
+	}
+
+	uint32_t GetFrameCount() const noexcept { return static_cast<uint32_t>(frames.size()); }
+	uint32_t GetFrameIndex() const noexcept { return current; }
+	TFrame& GetFrame() noexcept { return frames[current]; }
+	TFrame& GetFrame(uint32_t index) { return frames.at(index); }
+	// Fence value of the last frame that ended, zero before the first one.
+	uint64_t GetLastSubmittedValue() const noexcept { return nextValue - 1; }
+
+	// Advances to the next slot and waits for its previous use to complete. Returns null if the wait timed out,
+	// the ring stays on the previous slot then and BeginFrame can be retried.
+	TFrame* BeginFrame(uint32_t timeoutMs = Fence::Infinite)
+	{
+		if (inFrame)
+		{
+			throw std::runtime_error("BeginFrame called twice without EndFrame.");
+		}
+
+		const uint32_t next = (current + 1) % GetFrameCount();
+		const uint64_t value = frameValues[next];
+		if (value != 0 && !fence->Wait(value, timeoutMs))
+		{
+			return nullptr;
+		}
+
+		current = next;
+		inFrame = true;
+		return &frames[current];
+	}
+
+	// Closes the frame and returns the fence value that marks its completion, the caller signals it once the
+	// frame's work was submitted.
+	uint64_t EndFrame()
+	{
+		if (!inFrame)
+		{
+			throw std::runtime_error("EndFrame called without BeginFrame.");
+		}
+
+		inFrame = false;
+		frameValues[current] = nextValue;
+		return nextValue++;
+	}
+
+	// Closes the frame and signals its value on 'commandList'. Templated so the ring does not depend on the command
+	// list definition, any type with a Signal(Fence*, uint64_t) member works.
+	template<typename TCommandList>
+	uint64_t EndFrame(TCommandList* commandList)
+	{
+		const uint64_t value = EndFrame();
+		commandList->Signal(fence, value);
+		return value;
+	}
+
+	// Waits for every frame in flight, e.g. before resizing or destroying the per frame resources.
+	bool WaitIdle(uint32_t timeoutMs = Fence::Infinite)
+	{
+		return fence->Wait(nextValue - 1, timeoutMs);
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
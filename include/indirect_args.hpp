@@ -0,0 +1,99 @@
+#pragma once
+#include "prism.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// Layout of one DrawIndexedInstancedIndirect argument record.
+struct DrawIndexedIndirectArgs
+{
+	uint32_t indexCountPerInstance;
+	uint32_t instanceCount;
+	uint32_t startIndexLocation;
+	int32_t baseVertexLocation;
+	uint32_t startInstanceLocation;
+};
+
+// Layout of one DrawInstancedIndirect argument record.
+struct DrawIndirectArgs
+{
+	uint32_t vertexCountPerInstance;
+	uint32_t instanceCount;
+	uint32_t startVertexLocation;
+	uint32_t startInstanceLocation;
+};
+
+// Packs argument records on the CPU for the multi draw calls of CommandList. Records are written 'stride' bytes
+// apart, the bytes behind each record hold an optional per draw payload a shader can fetch by draw index.
+template<typename TArgs>
+class IndirectArgsPacker
+{
+	std::vector<uint8_t> data;
+	uint32_t stride;
+	uint32_t count = 0;
+
+public:
+	explicit IndirectArgsPacker(uint32_t stride = sizeof(TArgs)) : stride(stride)
+	{
+		if (stride < sizeof(TArgs) || stride % 4 != 0)
+		{
+			throw std::invalid_argument("Indirect argument stride must hold a record and be a multiple of 4");
+		}
+	}
+
+	uint32_t GetStride() const noexcept { return stride; }
+	uint32_t GetCount() const noexcept { return count; }
+	uint32_t GetSizeInBytes() const noexcept { return static_cast<uint32_t>(data.size()); }
+	const uint8_t* GetData() const noexcept { return data.data(); }
+
+	void Add(const TArgs& args, const void* payload = nullptr, uint32_t payloadSize = 0)
+	{
+		if (payloadSize > stride - sizeof(TArgs))
+		{
+			throw std::invalid_argument("Indirect argument payload exceeds the stride");
+		}
+
+		const size_t offset = data.size();
+		data.resize(offset + stride);
+		memcpy(data.data() + offset, &args, sizeof(TArgs));
+		if (payloadSize != 0)
+		{
+			memcpy(data.data() + offset + sizeof(TArgs), payload, payloadSize);
+		}
+		count++;
+	}
+
+	// Keeps the capacity.
+	void Clear() noexcept
+	{
+		data.clear();
+		count = 0;
+	}
+
+	// Writes the records into a CPU writable argument buffer and the record count into the first four bytes of
+	// 'countBuffer', if given. Records that do not fit are dropped, returns the number written. The rest of the
+	// argument buffer is discarded, so pass the returned count as 'maxCount' to the multi draw calls.
+	uint32_t Upload(CommandList* commandList, Buffer* argsBuffer, Buffer* countBuffer = nullptr) const
+	{
+		const uint32_t written = std::min(count, argsBuffer->GetDesc().widthInBytes / stride);
+		if (written != 0)
+		{
+			auto mapped = commandList->Map(argsBuffer, 0, MapType::WriteDiscard, MapFlags::None);
+			memcpy(mapped.data, data.data(), static_cast<size_t>(written) * stride);
+			commandList->Unmap(argsBuffer, 0);
+		}
+
+		if (countBuffer)
+		{
+			auto mapped = commandList->Map(countBuffer, 0, MapType::WriteDiscard, MapFlags::None);
+			memcpy(mapped.data, &written, sizeof(written));
+			commandList->Unmap(countBuffer, 0);
+		}
+
+		return written;
+	}
+};
+
+using DrawIndexedArgsPacker = IndirectArgsPacker<DrawIndexedIndirectArgs>;
+using DrawArgsPacker = IndirectArgsPacker<DrawIndirectArgs>;
+
+HEXA_PRISM_NAMESPACE_END
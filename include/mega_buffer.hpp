@@ -0,0 +1,79 @@
+#pragma once
+#include "prism.hpp"
+#include "offset_allocator.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct MegaBufferHandle
+{
+	static constexpr uint32_t Invalid = UINT32_MAX;
+
+	uint32_t index = Invalid;
+
+	bool IsValid() const noexcept { return index != Invalid; }
+};
+
+struct MegaBufferDesc
+{
+	BufferType type = BufferType::VertexBuffer;
+	uint32_t capacity = 64u << 20;
+	uint32_t maxAllocations = 64 * 1024;
+	GpuAccessFlags gpuAccessFlags = GpuAccessFlags::Read;
+};
+
+// One large vertex or index buffer shared by many meshes. Ranges are sub-allocated with the offset allocator and
+// aligned to the vertex stride or index size, so a draw selects its mesh through the base vertex or first index and
+// the buffer stays bound. Handles stay valid across Defragment, offsets do not, read them again once the generation
+// changed.
+class MegaBuffer
+{
+	struct Range
+	{
+		OffsetAllocation allocation;
+		uint32_t size = 0;
+		uint32_t alignment = 1;
+		bool live = false;
+	};
+
+	GraphicsDevice* device;
+	MegaBufferDesc desc;
+	PrismObj<Buffer> buffer;
+	OffsetAllocator allocator;
+	std::vector<Range> ranges;
+	std::vector<uint32_t> freeHandles;
+	uint32_t generation = 0;
+	uint32_t usedBytes = 0;
+
+	PrismObj<Buffer> CreateBuffer();
+	const Range& GetRange(MegaBufferHandle handle) const;
+
+public:
+	MegaBuffer(GraphicsDevice* device, const MegaBufferDesc& desc);
+
+	Buffer* GetBuffer() const noexcept { return buffer.Get(); }
+	uint32_t GetCapacity() const noexcept { return desc.capacity; }
+	uint32_t GetUsedBytes() const noexcept { return usedBytes; }
+	uint32_t GetGeneration() const noexcept { return generation; }
+	OffsetAllocatorReport GetReport() const { return allocator.GetReport(); }
+
+	// 'alignment' is the vertex stride or index size, any value works. Returns an invalid handle when full.
+	MegaBufferHandle Allocate(uint32_t size, uint32_t alignment);
+	void Free(MegaBufferHandle handle);
+
+	uint32_t GetOffset(MegaBufferHandle handle) const { return GetRange(handle).allocation.offset; }
+	uint32_t GetSize(MegaBufferHandle handle) const { return GetRange(handle).size; }
+
+	// Base vertex or first index of the range, for DrawIndexedInstanced.
+	int32_t GetBaseVertex(MegaBufferHandle handle, uint32_t stride) const { return static_cast<int32_t>(GetOffset(handle) / stride); }
+	uint32_t GetFirstIndex(MegaBufferHandle handle, uint32_t indexSize) const { return GetOffset(handle) / indexSize; }
+
+	// Writes 'size' bytes at 'offset' within the range.
+	void Upload(CommandList* commandList, MegaBufferHandle handle, const void* data, uint32_t size, uint32_t offset = 0);
+
+	// Packs every live range to the front of a new buffer with one copy per run of adjacent ranges, and drops the
+	// old buffer, the caller keeps it alive until the GPU is done if draws still reference it. Rebind the buffer
+	// and refetch offsets afterwards. Returns the number of copies issued, zero also if the ranges could not be packed.
+	uint32_t Defragment(CommandList* commandList, PrismObj<Buffer>* previousBuffer = nullptr);
+};
+
+HEXA_PRISM_NAMESPACE_END
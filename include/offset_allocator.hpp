@@ -0,0 +1,86 @@
+#pragma once
+#include "common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct OffsetAllocation
+{
+	static constexpr uint32_t NoSpace = UINT32_MAX;
+
+	uint32_t offset = NoSpace;
+	// Allocator node, needed to free the allocation.
+	uint32_t metadata = NoSpace;
+
+	bool IsValid() const noexcept { return offset != NoSpace; }
+};
+
+struct OffsetAllocatorReport
+{
+	uint32_t totalFree;
+	uint32_t largestFree;
+};
+
+// Two level segregated fit allocator over an abstract range of [0, size), it hands out offsets and never touches
+// memory, so it can manage GPU buffers, descriptor ranges or anything else addressed by offset. Free ranges are kept
+// in 256 bins whose sizes form a float with a 3 bit mantissa, two bit masks find the smallest fitting bin with a pair
+// of bit scans, and freeing merges with free neighbours. Allocate and Free are O(1).
+class OffsetAllocator
+{
+public:
+	static constexpr uint32_t TopBinCount = 32;
+	static constexpr uint32_t BinsPerLeaf = 8;
+	static constexpr uint32_t LeafBinCount = TopBinCount * BinsPerLeaf;
+
+private:
+	static constexpr uint32_t Unused = UINT32_MAX;
+
+	struct Node
+	{
+		uint32_t dataOffset = 0;
+		uint32_t dataSize = 0;
+		uint32_t binListPrev = Unused;
+		uint32_t binListNext = Unused;
+		uint32_t neighborPrev = Unused;
+		uint32_t neighborNext = Unused;
+		bool used = false;
+	};
+
+	uint32_t size;
+	uint32_t maxAllocations;
+	uint32_t freeStorage = 0;
+
+	uint32_t usedBinsTop = 0;
+	uint8_t usedBins[TopBinCount] = {};
+	uint32_t binIndices[LeafBinCount];
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> freeNodes;
+
+	uint32_t InsertNodeIntoBin(uint32_t dataSize, uint32_t dataOffset);
+	void RemoveNodeFromBin(uint32_t nodeIndex);
+
+public:
+	explicit OffsetAllocator(uint32_t size, uint32_t maxAllocations = 128 * 1024);
+
+	uint32_t GetSize() const noexcept { return size; }
+	uint32_t GetMaxAllocations() const noexcept { return maxAllocations; }
+
+	// 'alignment' may be any value, the allocation is padded by up to alignment - 1 bytes to reach it. Returns an
+	// invalid allocation when no free range fits or every node is in use.
+	OffsetAllocation Allocate(uint32_t allocationSize, uint32_t alignment = 1);
+	void Free(OffsetAllocation allocation);
+
+	// Size of the allocation including its alignment padding.
+	uint32_t GetAllocationSize(OffsetAllocation allocation) const;
+	OffsetAllocatorReport GetReport() const;
+
+	// Frees every allocation at once.
+	void Reset();
+
+	// Bin of a size, rounded up for requests and down for free ranges, and the smallest size of a bin.
+	static uint32_t SizeToBinRoundUp(uint32_t value) noexcept;
+	static uint32_t SizeToBinRoundDown(uint32_t value) noexcept;
+	static uint32_t BinToSize(uint32_t bin) noexcept;
+};
+
+HEXA_PRISM_NAMESPACE_END
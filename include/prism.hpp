@@ -2,6 +2,8 @@
 #include "common.hpp"
 #include "prism_base.hpp"
 #include "prism_common.hpp"
+#include "fence.hpp"
+#include "state_cache.hpp"
 #include "prism_graphics_pipeline.hpp"
 #include "prism_compute_pipeline.hpp"
 
@@ -53,6 +55,8 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		ConstantBuffer,
 		VertexBuffer,
 		IndexBuffer,
+		// Argument buffer for the indirect draw and dispatch calls.
+		IndirectArgs,
 	};
 
 	struct BufferDesc
@@ -688,12 +692,119 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		const QueryDesc& GetDesc() const { return desc; }
 	};
 
+	struct ReadbackData
+	{
+		const void* data;
+		uint32_t rowPitch;
+		uint32_t depthPitch;
+	};
+
+	// Pending GPU to CPU copy of a resource region. Once ready the staging copy stays mapped and GetData is a view of
+	// it, no copy is made. Releasing the handle unmaps it and returns the staging resource to the pool of the device,
+	// release it on the thread that owns the immediate command list.
+	class Readback : public PrismObject
+	{
+	public:
+		// Polls without blocking, true once the GPU finished the copy.
+		virtual bool IsReady() = 0;
+		// Blocks until the copy finished.
+		virtual const ReadbackData& Wait() = 0;
+		// Null data until IsReady or Wait succeeded.
+		virtual const ReadbackData& GetData() const = 0;
+	};
+
+	struct UploadStats
+	{
+		uint64_t bytes = 0;
+		uint32_t uploads = 0;
+		// Copy calls issued, uploads into adjacent ranges share one.
+		uint32_t copies = 0;
+		// Times the staging ring was full and had to wait for the GPU.
+		uint32_t stalls = 0;
+	};
+
+	// Streams data into GPU resources. Small buffer uploads are packed into a persistent staging ring and issued as
+	// few large copies on Flush, staging memory is reused once the GPU consumed it. Records on the immediate command
+	// list, use it from the thread that owns it.
+	class UploadContext : public PrismObject
+	{
+	public:
+		virtual void UploadBuffer(Buffer* dst, uint32_t dstOffset, const void* data, uint32_t size) = 0;
+		// Uploads 'region' of a subresource, or all of it, reading rows 'rowPitch' and slices 'slicePitch' bytes apart.
+		virtual void UploadTexture(Resource* dst, uint32_t subresource, const SubresourceData& data, const Box* region = nullptr) = 0;
+		// Issues every pending copy.
+		virtual void Flush() = 0;
+		// Flushes and closes the accounting frame, returns its statistics.
+		virtual UploadStats EndFrame() = 0;
+		virtual const UploadStats& GetFrameStats() const = 0;
+		virtual const UploadStats& GetTotalStats() const = 0;
+	};
+
 	enum class QueryGetDataFlags
 	{
 		None,
 		DoNotFlush = 1,
 	};
 
+	enum class CopyFlags : uint32_t
+	{
+		None = 0,
+		// The caller guarantees the GPU does not use the destination range, the driver need not synchronize.
+		NoOverwrite = 1,
+		// The rest of the destination subresource may be discarded.
+		Discard = 2,
+	};
+
+	enum class MultiDrawFlags : uint32_t
+	{
+		None = 0,
+		// Backends without count buffer draws read the count back on the CPU instead of issuing 'maxCount' draws.
+		// This waits for the GPU to produce the count and is only available on immediate command lists.
+		ReadCountOnCpu = 1,
+	};
+
+	// Structure of arrays description of 'count' draws. Every array holds one entry per draw, optional arrays may be
+	// null: null state arrays keep the state bound before the batch, null argument arrays use the defaults noted.
+	// A draw with a null index buffer, or every draw if 'indexBuffers' is null, is issued non-indexed.
+	struct DrawBatch
+	{
+		uint32_t count = 0;
+
+		GraphicsPipelineState* const* pipelineStates = nullptr;
+		BindingGroup* const* bindingGroups = nullptr;
+		uint32_t bindingGroupIndex = 0;
+
+		Buffer* const* vertexBuffers = nullptr;
+		const uint32_t* vertexStrides = nullptr;
+		const uint32_t* vertexOffsets = nullptr;
+		Buffer* const* indexBuffers = nullptr;
+		Format indexFormat = Format::R32UInt;
+
+		// Index count for indexed draws, vertex count otherwise. Required.
+		const uint32_t* counts = nullptr;
+		// Defaults to 1.
+		const uint32_t* instanceCounts = nullptr;
+		// First index for indexed draws, first vertex otherwise. Defaults to 0.
+		const uint32_t* firstElements = nullptr;
+		// Defaults to 0, ignored by non-indexed draws.
+		const int32_t* baseVertices = nullptr;
+		// Defaults to 0.
+		const uint32_t* firstInstances = nullptr;
+	};
+
+	struct CommandPacket;
+	class CommandStream;
+
+	// A command stream translated into backend commands once, with native objects, strides and offsets resolved at
+	// creation. It holds one command per packet of the stream and reads push constant data from the packets, so the
+	// stream must stay recorded while the bundle is used.
+	class NativeCommandBundle : public PrismObject
+	{
+	public:
+		// Re-translates the packet at position 'index' of the stream after it was patched in place.
+		virtual void Update(uint32_t index, const CommandPacket* packet) = 0;
+	};
+
 	class CommandList : public DeviceChild
 	{
 	public:
@@ -702,6 +813,8 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		virtual void End() = 0;
 		virtual void SetGraphicsPipelineState(GraphicsPipelineState* state) = 0;
 		virtual void SetComputePipelineState(ComputePipelineState* state) = 0;
+		virtual void SetBindingSet(BindingSet* bindingSet) = 0;
+		virtual void SetBindingGroup(uint32_t index, BindingGroup* group) = 0;
 		virtual void SetVertexBuffer(uint32_t slot, Buffer* buffer, uint32_t stride, uint32_t offset) = 0;
 		virtual void SetIndexBuffer(Buffer* buffer, Format format, uint32_t offset) = 0;
 		virtual void SetRenderTarget(RenderTargetView* rtv, DepthStencilView* dsv) = 0;
@@ -714,15 +827,45 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		virtual void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, int32_t vertexOffset, uint32_t instanceOffset) = 0;
 		virtual void DrawIndexedInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs) = 0;
 		virtual void DrawInstancedIndirect(Buffer* bufferForArgs, uint32_t alignedByteOffsetForArgs) = 0;
+		// Issues up to 'maxCount' indirect draws whose records lie 'stride' bytes apart, starting at 'argsOffset'. With a
+		// count buffer the number of draws is the uint32 at 'countOffset' clamped to 'maxCount'. Backends without
+		// native multi draw loop over the records. Without count buffer draws they issue all 'maxCount' records and
+		// never wait for the GPU, so records past the count must hold a zero instance count, as GPU culling writes
+		// them. MultiDrawFlags::ReadCountOnCpu opts into reading the count back instead.
+		virtual void MultiDrawIndexedIndirect(Buffer* argsBuffer, uint32_t maxCount, uint32_t stride, Buffer* countBuffer = nullptr, uint32_t argsOffset = 0, uint32_t countOffset = 0, MultiDrawFlags flags = MultiDrawFlags::None) = 0;
+		virtual void MultiDrawIndirect(Buffer* argsBuffer, uint32_t maxCount, uint32_t stride, Buffer* countBuffer = nullptr, uint32_t argsOffset = 0, uint32_t countOffset = 0, MultiDrawFlags flags = MultiDrawFlags::None) = 0;
+		// Issues a whole batch in one call, state shared between consecutive draws is submitted once.
+		virtual void SubmitDraws(const DrawBatch& batch) = 0;
 		virtual void Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) = 0;
 		virtual void DispatchIndirect(Buffer* dispatchArgs, uint32_t offset) = 0;
 		virtual void ExecuteCommandList(CommandList* commandList) = 0;
+		// Runs the commands of a bundle created by the same device, with the same effect as replaying its stream.
+		virtual void ExecuteBundle(NativeCommandBundle* bundle) = 0;
 		virtual void ClearRenderTargetView(RenderTargetView* rtv, const Color& color) = 0;
 		virtual void ClearDepthStencilView(DepthStencilView* dsv, DepthStencilViewClearFlags flags, float depth, char stencil) = 0;
 		virtual void ClearUnorderedAccessViewUint(UnorderedAccessView* uav, uint32_t r, uint32_t g, uint32_t b, uint32_t a) = 0;
 		virtual void ClearView(ResourceView* view, const Color& color, const Rect& rect) = 0;
 		virtual void CopyResource(Resource* dstResource, Resource* srcResource) = 0;
+		// Copies 'srcBox' of a source subresource, or all of it, to x, y, z of a destination subresource.
+		virtual void CopySubresourceRegion(Resource* dstResource, uint32_t dstSubresource, uint32_t dstX, uint32_t dstY, uint32_t dstZ, Resource* srcResource, uint32_t srcSubresource, const Box* srcBox = nullptr, CopyFlags flags = CopyFlags::None) = 0;
+		// Writes CPU data into 'dstBox' of a subresource, or all of it. Rows are 'rowPitch', slices 'depthPitch' bytes apart.
+		virtual void UpdateSubresource(Resource* dstResource, uint32_t dstSubresource, const Box* dstBox, const void* data, uint32_t rowPitch, uint32_t depthPitch, CopyFlags flags = CopyFlags::None) = 0;
+
+		void CopyBufferRegion(Buffer* dstBuffer, uint32_t dstOffset, Buffer* srcBuffer, uint32_t srcOffset, uint32_t size, CopyFlags flags = CopyFlags::None)
+		{
+			const Box box = { srcOffset, 0, 0, srcOffset + size, 1, 1 };
+			CopySubresourceRegion(dstBuffer, 0, dstOffset, 0, 0, srcBuffer, 0, &box, flags);
+		}
+
+		void UpdateBuffer(Buffer* dstBuffer, uint32_t dstOffset, const void* data, uint32_t size, CopyFlags flags = CopyFlags::None)
+		{
+			const Box box = { dstOffset, 0, 0, dstOffset + size, 1, 1 };
+			UpdateSubresource(dstBuffer, 0, &box, data, 0, 0, flags);
+		}
 		virtual void GenerateMips(ShaderResourceView* srv) = 0;
+		// Unbinds the shader resources of every stage and the compute unordered access views, including those set by
+		// binding sets and groups. Pipeline states stay set, the next draw or dispatch binds their resources again.
+		virtual void UnbindShaderResources() = 0;
 		virtual void ClearState() = 0;
 		virtual void Flush() = 0;
 		virtual MappedSubresource Map(Resource* resource, uint32_t subresource, MapType mapType, MapFlags mapFlags) = 0;
@@ -731,9 +874,35 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		virtual void EndQuery(Query* query) = 0;
 		virtual bool QueryGetData(Query* query, void* data, uint32_t size, QueryGetDataFlags flags = QueryGetDataFlags::None) = 0;
 
+		// Sets 'fence' to 'value' once the GPU finished all work submitted before. Immediate command lists only.
+		virtual void Signal(Fence* fence, uint64_t value) = 0;
+
 		virtual void BeginEvent(const char* name) = 0;
 		virtual void EndEvent() = 0;
 
+		// Counts of the state calls that reached the backend and of those dropped because nothing changed.
+		virtual StateCacheStats GetStateCacheStats() const = 0;
+		virtual void ResetStateCacheStats() = 0;
+
+		// Copies 'data' into the command list's constant ring. On a deferred list the returned range stays valid until
+		// the next Begin, every write gets its own memory. The immediate list never begins and reuses the memory, bind
+		// its ranges before the next write.
+		virtual TransientConstants WriteConstants(const void* data, uint32_t size) = 0;
+
+		// Shaders receive push constants through a cbuffer with this name, binding lists never bind it themselves.
+		static constexpr const char* PushConstantsName = "PushConstants";
+		static constexpr uint32_t MaxPushConstantsSize = 256;
+
+		// Updates part of the push constant block, the stages listed see the new contents from the next draw or dispatch.
+		virtual void SetPushConstants(ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data) = 0;
+
+		template<typename T>
+		TransientConstants WriteConstants(const T& data)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Constants must be trivially copyable");
+			return WriteConstants(&data, sizeof(T));
+		}
+
 		template<typename T>
 		void Write(Resource* resource, const T& data, uint32_t offset = 0)
 		{
@@ -756,16 +925,20 @@ HEXA_PRISM_NAMESPACE_BEGIN
 	public:
 		static PrismObj<GraphicsDevice> Create();
 		virtual CommandList* GetImmediateCommandList() = 0;
+		virtual GlobalResourceList& GetGlobalResourceList() = 0;
 		virtual PrismObj<Buffer> CreateBuffer(const BufferDesc& desc, const SubresourceData* initialData = nullptr) = 0;
-		virtual PrismObj<Texture1D> CreateTexture1D(const Texture1DDesc& desc) = 0;
-		virtual PrismObj<Texture2D> CreateTexture2D(const Texture2DDesc& desc) = 0;
-		virtual PrismObj<Texture3D> CreateTexture3D(const Texture3DDesc& desc) = 0;
+		// 'initialData' holds one entry per subresource, mip levels of the first slice first, then the next slice.
+		virtual PrismObj<Texture1D> CreateTexture1D(const Texture1DDesc& desc, const SubresourceData* initialData = nullptr) = 0;
+		virtual PrismObj<Texture2D> CreateTexture2D(const Texture2DDesc& desc, const SubresourceData* initialData = nullptr) = 0;
+		virtual PrismObj<Texture3D> CreateTexture3D(const Texture3DDesc& desc, const SubresourceData* initialData = nullptr) = 0;
 		virtual PrismObj<RenderTargetView> CreateRenderTargetView(Resource* resource, const RenderTargetViewDesc& desc) = 0;
 		virtual PrismObj<ShaderResourceView> CreateShaderResourceView(Resource* resource, const ShaderResourceViewDesc& desc) = 0;
 		virtual PrismObj<DepthStencilView> CreateDepthStencilView(Resource* resource, const DepthStencilViewDesc& desc) = 0;
 		virtual PrismObj<UnorderedAccessView> CreateUnorderedAccessView(Resource* resource, const UnorderedAccessViewDesc& desc) = 0;
 		virtual PrismObj<SamplerState> CreateSamplerState(const SamplerDesc& desc) = 0;
 		virtual PrismObj<CommandList> CreateCommandList() = 0;
+		virtual PrismObj<BindingSet> CreateBindingSet() = 0;
+		virtual PrismObj<BindingGroup> CreateBindingGroup(const BindingGroupDesc& desc) = 0;
 		virtual PrismObj<GraphicsPipeline> CreateGraphicsPipeline(const GraphicsPipelineDesc& desc) = 0;
 		virtual PrismObj<GraphicsPipelineState> CreateGraphicsPipelineState(GraphicsPipeline* pipeline, const GraphicsPipelineStateDesc& desc) = 0;
 		virtual PrismObj<ComputePipeline> CreateComputePipeline(const ComputePipelineDesc& desc) = 0;
@@ -773,6 +946,13 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		virtual PrismObj<SwapChain> CreateSwapChain(void* windowHandle, const SwapChainDesc& desc, const SwapChainFullscreenDesc& fullscreenDesc) = 0;
 		virtual PrismObj<SwapChain> CreateSwapChain(void* windowHandle) = 0;
 		virtual PrismObj<Query> CreateQuery(const QueryDesc& desc) = 0;
+		virtual PrismObj<Fence> CreateFence(uint64_t initialValue = 0) = 0;
+		virtual PrismObj<NativeCommandBundle> CreateNativeBundle(const CommandStream& stream) = 0;
+		// 'chunkCount' staging chunks of 'chunkSize' bytes each are used round robin, a chunk is reused once the GPU
+		// copied out of it. Buffer uploads larger than a chunk bypass the chunks.
+		virtual PrismObj<UploadContext> CreateUploadContext(uint32_t chunkSize = 4u << 20, uint32_t chunkCount = 4) = 0;
+		// Copies 'region' of a subresource, or all of it, into a pooled staging resource on the immediate command list.
+		virtual PrismObj<Readback> ReadbackAsync(Resource* resource, uint32_t subresource = 0, const Box* region = nullptr) = 0;
 	};
 
 HEXA_PRISM_NAMESPACE_END
@@ -1,5 +1,7 @@
 #pragma once
 #include "common.hpp"
+#include "prism_object.hpp"
+#include <cstring>
 
 
 #ifndef HEXA_MATH_VECTOR_HPP
@@ -8,25 +10,25 @@
 namespace HEXA_MATH_NAMESPACE
 {
 #define BINARY_OP_VEC2(op) \
-	constexpr Vector2 operator##op(const Vector2& b) const { return { x##op b.x, y##op b.y }; } \
-	constexpr Vector2& operator##op##=(const Vector2& b) { x##op##= b.x; y##op##= b.y; return *this; }
+	constexpr Vector2 operator op(const Vector2& b) const { return { x op b.x, y op b.y }; } \
+	constexpr Vector2& operator op##=(const Vector2& b) { x op##= b.x; y op##= b.y; return *this; }
 
 #define BINARY_OP_VEC3(op) \
-	constexpr Vector3 operator##op(const Vector3& b) const { return { x##op b.x, y##op b.y, z##op b.z }; } \
-	constexpr Vector3& operator##op##=(const Vector3& b) { x##op##= b.x; y##op##= b.y; z##op##= b.z; return *this; }
+	constexpr Vector3 operator op(const Vector3& b) const { return { x op b.x, y op b.y, z op b.z }; } \
+	constexpr Vector3& operator op##=(const Vector3& b) { x op##= b.x; y op##= b.y; z op##= b.z; return *this; }
 
 #define BINARY_OP_VEC4(op) \
-	constexpr Vector4 operator##op(const Vector4& b) const { return { x##op b.x, y##op b.y, z##op b.z, w##op b.w }; } \
-	constexpr Vector4& operator##op##=(const Vector4& b) { x##op##= b.x; y##op##= b.y; z##op##= b.z; w##op##= b.w; return *this; }
+	constexpr Vector4 operator op(const Vector4& b) const { return { x op b.x, y op b.y, z op b.z, w op b.w }; } \
+	constexpr Vector4& operator op##=(const Vector4& b) { x op##= b.x; y op##= b.y; z op##= b.z; w op##= b.w; return *this; }
 
 #define UNARY_OP_VEC2(op) \
-	constexpr Vector2 operator##op() const { return { op x, op y }; }
+	constexpr Vector2 operator op() const { return { op x, op y }; }
 
 #define UNARY_OP_VEC3(op) \
-	constexpr Vector3 operator##op() const { return { op x, op y, op z }; }
+	constexpr Vector3 operator op() const { return { op x, op y, op z }; }
 
 #define UNARY_OP_VEC4(op) \
-	constexpr Vector4 operator##op() const { return { op x, op y, op z, op w }; }
+	constexpr Vector4 operator op() const { return { op x, op y, op z, op w }; }
 
 	struct Vector2
 	{
@@ -114,31 +116,6 @@ namespace HEXA_MATH_NAMESPACE
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
-class PrismObject
-{
-	std::atomic<size_t> counter;
-
-public:
-	PrismObject() : counter(1)
-	{
-	}
-
-	void AddRef()
-	{
-		counter.fetch_add(1, std::memory_order_acq_rel);
-	}
-
-	void Release()
-	{
-		if (counter.fetch_sub(1, std::memory_order_acq_rel) == 1)
-		{
-			delete this; // TODO: Change to custom allocator solution.
-		}
-	}
-
-	virtual ~PrismObject() = default;
-};
-
 template <typename T>
 class PrismObj
 {
@@ -1008,7 +985,7 @@ public:
 		}
 	}
 
-	String(const String& other)
+	String(const String& other) : container<char>()
 	{
 		if (other.ptr && other.size_m > 0)
 		{
@@ -1060,10 +1037,4 @@ public:
 	}
 };
 
-class DeviceChild : public PrismObject
-{
-public:
-	virtual void* GetNativePointer() = 0;
-};
-
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
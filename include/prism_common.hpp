@@ -1,5 +1,6 @@
 #pragma once
 #include "prism_base.hpp"
+#include "shader_types.hpp"
 
 HEXA_PRISM_NAMESPACE_BEGIN
 	class Buffer;
@@ -219,24 +220,6 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		TextureCube = 1 << 0,
 	};
 
-	enum class ShaderStage : uint8_t
-	{
-		Vertex,
-		Hull,
-		Domain,
-		Geometry,
-		Pixel,
-		Compute,
-	};
-
-	enum class ShaderParameterType : uint8_t
-	{
-		SRV,
-		UAV,
-		CBV,
-		Sampler,
-	};
-
 	enum class Blend : uint8_t
 	{
 		Zero = 1,
@@ -471,6 +454,7 @@ HEXA_PRISM_NAMESPACE_BEGIN
 	{
 		None = 0,
 		ReflectVariables = 1 << 0,
+		UnbindOnSwitch = 1 << 1,
 	};
 
 
@@ -509,6 +493,12 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		int32_t left, top, right, bottom;
 	};
 
+	// Texel region of a subresource, right, bottom and back are exclusive. Buffers use left and right as byte range.
+	struct Box
+	{
+		uint32_t left, top, front, right, bottom, back;
+	};
+
 	class ShaderSource : public PrismObject
 	{
 	public:
@@ -585,6 +575,8 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		void* value;
 	};
 
+	// Resources owned by a pipeline state. Setting them must not overlap recording that uses the state, recording only
+	// reads the list, so command lists on different threads may share a state. Per command list changes go through a BindingSet.
 	class ResourceBindingList
 	{
 	public:
@@ -613,6 +605,74 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		virtual iterator_pair GetSamplers() = 0;
 	};
 
+	// Named bindings shared by every pipeline, e.g. per frame constants, shadow maps and samplers.
+	// A global value is applied to all binding lists declaring the name unless a list overrides it locally.
+	class GlobalResourceList
+	{
+	public:
+		virtual ~GlobalResourceList() = default;
+
+		virtual void SetCBV(const char* name, Buffer* buffer) = 0;
+		virtual void SetSampler(const char* name, SamplerState* sampler) = 0;
+		virtual void SetSRV(const char* name, ShaderResourceView* view) = 0;
+		virtual void SetUAV(const char* name, UnorderedAccessView* view,
+		                    uint32_t initialCount = static_cast<uint32_t>(-1)) = 0;
+	};
+
+	// Sub-range of a command list's constant ring, returned by CommandList::WriteConstants. Offsets are in 16 byte
+	// constants, a zero 'numConstants' binds the whole buffer.
+	struct TransientConstants
+	{
+		Buffer* buffer = nullptr;
+		uint32_t firstConstant = 0;
+		uint32_t numConstants = 0;
+	};
+
+	// Binding overrides recorded per command list. At bind time a value set here takes precedence over the
+	// pipeline state's own bindings for the same name, which keeps pipeline states immutable while recording,
+	// so one state can be shared by command lists recording on different threads. Setting null removes the override.
+	class BindingSet : public PrismObject
+	{
+	public:
+		virtual void SetCBV(const char* name, Buffer* buffer) = 0;
+		virtual void SetCBV(const char* name, const TransientConstants& constants) = 0;
+		virtual void SetSampler(const char* name, SamplerState* sampler) = 0;
+		virtual void SetSRV(const char* name, ShaderResourceView* view) = 0;
+		virtual void SetUAV(const char* name, UnorderedAccessView* view,
+		                    uint32_t initialCount = static_cast<uint32_t>(-1)) = 0;
+
+		virtual void Clear() = 0;
+	};
+
+	struct BindingGroupEntry
+	{
+		std::string name;
+		ShaderParameterType type;
+		ShaderStageFlags stages;
+		uint32_t slot;
+	};
+
+	struct BindingGroupDesc
+	{
+		const BindingGroupEntry* entries = nullptr;
+		uint32_t numEntries = 0;
+	};
+
+	// Resources laid out once against a declared slot layout, e.g. the per view camera buffer, shadow maps and samplers.
+	// A group attached to a command list is bound with its prebuilt slot ranges and owns those slots for every pipeline
+	// state drawn with it, pipeline states must declare a group name at the group's slot or leave the slot unused.
+	class BindingGroup : public PrismObject
+	{
+	public:
+		static constexpr uint32_t MaxAttachedGroups = 4;
+
+		virtual void SetCBV(const char* name, Buffer* buffer) = 0;
+		virtual void SetSampler(const char* name, SamplerState* sampler) = 0;
+		virtual void SetSRV(const char* name, ShaderResourceView* view) = 0;
+		virtual void SetUAV(const char* name, UnorderedAccessView* view,
+		                    uint32_t initialCount = static_cast<uint32_t>(-1)) = 0;
+	};
+
 	class PipelineState : public PrismObject
 	{
 	public:
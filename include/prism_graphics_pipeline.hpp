@@ -79,7 +79,7 @@ public:
 		alphaToCoverageEnable = false;
 		independentBlendEnable = false;
 
-		for (int i = 0; i < SimultaneousRenderTargetCount; i++)
+		for (size_t i = 0; i < SimultaneousRenderTargetCount; i++)
 		{
 			renderTargets[i].sourceBlend = sourceBlend;
 			renderTargets[i].destinationBlend = destinationBlend;
@@ -400,12 +400,12 @@ struct GraphicsPipelineStateDesc
 		: rasterizer(rasterizer),
 		depthStencil(depthStencil),
 		blend(blend),
-		primitiveTopology(primitiveTopology),
 		blendFactor(blendFactor),
 		sampleMask(sampleMask),
 		stencilRef(stencilRef),
 		inputElements(inputElements),
 		numInputElements(numInputElements),
+		primitiveTopology(primitiveTopology),
 		flags(flags)
 	{
 	}
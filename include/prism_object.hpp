@@ -0,0 +1,37 @@
+#pragma once
+#include "common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+class PrismObject
+{
+	std::atomic<size_t> counter;
+
+public:
+	PrismObject() : counter(1)
+	{
+	}
+
+	void AddRef()
+	{
+		counter.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	void Release()
+	{
+		if (counter.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete this; // TODO: Change to custom allocator solution.
+		}
+	}
+
+	virtual ~PrismObject() = default;
+};
+
+class DeviceChild : public PrismObject
+{
+public:
+	virtual void* GetNativePointer() = 0;
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,18 @@
+#pragma once
+#include "common.hpp"
+#include <span>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct SortItem
+{
+	uint64_t key;
+	uint32_t index;
+};
+
+// Stable LSD radix sort over 8 bit digits. Digits every key agrees on are skipped, so keys that only use a few
+// fields sort in a few passes. With more than one thread each pass is split into per thread slices that build
+// their histograms and scatter in parallel. 'scratch' must be at least as large as 'items'.
+void RadixSort(std::span<SortItem> items, std::span<SortItem> scratch, uint32_t threadCount = 1);
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,174 @@
+#pragma once
+#include "prism.hpp"
+#include "radix_sort.hpp"
+#include "upload_ring.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// 64 bit draw sort key, most significant field first: pass, pipeline state, binding group, depth, mesh. Sorting by
+// the key groups draws by pass and then by state, so consecutive draws share as much state as possible.
+struct SortKey
+{
+	static constexpr uint32_t PassBits = 6;
+	static constexpr uint32_t PipelineStateBits = 14;
+	static constexpr uint32_t BindingGroupBits = 14;
+	static constexpr uint32_t DepthBits = 16;
+	static constexpr uint32_t MeshBits = 14;
+
+	static constexpr uint32_t MeshShift = 0;
+	static constexpr uint32_t DepthShift = MeshShift + MeshBits;
+	static constexpr uint32_t BindingGroupShift = DepthShift + DepthBits;
+	static constexpr uint32_t PipelineStateShift = BindingGroupShift + BindingGroupBits;
+	static constexpr uint32_t PassShift = PipelineStateShift + PipelineStateBits;
+
+	static_assert(PassShift + PassBits == 64, "Sort key fields must fill 64 bits");
+
+	// Ids are truncated to their field width. 'depth' is quantized by the caller, invert it for back to front order.
+	static constexpr uint64_t Make(uint32_t pass, uint32_t pipelineState, uint32_t bindingGroup, uint32_t depth, uint32_t mesh)
+	{
+		return (Field(pass, PassBits) << PassShift)
+			| (Field(pipelineState, PipelineStateBits) << PipelineStateShift)
+			| (Field(bindingGroup, BindingGroupBits) << BindingGroupShift)
+			| (Field(depth, DepthBits) << DepthShift)
+			| (Field(mesh, MeshBits) << MeshShift);
+	}
+
+	// Maps a view space depth in [0, 1] to the depth field.
+	static constexpr uint32_t QuantizeDepth(float depth)
+	{
+		const float clamped = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+		return static_cast<uint32_t>(clamped * static_cast<float>((1u << DepthBits) - 1));
+	}
+
+private:
+	static constexpr uint64_t Field(uint32_t value, uint32_t bits)
+	{
+		return static_cast<uint64_t>(value) & ((uint64_t(1) << bits) - 1);
+	}
+};
+
+struct DrawPacket
+{
+	GraphicsPipelineState* pipelineState = nullptr;
+	BindingGroup* bindingGroup = nullptr;
+	uint32_t bindingGroupIndex = 0;
+	BindingSet* bindingSet = nullptr;
+	Buffer* vertexBuffer = nullptr;
+	uint32_t vertexStride = 0;
+	uint32_t vertexOffset = 0;
+	Buffer* indexBuffer = nullptr;
+	Format indexFormat = Format::R32UInt;
+	uint32_t indexBufferOffset = 0;
+	// Index count and first index for indexed draws, vertex count and first vertex otherwise.
+	uint32_t count = 0;
+	uint32_t instanceCount = 1;
+	uint32_t startIndex = 0;
+	int32_t baseVertex = 0;
+	uint32_t startInstance = 0;
+};
+
+struct RenderQueueStats
+{
+	// Draw calls reaching the command list, merged draws count once.
+	uint32_t draws = 0;
+	// Submitted draws folded into the instance count of a preceding draw.
+	uint32_t mergedDraws = 0;
+	uint32_t pipelineStateChanges = 0;
+	uint32_t bindingChanges = 0;
+	uint32_t bufferChanges = 0;
+};
+
+// Streams the per instance data of queued draws into a dynamic vertex buffer, bound as a per instance vertex stream
+// in 'slot'. The buffer needs CPU write access and is sub-allocated like the constant ring: no-overwrite while there
+// is room, discard once it wraps.
+class InstanceStream
+{
+	Buffer* buffer;
+	uint32_t slot;
+	UploadRing ring;
+	bool mapped = false;
+
+public:
+	static constexpr uint32_t OffsetAlignment = 16;
+
+	InstanceStream(Buffer* buffer, uint32_t slot);
+
+	Buffer* GetBuffer() const noexcept { return buffer; }
+	uint32_t GetSlot() const noexcept { return slot; }
+	uint32_t GetCapacity() const noexcept { return ring.GetCapacity(); }
+
+	// Returns the mapped memory for 'size' bytes and their offset in the buffer, Unmap before drawing.
+	uint8_t* Map(CommandList* commandList, uint32_t size, uint32_t& offset);
+	void Unmap(CommandList* commandList);
+
+	// The next map discards, call whenever the previous contents of the buffer are unknown.
+	void Reset() noexcept { ring.Reset(); }
+};
+
+// Collects draws tagged with a SortKey, sorts them and emits them in key order. State shared with the previous
+// draw is not resubmitted, so the cost of a draw is whatever actually differs from its predecessor.
+class RenderQueue
+{
+	struct InstanceDataRange
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	std::vector<DrawPacket> packets;
+	std::vector<InstanceDataRange> instanceRanges;
+	std::vector<uint8_t> instanceData;
+	std::vector<SortItem> items;
+	std::vector<SortItem> scratch;
+	InstanceStream* instanceStream = nullptr;
+	RenderQueueStats stats;
+
+	size_t FindRunEnd(size_t begin) const noexcept;
+
+public:
+	// Sorting is split across threads only above this many draws per thread.
+	static constexpr uint32_t MinItemsPerThread = 16384;
+
+	size_t GetSize() const noexcept { return packets.size(); }
+	const RenderQueueStats& GetStats() const noexcept { return stats; }
+
+	void Submit(uint64_t key, const DrawPacket& packet)
+	{
+		items.push_back({ key, static_cast<uint32_t>(packets.size()) });
+		packets.push_back(packet);
+		instanceRanges.push_back({ 0, 0 });
+	}
+
+	// Submits a draw with per object data, copied into the queue. Consecutive draws in key order that share all
+	// state and draw arguments, have an instance count of one and data of the same size are merged into a single
+	// instanced draw, their data is gathered into the instance stream with a stride of 'size'. A draw that is not
+	// merged and has more than one instance binds its data with a stride of zero, every instance reads the same data.
+	// The stream is read from the first instance, leave 'startInstance' at zero for such draws.
+	void Submit(uint64_t key, const DrawPacket& packet, const void* data, uint32_t size)
+	{
+		items.push_back({ key, static_cast<uint32_t>(packets.size()) });
+		packets.push_back(packet);
+		instanceRanges.push_back({ static_cast<uint32_t>(instanceData.size()), size });
+		instanceData.insert(instanceData.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+	}
+
+	// Required before executing draws with per object data. The stream is reset at the start of every Execute.
+	void SetInstanceStream(InstanceStream* stream) noexcept { instanceStream = stream; }
+
+	// Zero picks the hardware concurrency.
+	void Sort(uint32_t threadCount = 0);
+
+	// Issues the draws in their current order. Call Sort first, otherwise the submission order is kept.
+	void Execute(CommandList* commandList);
+
+	// Keeps the capacity, a queue reused every frame stops allocating once it reached its peak size.
+	void Clear() noexcept
+	{
+		packets.clear();
+		instanceRanges.clear();
+		instanceData.clear();
+		items.clear();
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
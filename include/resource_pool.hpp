@@ -0,0 +1,101 @@
+#pragma once
+#include "prism.hpp"
+#include <memory>
+#include <unordered_map>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+// A pooled texture with a view over the whole resource for every access flag of its desc: render target for Write,
+// shader resource for Read, unordered access for UA and depth stencil for DepthStencil. Depth formats that are also
+// read are created typeless, the depth stencil view uses the depth format and the shader resource view the matching
+// color format.
+struct PooledTexture
+{
+	PrismObj<Texture2D> texture;
+	PrismObj<RenderTargetView> rtv;
+	PrismObj<ShaderResourceView> srv;
+	PrismObj<UnorderedAccessView> uav;
+	PrismObj<DepthStencilView> dsv;
+};
+
+struct PooledBuffer
+{
+	PrismObj<Buffer> buffer;
+};
+
+struct ResourcePoolStats
+{
+	uint32_t created = 0;
+	uint32_t reused = 0;
+	uint32_t evicted = 0;
+};
+
+// Recycles transient textures and buffers between frames. Released resources go to a free list keyed by a hash of
+// their desc and are handed out again for an equal desc, resources left unused for 'evictAfterFrames' frames are
+// destroyed. Once every desc a frame asks for has been seen, acquiring creates nothing and allocates nothing.
+// Resources may be released and reacquired within a frame, the backend orders the accesses. Not thread safe.
+class TransientResourcePool
+{
+	struct TextureEntry : PooledTexture
+	{
+		Texture2DDesc desc;
+		size_t hash;
+		uint64_t lastUsedFrame;
+		bool acquired;
+	};
+
+	struct BufferEntry : PooledBuffer
+	{
+		BufferDesc desc;
+		size_t hash;
+		uint64_t lastUsedFrame;
+		bool acquired;
+	};
+
+	GraphicsDevice* device;
+	uint32_t evictAfterFrames;
+	uint64_t frame = 0;
+
+	std::vector<std::unique_ptr<TextureEntry>> textures;
+	std::vector<std::unique_ptr<BufferEntry>> buffers;
+	std::unordered_map<size_t, std::vector<TextureEntry*>> freeTextures;
+	std::unordered_map<size_t, std::vector<BufferEntry*>> freeBuffers;
+
+	ResourcePoolStats frameStats;
+	ResourcePoolStats totalStats;
+
+	void CreateViews(TextureEntry& entry);
+	void Evict(uint64_t maxAge);
+
+public:
+	TransientResourcePool(GraphicsDevice* device, uint32_t evictAfterFrames = 3);
+
+	TransientResourcePool(const TransientResourcePool&) = delete;
+	TransientResourcePool& operator=(const TransientResourcePool&) = delete;
+
+	static size_t Hash(const Texture2DDesc& desc) noexcept;
+	static size_t Hash(const BufferDesc& desc) noexcept;
+	static bool Equals(const Texture2DDesc& a, const Texture2DDesc& b) noexcept;
+	static bool Equals(const BufferDesc& a, const BufferDesc& b) noexcept;
+
+	// The pointer stays valid until the resource is released. Throws if the resource could not be created.
+	PooledTexture* AcquireTexture(const Texture2DDesc& desc);
+	PooledBuffer* AcquireBuffer(const BufferDesc& desc);
+
+	void Release(PooledTexture* texture);
+	void Release(PooledBuffer* buffer);
+
+	// Evicts the resources that stayed in the free lists for 'evictAfterFrames' frames, closes the accounting frame
+	// and returns its statistics.
+	ResourcePoolStats EndFrame();
+
+	// Destroys every released resource, acquired ones are kept.
+	void Trim();
+
+	size_t GetTextureCount() const noexcept { return textures.size(); }
+	size_t GetBufferCount() const noexcept { return buffers.size(); }
+	const ResourcePoolStats& GetFrameStats() const noexcept { return frameStats; }
+	const ResourcePoolStats& GetTotalStats() const noexcept { return totalStats; }
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,36 @@
+#pragma once
+#include "common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+enum class ShaderStage : uint8_t
+{
+	Vertex,
+	Hull,
+	Domain,
+	Geometry,
+	Pixel,
+	Compute,
+};
+
+enum class ShaderStageFlags : uint8_t
+{
+	None = 0,
+	Vertex = 1 << 0,
+	Hull = 1 << 1,
+	Domain = 1 << 2,
+	Geometry = 1 << 3,
+	Pixel = 1 << 4,
+	Compute = 1 << 5,
+	AllGraphics = Vertex | Hull | Domain | Geometry | Pixel,
+};
+
+enum class ShaderParameterType : uint8_t
+{
+	SRV,
+	UAV,
+	CBV,
+	Sampler,
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,216 @@
+#pragma once
+#include "common.hpp"
+#include <bit>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct SlotRange
+{
+	uint32_t start;
+	uint32_t length;
+};
+
+// Fixed size bitmask over descriptor slots, sized for the 128 input resource slots of D3D11.
+// Contiguous runs of set bits are extracted with bit scans, so binding walks never touch empty slots.
+struct SlotMask
+{
+	static constexpr uint32_t WordBits = 64;
+	static constexpr uint32_t WordCount = 2;
+	static constexpr uint32_t MaxSlots = WordBits * WordCount;
+
+	uint64_t words[WordCount] = {};
+
+	constexpr void Set(const uint32_t slot)
+	{
+		words[slot / WordBits] |= uint64_t(1) << (slot % WordBits);
+	}
+
+	constexpr void Clear(const uint32_t slot)
+	{
+		words[slot / WordBits] &= ~(uint64_t(1) << (slot % WordBits));
+	}
+
+	constexpr void Assign(const uint32_t slot, const bool value)
+	{
+		if (value)
+		{
+			Set(slot);
+		}
+		else
+		{
+			Clear(slot);
+		}
+	}
+
+	constexpr bool Test(const uint32_t slot) const
+	{
+		return (words[slot / WordBits] >> (slot % WordBits)) & 1;
+	}
+
+	constexpr void SetRange(const uint32_t start, const uint32_t length)
+	{
+		for (uint32_t slot = start; slot < start + length;)
+		{
+			const uint32_t bit = slot % WordBits;
+			const uint32_t bits = std::min(WordBits - bit, start + length - slot);
+			const uint64_t mask = bits == WordBits ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1) << bit;
+			words[slot / WordBits] |= mask;
+			slot += bits;
+		}
+	}
+
+	constexpr void Reset()
+	{
+		for (auto& word : words)
+		{
+			word = 0;
+		}
+	}
+
+	constexpr bool Any() const
+	{
+		uint64_t result = 0;
+		for (const auto word : words)
+		{
+			result |= word;
+		}
+		return result != 0;
+	}
+
+	constexpr uint32_t Count() const
+	{
+		uint32_t result = 0;
+		for (const auto word : words)
+		{
+			result += static_cast<uint32_t>(std::popcount(word));
+		}
+		return result;
+	}
+
+	// Finds the first run of set bits starting at or after 'from'.
+	constexpr bool NextRange(uint32_t from, SlotRange& range) const
+	{
+		uint32_t slot = from;
+		while (slot < MaxSlots)
+		{
+			const uint64_t bits = words[slot / WordBits] >> (slot % WordBits);
+			if (bits != 0)
+			{
+				slot += static_cast<uint32_t>(std::countr_zero(bits));
+				break;
+			}
+			slot = (slot / WordBits + 1) * WordBits;
+		}
+
+		if (slot >= MaxSlots)
+		{
+			return false;
+		}
+
+		range.start = slot;
+		while (slot < MaxSlots)
+		{
+			const uint64_t bits = words[slot / WordBits] >> (slot % WordBits);
+			const auto ones = static_cast<uint32_t>(std::countr_one(bits));
+			slot += ones;
+			if (ones == 0 || slot % WordBits != 0)
+			{
+				break;
+			}
+		}
+
+		range.length = slot - range.start;
+		return true;
+	}
+
+	template<typename TCallback>
+	constexpr void ForEachRange(TCallback&& callback) const
+	{
+		SlotRange range{};
+		uint32_t from = 0;
+		while (NextRange(from, range))
+		{
+			callback(range);
+			from = range.start + range.length;
+		}
+	}
+
+	constexpr SlotMask& operator|=(const SlotMask& other)
+	{
+		for (uint32_t i = 0; i < WordCount; i++)
+		{
+			words[i] |= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr SlotMask& operator&=(const SlotMask& other)
+	{
+		for (uint32_t i = 0; i < WordCount; i++)
+		{
+			words[i] &= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr SlotMask operator|(const SlotMask& other) const { SlotMask result = *this; result |= other; return result; }
+	constexpr SlotMask operator&(const SlotMask& other) const { SlotMask result = *this; result &= other; return result; }
+
+	constexpr SlotMask operator<<(const uint32_t shift) const
+	{
+		SlotMask result;
+		const uint32_t wordShift = shift / WordBits;
+		const uint32_t bitShift = shift % WordBits;
+		for (uint32_t i = wordShift; i < WordCount; i++)
+		{
+			result.words[i] = words[i - wordShift] << bitShift;
+			if (bitShift != 0 && i > wordShift)
+			{
+				result.words[i] |= words[i - wordShift - 1] >> (WordBits - bitShift);
+			}
+		}
+		return result;
+	}
+
+	constexpr SlotMask operator>>(const uint32_t shift) const
+	{
+		SlotMask result;
+		const uint32_t wordShift = shift / WordBits;
+		const uint32_t bitShift = shift % WordBits;
+		for (uint32_t i = 0; i + wordShift < WordCount; i++)
+		{
+			result.words[i] = words[i + wordShift] >> bitShift;
+			if (bitShift != 0 && i + wordShift + 1 < WordCount)
+			{
+				result.words[i] |= words[i + wordShift + 1] << (WordBits - bitShift);
+			}
+		}
+		return result;
+	}
+
+	constexpr SlotMask operator~() const
+	{
+		SlotMask result;
+		for (uint32_t i = 0; i < WordCount; i++)
+		{
+			result.words[i] = ~words[i];
+		}
+		return result;
+	}
+
+	constexpr bool operator==(const SlotMask& other) const
+	{
+		for (uint32_t i = 0; i < WordCount; i++)
+		{
+			if (words[i] != other.words[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const SlotMask& other) const { return !(*this == other); }
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,263 @@
+#pragma once
+#include "prism_common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct StateCacheStats
+{
+	uint64_t issued = 0;
+	uint64_t filtered = 0;
+};
+
+enum class StateObject : uint32_t
+{
+	VertexShader,
+	HullShader,
+	DomainShader,
+	GeometryShader,
+	PixelShader,
+	ComputeShader,
+	InputLayout,
+	RasterizerState,
+	BlendState,
+	DepthStencilState,
+	Count,
+};
+
+// Shadow of the pipeline state last submitted on a command list. Every setter compares against the shadow and
+// returns whether the call has to reach the backend, dropped calls are counted. Objects are compared by address,
+// which is safe because the backend keeps bound objects alive until they are replaced or the cache is invalidated.
+class StateCache
+{
+public:
+	static constexpr uint32_t MaxVertexBuffers = 32;
+	static constexpr uint32_t MaxViewports = 16;
+	static constexpr uint32_t MaxRenderTargets = 8;
+
+private:
+	enum ValidBits : uint32_t
+	{
+		ValidIndexBuffer = 1u << static_cast<uint32_t>(StateObject::Count),
+		ValidTopology = ValidIndexBuffer << 1,
+		ValidViewports = ValidIndexBuffer << 2,
+		ValidScissorRects = ValidIndexBuffer << 3,
+		ValidRenderTargets = ValidIndexBuffer << 4,
+	};
+
+	struct VertexBufferState
+	{
+		const void* buffer;
+		uint32_t stride;
+		uint32_t offset;
+	};
+
+	uint32_t valid = 0;
+	uint32_t validVertexBuffers = 0;
+
+	const void* objects[static_cast<uint32_t>(StateObject::Count)] = {};
+	float blendFactor[4] = {};
+	uint32_t sampleMask = 0;
+	uint32_t stencilRef = 0;
+
+	VertexBufferState vertexBuffers[MaxVertexBuffers] = {};
+	const void* indexBuffer = nullptr;
+	uint32_t indexFormat = 0;
+	uint32_t indexOffset = 0;
+	uint32_t topology = 0;
+
+	uint32_t viewportCount = 0;
+	Viewport viewports[MaxViewports];
+	uint32_t scissorCount = 0;
+	Rect scissorRects[MaxViewports] = {};
+
+	uint32_t renderTargetCount = 0;
+	const void* renderTargets[MaxRenderTargets] = {};
+	const void* depthStencil = nullptr;
+
+	StateCacheStats stats;
+
+	bool Submit(bool unchanged)
+	{
+		if (unchanged)
+		{
+			stats.filtered++;
+			return false;
+		}
+
+		stats.issued++;
+		return true;
+	}
+
+	bool IsValid(uint32_t bit) const noexcept { return (valid & bit) != 0; }
+
+public:
+	const StateCacheStats& GetStats() const noexcept { return stats; }
+	void ResetStats() noexcept { stats = {}; }
+
+	// Forgets the shadow, the next call of every setter reaches the backend.
+	void Invalidate() noexcept
+	{
+		valid = 0;
+		validVertexBuffers = 0;
+	}
+
+	// For output merger changes that bypass SetRenderTargets.
+	void InvalidateRenderTargets() noexcept
+	{
+		valid &= ~static_cast<uint32_t>(ValidRenderTargets);
+	}
+
+	bool SetObject(StateObject object, const void* value)
+	{
+		const uint32_t index = static_cast<uint32_t>(object);
+		const uint32_t bit = 1u << index;
+		if (!Submit(IsValid(bit) && objects[index] == value))
+		{
+			return false;
+		}
+
+		objects[index] = value;
+		valid |= bit;
+		return true;
+	}
+
+	bool SetBlendState(const void* state, const float factor[4], uint32_t mask)
+	{
+		const uint32_t index = static_cast<uint32_t>(StateObject::BlendState);
+		const uint32_t bit = 1u << index;
+		if (!Submit(IsValid(bit) && objects[index] == state && sampleMask == mask && memcmp(blendFactor, factor, sizeof(blendFactor)) == 0))
+		{
+			return false;
+		}
+
+		objects[index] = state;
+		memcpy(blendFactor, factor, sizeof(blendFactor));
+		sampleMask = mask;
+		valid |= bit;
+		return true;
+	}
+
+	bool SetDepthStencilState(const void* state, uint32_t reference)
+	{
+		const uint32_t index = static_cast<uint32_t>(StateObject::DepthStencilState);
+		const uint32_t bit = 1u << index;
+		if (!Submit(IsValid(bit) && objects[index] == state && stencilRef == reference))
+		{
+			return false;
+		}
+
+		objects[index] = state;
+		stencilRef = reference;
+		valid |= bit;
+		return true;
+	}
+
+	// Slots beyond MaxVertexBuffers are never filtered.
+	bool SetVertexBuffer(uint32_t slot, const void* buffer, uint32_t stride, uint32_t offset)
+	{
+		if (slot >= MaxVertexBuffers)
+		{
+			return Submit(false);
+		}
+
+		auto& state = vertexBuffers[slot];
+		const uint32_t bit = 1u << slot;
+		if (!Submit((validVertexBuffers & bit) != 0 && state.buffer == buffer && state.stride == stride && state.offset == offset))
+		{
+			return false;
+		}
+
+		state = { buffer, stride, offset };
+		validVertexBuffers |= bit;
+		return true;
+	}
+
+	bool SetIndexBuffer(const void* buffer, uint32_t format, uint32_t offset)
+	{
+		if (!Submit(IsValid(ValidIndexBuffer) && indexBuffer == buffer && indexFormat == format && indexOffset == offset))
+		{
+			return false;
+		}
+
+		indexBuffer = buffer;
+		indexFormat = format;
+		indexOffset = offset;
+		valid |= ValidIndexBuffer;
+		return true;
+	}
+
+	bool SetTopology(uint32_t value)
+	{
+		if (!Submit(IsValid(ValidTopology) && topology == value))
+		{
+			return false;
+		}
+
+		topology = value;
+		valid |= ValidTopology;
+		return true;
+	}
+
+	bool SetViewports(uint32_t count, const Viewport* values)
+	{
+		if (count > MaxViewports)
+		{
+			valid &= ~static_cast<uint32_t>(ValidViewports);
+			return Submit(false);
+		}
+
+		if (!Submit(IsValid(ValidViewports) && viewportCount == count && memcmp(viewports, values, sizeof(Viewport) * count) == 0))
+		{
+			return false;
+		}
+
+		viewportCount = count;
+		memcpy(viewports, values, sizeof(Viewport) * count);
+		valid |= ValidViewports;
+		return true;
+	}
+
+	bool SetScissorRects(uint32_t count, const Rect* values)
+	{
+		if (count > MaxViewports)
+		{
+			valid &= ~static_cast<uint32_t>(ValidScissorRects);
+			return Submit(false);
+		}
+
+		if (!Submit(IsValid(ValidScissorRects) && scissorCount == count && memcmp(scissorRects, values, sizeof(Rect) * count) == 0))
+		{
+			return false;
+		}
+
+		scissorCount = count;
+		memcpy(scissorRects, values, sizeof(Rect) * count);
+		valid |= ValidScissorRects;
+		return true;
+	}
+
+	bool SetRenderTargets(uint32_t count, const void* const* views, const void* depthStencilView)
+	{
+		if (count > MaxRenderTargets)
+		{
+			InvalidateRenderTargets();
+			return Submit(false);
+		}
+
+		if (!Submit(IsValid(ValidRenderTargets) && renderTargetCount == count && depthStencil == depthStencilView && (count == 0 || memcmp(renderTargets, views, sizeof(void*) * count) == 0)))
+		{
+			return false;
+		}
+
+		renderTargetCount = count;
+		if (count != 0)
+		{
+			memcpy(renderTargets, views, sizeof(void*) * count);
+		}
+		depthStencil = depthStencilView;
+		valid |= ValidRenderTargets;
+		return true;
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
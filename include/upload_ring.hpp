@@ -0,0 +1,79 @@
+#pragma once
+#include "common.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+struct UploadRingAllocation
+{
+	uint32_t offset;
+	uint32_t size;
+	// The allocation restarted the ring, the backing memory has to be mapped with discard instead of no-overwrite.
+	bool discard;
+};
+
+// Backend independent sub-allocator over one large dynamic buffer. Allocations are appended behind each other, so
+// mapping with no-overwrite never touches memory the GPU may still read. Once the ring is full it wraps to the start
+// and requests a discard, which lets the driver rename the buffer instead of waiting for the GPU.
+class UploadRing
+{
+	uint32_t capacity;
+	uint32_t alignment;
+	uint32_t head = 0;
+	bool discardPending = true;
+	uint64_t allocationCount = 0;
+	uint64_t discardCount = 0;
+
+public:
+	UploadRing(uint32_t capacity, uint32_t alignment) : capacity(capacity), alignment(alignment)
+	{
+		if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		{
+			throw std::invalid_argument("Upload ring alignment must be a power of two");
+		}
+	}
+
+	uint32_t GetCapacity() const noexcept { return capacity; }
+	uint32_t GetAlignment() const noexcept { return alignment; }
+	uint32_t GetHead() const noexcept { return head; }
+	uint64_t GetAllocationCount() const noexcept { return allocationCount; }
+	uint64_t GetDiscardCount() const noexcept { return discardCount; }
+
+	// Sizes are rounded up to the alignment. Returns false if the request can never fit into the ring.
+	bool Allocate(uint32_t size, UploadRingAllocation& allocation)
+	{
+		const uint64_t alignedSize = (static_cast<uint64_t>(size) + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+		if (alignedSize == 0 || alignedSize > capacity)
+		{
+			return false;
+		}
+
+		uint64_t offset = (static_cast<uint64_t>(head) + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+		if (discardPending || offset + alignedSize > capacity)
+		{
+			offset = 0;
+			discardPending = false;
+			allocation.discard = true;
+			discardCount++;
+		}
+		else
+		{
+			allocation.discard = false;
+		}
+
+		allocation.offset = static_cast<uint32_t>(offset);
+		allocation.size = static_cast<uint32_t>(alignedSize);
+		head = static_cast<uint32_t>(offset + alignedSize);
+		allocationCount++;
+		return true;
+	}
+
+	// Forces the next allocation to discard, required whenever the previous contents of the buffer are unknown,
+	// e.g. the first map on a deferred context after it started recording.
+	void Reset() noexcept
+	{
+		head = 0;
+		discardPending = true;
+	}
+};
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,175 @@
+#include "command_bundle.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+CommandBundle::Param& CommandBundle::GetParam(BundleParam param, BundleParamType type)
+{
+	if (param.index >= params.size() || params[param.index].type != type)
+	{
+		throw std::invalid_argument("Bundle parameter does not exist or has a different type");
+	}
+	return params[param.index];
+}
+
+BundleParam CommandBundle::AddConstants(uint32_t size)
+{
+	if (size > CommandList::MaxPushConstantsSize)
+	{
+		throw std::runtime_error("Push constants exceed MaxPushConstantsSize.");
+	}
+
+	params.push_back({ BundleParamType::Constants, size, {}, {} });
+	return { static_cast<uint32_t>(params.size() - 1) };
+}
+
+BundleParam CommandBundle::AddBindingSet()
+{
+	params.push_back({ BundleParamType::BindingSet, 0, {}, {} });
+	return { static_cast<uint32_t>(params.size() - 1) };
+}
+
+BundleParam CommandBundle::AddBindingGroup()
+{
+	params.push_back({ BundleParamType::BindingGroup, 0, {}, {} });
+	return { static_cast<uint32_t>(params.size() - 1) };
+}
+
+BundleParam CommandBundle::AddVertexBuffer()
+{
+	params.push_back({ BundleParamType::VertexBuffer, 0, {}, {} });
+	return { static_cast<uint32_t>(params.size() - 1) };
+}
+
+void CommandBundle::AddPacket(Param& entry, CommandPacket* packet)
+{
+	entry.packets.push_back(packet);
+	entry.indices.push_back(GetPacketCount() - 1);
+}
+
+// Only the patched packets are translated again, the rest of the native bundle stays as compiled.
+void CommandBundle::UpdateNative(const Param& entry)
+{
+	if (!native)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < entry.packets.size(); i++)
+	{
+		native->Update(entry.indices[i], entry.packets[i]);
+	}
+}
+
+void CommandBundle::Compile(GraphicsDevice* device)
+{
+	native = device->CreateNativeBundle(*this);
+	nativePacketCount = GetPacketCount();
+}
+
+void CommandBundle::Execute(CommandList* commandList) const
+{
+	if (!native)
+	{
+		Replay(commandList);
+		return;
+	}
+
+	if (GetPacketCount() != nativePacketCount)
+	{
+		throw std::runtime_error("Bundle was recorded after it was compiled");
+	}
+
+	commandList->ExecuteBundle(native.Get());
+}
+
+// Packets referencing the same constants share their data, a new packet copies it from the first one.
+const void* CommandBundle::GetInitialConstants(BundleParam param)
+{
+	static constexpr uint8_t zero[CommandList::MaxPushConstantsSize] = {};
+	const Param& entry = GetParam(param, BundleParamType::Constants);
+	return entry.packets.empty() ? zero : static_cast<const void*>(static_cast<const SetPushConstantsPacket*>(entry.packets[0]) + 1);
+}
+
+void CommandBundle::SetPushConstants(ShaderStageFlags stages, uint32_t offset, BundleParam param)
+{
+	const void* initial = GetInitialConstants(param);
+	Param& entry = params[param.index];
+	AddPacket(entry, CommandStream::SetPushConstants(stages, offset, entry.size, initial));
+}
+
+void CommandBundle::SetBindingSet(BundleParam param)
+{
+	Param& entry = GetParam(param, BundleParamType::BindingSet);
+	BindingSet* current = entry.packets.empty() ? nullptr : static_cast<SetBindingSetPacket*>(entry.packets[0])->bindingSet;
+	AddPacket(entry, CommandStream::SetBindingSet(current));
+}
+
+void CommandBundle::SetBindingGroup(uint32_t index, BundleParam param)
+{
+	Param& entry = GetParam(param, BundleParamType::BindingGroup);
+	BindingGroup* current = entry.packets.empty() ? nullptr : static_cast<SetBindingGroupPacket*>(entry.packets[0])->group;
+	AddPacket(entry, CommandStream::SetBindingGroup(index, current));
+}
+
+void CommandBundle::SetVertexBuffer(uint32_t slot, BundleParam param, uint32_t stride)
+{
+	Param& entry = GetParam(param, BundleParamType::VertexBuffer);
+	Buffer* current = nullptr;
+	uint32_t offset = 0;
+	if (!entry.packets.empty())
+	{
+		auto first = static_cast<SetVertexBufferPacket*>(entry.packets[0]);
+		current = first->buffer;
+		offset = first->offset;
+	}
+	AddPacket(entry, CommandStream::SetVertexBuffer(slot, current, stride, offset));
+}
+
+void CommandBundle::PatchConstants(BundleParam param, const void* data, uint32_t size, uint32_t offset)
+{
+	Param& entry = GetParam(param, BundleParamType::Constants);
+	if (offset > entry.size || size > entry.size - offset)
+	{
+		throw std::invalid_argument("Patch exceeds the bundle constants");
+	}
+
+	for (auto packet : entry.packets)
+	{
+		memcpy(reinterpret_cast<uint8_t*>(static_cast<SetPushConstantsPacket*>(packet) + 1) + offset, data, size);
+	}
+	UpdateNative(entry);
+}
+
+void CommandBundle::PatchBindingSet(BundleParam param, BindingSet* bindingSet)
+{
+	const Param& entry = GetParam(param, BundleParamType::BindingSet);
+	for (auto packet : entry.packets)
+	{
+		static_cast<SetBindingSetPacket*>(packet)->bindingSet = bindingSet;
+	}
+	UpdateNative(entry);
+}
+
+void CommandBundle::PatchBindingGroup(BundleParam param, BindingGroup* group)
+{
+	const Param& entry = GetParam(param, BundleParamType::BindingGroup);
+	for (auto packet : entry.packets)
+	{
+		static_cast<SetBindingGroupPacket*>(packet)->group = group;
+	}
+	UpdateNative(entry);
+}
+
+void CommandBundle::PatchVertexBuffer(BundleParam param, Buffer* buffer, uint32_t offset)
+{
+	const Param& entry = GetParam(param, BundleParamType::VertexBuffer);
+	for (auto packet : entry.packets)
+	{
+		auto vertexBuffer = static_cast<SetVertexBufferPacket*>(packet);
+		vertexBuffer->buffer = buffer;
+		vertexBuffer->offset = offset;
+	}
+	UpdateNative(entry);
+}
+
+HEXA_PRISM_NAMESPACE_END
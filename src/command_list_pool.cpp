@@ -0,0 +1,125 @@
+#include "command_list_pool.hpp"
+#include <thread>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+void ParallelFor(uint32_t count, uint32_t workerCount, uint32_t minItemsPerWorker, const std::function<void(uint32_t worker, uint32_t begin, uint32_t end)>& body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (workerCount == 0)
+	{
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	workerCount = std::max(1u, std::min(workerCount, count / std::max(1u, minItemsPerWorker)));
+	if (workerCount == 1)
+	{
+		body(0, 0, count);
+		return;
+	}
+
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto worker = [&](uint32_t index)
+	{
+		const auto begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * index / workerCount);
+		const auto end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (index + 1) / workerCount);
+		try
+		{
+			body(index, begin, end);
+		}
+		catch (...)
+		{
+			std::lock_guard lock(errorMutex);
+			if (!error)
+			{
+				error = std::current_exception();
+			}
+		}
+	};
+
+	{
+		std::vector<std::jthread> threads;
+		threads.reserve(workerCount - 1);
+		for (uint32_t index = 1; index < workerCount; index++)
+		{
+			threads.emplace_back(worker, index);
+		}
+		worker(0);
+	}
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+CommandList* CommandListPool::Acquire()
+{
+	CommandList* list = nullptr;
+	{
+		std::lock_guard lock(mutex);
+		if (!freeLists.empty())
+		{
+			list = freeLists.back();
+			freeLists.pop_back();
+		}
+	}
+
+	if (!list)
+	{
+		auto created = device->CreateCommandList();
+		if (!created)
+		{
+			throw std::runtime_error("Failed to create a pooled command list.");
+		}
+
+		list = created.Get();
+		std::lock_guard lock(mutex);
+		lists.push_back(std::move(created));
+	}
+
+	list->Begin();
+	return list;
+}
+
+void CommandListPool::Reset()
+{
+	std::lock_guard lock(mutex);
+	freeLists.clear();
+	for (auto& list : lists)
+	{
+		freeLists.push_back(list.Get());
+	}
+}
+
+void CommandListPool::RecordParallel(CommandList* target, uint32_t count, uint32_t workerCount, uint32_t minItemsPerWorker, const std::function<void(CommandList* list, uint32_t begin, uint32_t end)>& record)
+{
+	if (workerCount == 0)
+	{
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::vector<CommandList*> recorded(workerCount, nullptr);
+	ParallelFor(count, workerCount, minItemsPerWorker, [&](uint32_t worker, uint32_t begin, uint32_t end)
+	{
+		CommandList* list = Acquire();
+		recorded[worker] = list;
+		record(list, begin, end);
+		list->End();
+	});
+
+	for (auto list : recorded)
+	{
+		if (list)
+		{
+			target->ExecuteCommandList(list);
+		}
+	}
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,247 @@
+#include "command_stream.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+CommandArena::~CommandArena()
+{
+	while (freeList)
+	{
+		auto next = freeList->next;
+		::operator delete(freeList);
+		freeList = next;
+	}
+}
+
+CommandChunk* CommandArena::Acquire()
+{
+	{
+		std::lock_guard lock(mutex);
+		if (freeList)
+		{
+			auto chunk = freeList;
+			freeList = chunk->next;
+			chunk->next = nullptr;
+			chunk->used = 0;
+			return chunk;
+		}
+		chunkCount++;
+	}
+
+	auto chunk = static_cast<CommandChunk*>(::operator new(ChunkSize));
+	chunk->next = nullptr;
+	chunk->used = 0;
+	chunk->capacity = ChunkSize - sizeof(CommandChunk);
+	return chunk;
+}
+
+void CommandArena::Release(CommandChunk* chunks)
+{
+	if (!chunks)
+	{
+		return;
+	}
+
+	auto last = chunks;
+	while (last->next)
+	{
+		last = last->next;
+	}
+
+	std::lock_guard lock(mutex);
+	last->next = freeList;
+	freeList = chunks;
+}
+
+CommandStream::~CommandStream()
+{
+	Release();
+}
+
+void CommandStream::NextChunk(uint32_t size)
+{
+	if (size > CommandArena::ChunkSize - sizeof(CommandChunk))
+	{
+		throw std::runtime_error("Command packet exceeds the command chunk size.");
+	}
+
+	// Chunks kept by Reset are reused in order before the arena is asked for more.
+	if (current && current->next)
+	{
+		current = current->next;
+		current->used = 0;
+		return;
+	}
+
+	auto chunk = arena->Acquire();
+	if (current)
+	{
+		current->next = chunk;
+	}
+	else
+	{
+		first = chunk;
+	}
+	current = chunk;
+}
+
+void CommandStream::Reset() noexcept
+{
+	if (first)
+	{
+		first->used = 0;
+	}
+	current = first;
+	packetCount = 0;
+}
+
+void CommandStream::Release() noexcept
+{
+	arena->Release(first);
+	first = nullptr;
+	current = nullptr;
+	packetCount = 0;
+}
+
+template<typename T>
+static const T& As(const CommandPacket* packet)
+{
+	return *static_cast<const T*>(packet);
+}
+
+void CommandStream::Replay(CommandList* commandList) const
+{
+	ForEachPacket([commandList](const CommandPacket* packet)
+	{
+		switch (packet->op)
+		{
+		case CommandOp::SetGraphicsPipelineState:
+			commandList->SetGraphicsPipelineState(As<SetGraphicsPipelineStatePacket>(packet).state);
+			break;
+		case CommandOp::SetComputePipelineState:
+			commandList->SetComputePipelineState(As<SetComputePipelineStatePacket>(packet).state);
+			break;
+		case CommandOp::SetBindingSet:
+			commandList->SetBindingSet(As<SetBindingSetPacket>(packet).bindingSet);
+			break;
+		case CommandOp::SetBindingGroup:
+		{
+			const auto& p = As<SetBindingGroupPacket>(packet);
+			commandList->SetBindingGroup(p.index, p.group);
+			break;
+		}
+		case CommandOp::SetVertexBuffer:
+		{
+			const auto& p = As<SetVertexBufferPacket>(packet);
+			commandList->SetVertexBuffer(p.slot, p.buffer, p.stride, p.offset);
+			break;
+		}
+		case CommandOp::SetIndexBuffer:
+		{
+			const auto& p = As<SetIndexBufferPacket>(packet);
+			commandList->SetIndexBuffer(p.buffer, p.format, p.offset);
+			break;
+		}
+		case CommandOp::SetRenderTarget:
+		{
+			const auto& p = As<SetRenderTargetPacket>(packet);
+			commandList->SetRenderTarget(p.rtv, p.dsv);
+			break;
+		}
+		case CommandOp::SetViewports:
+		{
+			const auto& p = As<SetViewportsPacket>(packet);
+			commandList->SetViewports(p.count, reinterpret_cast<const Viewport*>(&p + 1));
+			break;
+		}
+		case CommandOp::SetScissorRects:
+		{
+			const auto& p = As<SetScissorRectsPacket>(packet);
+			commandList->SetScissorRects(reinterpret_cast<const Rect*>(&p + 1), p.count);
+			break;
+		}
+		case CommandOp::SetPrimitiveTopology:
+			commandList->SetPrimitiveTopology(As<SetPrimitiveTopologyPacket>(packet).topology);
+			break;
+		case CommandOp::SetPushConstants:
+		{
+			const auto& p = As<SetPushConstantsPacket>(packet);
+			commandList->SetPushConstants(p.stages, p.offset, p.size, &p + 1);
+			break;
+		}
+		case CommandOp::DrawInstanced:
+		{
+			const auto& p = As<DrawInstancedPacket>(packet);
+			commandList->DrawInstanced(p.vertexCount, p.instanceCount, p.vertexOffset, p.instanceOffset);
+			break;
+		}
+		case CommandOp::DrawIndexedInstanced:
+		{
+			const auto& p = As<DrawIndexedInstancedPacket>(packet);
+			commandList->DrawIndexedInstanced(p.indexCount, p.instanceCount, p.indexOffset, p.vertexOffset, p.instanceOffset);
+			break;
+		}
+		case CommandOp::DrawInstancedIndirect:
+		{
+			const auto& p = As<DrawIndirectPacket>(packet);
+			commandList->DrawInstancedIndirect(p.args, p.offset);
+			break;
+		}
+		case CommandOp::DrawIndexedInstancedIndirect:
+		{
+			const auto& p = As<DrawIndirectPacket>(packet);
+			commandList->DrawIndexedInstancedIndirect(p.args, p.offset);
+			break;
+		}
+		case CommandOp::Dispatch:
+		{
+			const auto& p = As<DispatchPacket>(packet);
+			commandList->Dispatch(p.x, p.y, p.z);
+			break;
+		}
+		case CommandOp::DispatchIndirect:
+		{
+			const auto& p = As<DispatchIndirectPacket>(packet);
+			commandList->DispatchIndirect(p.args, p.offset);
+			break;
+		}
+		case CommandOp::ClearRenderTargetView:
+		{
+			const auto& p = As<ClearRenderTargetViewPacket>(packet);
+			commandList->ClearRenderTargetView(p.rtv, p.color);
+			break;
+		}
+		case CommandOp::ClearDepthStencilView:
+		{
+			const auto& p = As<ClearDepthStencilViewPacket>(packet);
+			commandList->ClearDepthStencilView(p.dsv, p.flags, p.depth, p.stencil);
+			break;
+		}
+		case CommandOp::ClearUnorderedAccessViewUint:
+		{
+			const auto& p = As<ClearUnorderedAccessViewUintPacket>(packet);
+			commandList->ClearUnorderedAccessViewUint(p.uav, p.values[0], p.values[1], p.values[2], p.values[3]);
+			break;
+		}
+		case CommandOp::CopyResource:
+		{
+			const auto& p = As<CopyResourcePacket>(packet);
+			commandList->CopyResource(p.dst, p.src);
+			break;
+		}
+		case CommandOp::CopySubresourceRegion:
+		{
+			const auto& p = As<CopySubresourceRegionPacket>(packet);
+			commandList->CopySubresourceRegion(p.dst, p.dstSubresource, p.dstX, p.dstY, p.dstZ, p.src, p.srcSubresource, p.hasBox ? &p.box : nullptr, p.flags);
+			break;
+		}
+		case CommandOp::BeginEvent:
+			commandList->BeginEvent(reinterpret_cast<const char*>(&As<BeginEventPacket>(packet) + 1));
+			break;
+		case CommandOp::EndEvent:
+			commandList->EndEvent();
+			break;
+		}
+	});
+}
+
+HEXA_PRISM_NAMESPACE_END
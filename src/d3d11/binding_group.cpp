@@ -0,0 +1,153 @@
+#include "d3d11/binding_group.hpp"
+#include "d3d11/d3d11.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+D3D11BindingGroup::D3D11BindingGroup(const BindingGroupDesc& desc)
+{
+    std::vector<D3D11ShaderParameter> parameters;
+    for (uint32_t i = 0; i < desc.numEntries; i++)
+    {
+        const auto& entry = desc.entries[i];
+        const auto stages = static_cast<uint32_t>(entry.stages);
+
+        if (entry.type == ShaderParameterType::UAV && stages != static_cast<uint32_t>(ShaderStageFlags::Compute))
+        {
+            throw std::runtime_error("Binding group UAVs are only supported for the compute stage");
+        }
+
+        for (uint32_t stage = 0; stage < BindingVersionTable::StageCount; stage++)
+        {
+            if ((stages & (1u << stage)) == 0)
+            {
+                continue;
+            }
+
+            D3D11ShaderParameter parameter = {};
+            parameter.name = String(entry.name.c_str());
+            parameter.hash = D3D11DescriptorRange::HashString(entry.name.c_str());
+            parameter.index = entry.slot;
+            parameter.size = 1;
+            parameter.stage = static_cast<ShaderStage>(stage);
+            parameter.type = entry.type;
+            parameters.push_back(parameter);
+        }
+    }
+
+    static constexpr ShaderStage stages[] = { ShaderStage::Vertex, ShaderStage::Hull, ShaderStage::Domain, ShaderStage::Geometry, ShaderStage::Pixel, ShaderStage::Compute };
+    ranges = storage.Build(stages, parameters);
+
+    for (const auto& range : ranges)
+    {
+        const uint32_t index = BindingVersionTable::IndexOf(range.type, range.stage);
+        slots[index] = range.GetSlots();
+        if (range.count != 0)
+        {
+            rangeMask |= 1u << index;
+        }
+    }
+}
+
+void D3D11BindingGroup::SetByName(ShaderParameterType type, const char* name, void* resource, uint32_t initialCount)
+{
+    for (auto& range : ranges.subspan(static_cast<size_t>(type) * BindingVersionTable::StageCount, BindingVersionTable::StageCount))
+    {
+        const uint32_t changes = range.changes;
+        range.TrySetByName(name, resource, initialCount);
+        if (range.changes != changes)
+        {
+            versions.MarkDirty(range.type, range.stage);
+        }
+    }
+}
+
+void D3D11BindingGroup::SetCBV(const char* name, Buffer* buffer)
+{
+    void* p = buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr;
+    SetByName(ShaderParameterType::CBV, name, p);
+}
+
+void D3D11BindingGroup::SetSampler(const char* name, SamplerState* sampler)
+{
+    void* p = sampler ? static_cast<D3D11SamplerState*>(sampler)->GetSamplerState() : nullptr;
+    SetByName(ShaderParameterType::Sampler, name, p);
+}
+
+void D3D11BindingGroup::SetSRV(const char* name, ShaderResourceView* view)
+{
+    void* p = view ? static_cast<D3D11ShaderResourceView*>(view)->GetView() : nullptr;
+    SetByName(ShaderParameterType::SRV, name, p);
+}
+
+void D3D11BindingGroup::SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount)
+{
+    void* p = view ? static_cast<D3D11UnorderedAccessView*>(view)->GetView() : nullptr;
+    SetByName(ShaderParameterType::UAV, name, p, initialCount);
+}
+
+bool D3D11BindingGroup::IsCompatible(const D3D11ResourceBindingList& bindingList) const
+{
+    for (uint32_t type = 0; type < BindingVersionTable::TypeCount; type++)
+    {
+        for (const auto& range : bindingList.GetRanges(static_cast<ShaderParameterType>(type)))
+        {
+            const uint32_t index = BindingVersionTable::IndexOf(range.type, range.stage);
+            if ((rangeMask & (1u << index)) == 0)
+            {
+                continue;
+            }
+
+            const auto& groupRange = ranges[index];
+            for (uint32_t i = 0; i < range.bucketCount; i++)
+            {
+                const auto& bucket = range.buckets[i];
+
+                SlotMask bucketSlots;
+                bucketSlots.SetRange(bucket.index, std::max(bucket.size, 1u));
+                if (!(bucketSlots & slots[index]).Any())
+                {
+                    continue;
+                }
+
+                D3D11DescriptorBucket* groupBucket;
+                if (!groupRange.TryGetByName(bucket.name, groupBucket) || groupBucket->index != bucket.index)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void D3D11BindingGroup::Bind(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges) const
+{
+    uint32_t pending = dirtyRanges & rangeMask;
+    while (pending != 0)
+    {
+        const uint32_t index = static_cast<uint32_t>(std::countr_zero(pending));
+        pending &= pending - 1;
+
+        const auto& range = ranges[index];
+        if (range.type == ShaderParameterType::UAV)
+        {
+            range.BindUAV(context);
+        }
+        else
+        {
+            range.Bind(context, D3D11DescriptorRange::GetBindCallback(range.type, range.stage));
+        }
+    }
+}
+
+void D3D11BindingGroup::UnbindComputeUAVs(const ComPtr<ID3D11DeviceContext3>& context) const
+{
+    const uint32_t index = BindingVersionTable::IndexOf(ShaderParameterType::UAV, ShaderStage::Compute);
+    if ((rangeMask & (1u << index)) != 0)
+    {
+        ranges[index].UnbindUAV(context);
+    }
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,126 @@
+#include "d3d11/binding_set.hpp"
+#include "d3d11/d3d11.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+void D3D11BindingSet::SetEntry(const char* name, ShaderParameterType type, void* resource, uint32_t initialCount, uint32_t firstConstant, uint32_t numConstants)
+{
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry)
+    {
+        return entry.type == type && entry.name == name;
+    });
+
+    if (it == entries.end())
+    {
+        if (!resource)
+        {
+            return;
+        }
+
+        entries.push_back({ name, type, resource, initialCount, firstConstant, numConstants });
+        rangeMask |= BindingVersionTable::MaskOf(type);
+        versions.MarkDirty(type);
+        return;
+    }
+
+    if (!resource)
+    {
+        *it = std::move(entries.back());
+        entries.pop_back();
+
+        rangeMask = 0;
+        for (const auto& entry : entries)
+        {
+            rangeMask |= BindingVersionTable::MaskOf(entry.type);
+        }
+
+        versions.MarkDirty(type);
+        return;
+    }
+
+    if (it->resource == resource && it->initialCount == initialCount && it->firstConstant == firstConstant && it->numConstants == numConstants)
+    {
+        return;
+    }
+
+    it->resource = resource;
+    it->initialCount = initialCount;
+    it->firstConstant = firstConstant;
+    it->numConstants = numConstants;
+    versions.MarkDirty(type);
+}
+
+void D3D11BindingSet::SetCBV(const char* name, Buffer* buffer)
+{
+    void* p = buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr;
+    SetEntry(name, ShaderParameterType::CBV, p, static_cast<uint32_t>(-1));
+}
+
+void D3D11BindingSet::SetCBV(const char* name, const TransientConstants& constants)
+{
+    void* p = constants.buffer ? static_cast<D3D11Buffer*>(constants.buffer)->GetBuffer() : nullptr;
+    SetEntry(name, ShaderParameterType::CBV, p, static_cast<uint32_t>(-1), constants.firstConstant, constants.numConstants);
+}
+
+void D3D11BindingSet::SetSampler(const char* name, SamplerState* sampler)
+{
+    void* p = sampler ? static_cast<D3D11SamplerState*>(sampler)->GetSamplerState() : nullptr;
+    SetEntry(name, ShaderParameterType::Sampler, p, static_cast<uint32_t>(-1));
+}
+
+void D3D11BindingSet::SetSRV(const char* name, ShaderResourceView* view)
+{
+    void* p = view ? static_cast<D3D11ShaderResourceView*>(view)->GetView() : nullptr;
+    SetEntry(name, ShaderParameterType::SRV, p, static_cast<uint32_t>(-1));
+}
+
+void D3D11BindingSet::SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount)
+{
+    void* p = view ? static_cast<D3D11UnorderedAccessView*>(view)->GetView() : nullptr;
+    SetEntry(name, ShaderParameterType::UAV, p, initialCount);
+}
+
+void D3D11BindingSet::Clear()
+{
+    if (entries.empty())
+    {
+        return;
+    }
+
+    entries.clear();
+    rangeMask = 0;
+    versions.MarkAllDirty();
+}
+
+std::span<const D3D11BindingOverride> D3D11BindingSet::Resolve(const D3D11ResourceBindingList& bindingList)
+{
+    if (resolvedListId == bindingList.GetVersions().GetId() && resolvedLayoutVersion == bindingList.GetLayoutVersion() && resolvedVersion == versions.GetVersion())
+    {
+        return resolved;
+    }
+
+    resolved.clear();
+    for (const auto& entry : entries)
+    {
+        for (const auto& range : bindingList.GetRanges(entry.type))
+        {
+            D3D11DescriptorBucket* bucket;
+            if (range.TryGetByName(entry.name.c_str(), bucket))
+            {
+                resolved.push_back({ BindingVersionTable::IndexOf(range.type, range.stage), bucket->index - range.startSlot, entry.resource, entry.initialCount, entry.firstConstant, entry.numConstants });
+            }
+        }
+    }
+
+    std::stable_sort(resolved.begin(), resolved.end(), [](const D3D11BindingOverride& a, const D3D11BindingOverride& b)
+    {
+        return a.range < b.range;
+    });
+
+    resolvedListId = bindingList.GetVersions().GetId();
+    resolvedLayoutVersion = bindingList.GetLayoutVersion();
+    resolvedVersion = versions.GetVersion();
+    return resolved;
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -21,6 +21,22 @@ void D3D11ComputePipeline::Compile()
 	);
 
 	valid = success;
+
+	std::lock_guard lock(variableLayoutMutex);
+	variableLayout.reset();
+}
+
+std::shared_ptr<const D3D11VariableLayout> D3D11ComputePipeline::GetVariableLayout()
+{
+	std::lock_guard lock(variableLayoutMutex);
+	if (!variableLayout)
+	{
+		auto layout = std::make_shared<D3D11VariableLayout>();
+		layout->Reflect(computeShaderBlob, ShaderStage::Compute);
+		layout->Finalize();
+		variableLayout = std::move(layout);
+	}
+	return variableLayout;
 }
 
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
@@ -10,19 +10,48 @@ D3D11ComputePipelineState::D3D11ComputePipelineState(const PrismObj<D3D11Compute
 	isValid = true;
 }
 
-void D3D11ComputePipelineState::SetState(ID3D11DeviceContext3* context)
+void D3D11ComputePipelineState::SetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots)
 {
     auto pipe = pipeline.AsPtr<D3D11ComputePipeline>();
-    context->CSSetShader(pipe->cs.Get(), nullptr, 0);
+    if (cache.SetObject(StateObject::ComputeShader, pipe->cs.Get()))
+    {
+        context->CSSetShader(pipe->cs.Get(), nullptr, 0);
+    }
 
-    bindingList->BindCompute(context);
+    const uint32_t dirtyRanges = AcquireBindings(tracker, *bindingList, bindingSet);
+    bindingList->BindCompute(context, dirtyRanges, ResolveOverrides(bindingSet, *bindingList), groupSlots);
 }
 
-void D3D11ComputePipelineState::UnsetState(ID3D11DeviceContext3* context)
+void D3D11ComputePipelineState::CommitBindings(ID3D11DeviceContext3* context, BindingTracker& tracker, D3D11VariableUploadCache& uploads, D3D11BindingSet* bindingSet, const SlotMask* groupSlots)
 {
-    context->CSSetShader(nullptr, nullptr, 0);
+    bindingList->UploadState(context, uploads);
 
-    bindingList->UnbindCompute(context);
+    const uint32_t dirtyRanges = AcquireBindings(tracker, *bindingList, bindingSet);
+    if (dirtyRanges != 0)
+    {
+        bindingList->BindCompute(context, dirtyRanges, ResolveOverrides(bindingSet, *bindingList), groupSlots);
+    }
+}
+
+void D3D11ComputePipelineState::UnsetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots, bool replaced)
+{
+    const auto overrides = ResolveOverrides(bindingSet, *bindingList);
+
+    // UAVs are the only hazard: a resource left bound for writing would be
+    // silently unbound by the runtime when it is next used as an input.
+    bindingList->UnbindComputeUAVs(context, overrides, groupSlots);
+    tracker.Invalidate();
+
+    if ((static_cast<uint32_t>(bindingList->GetFlags()) & static_cast<uint32_t>(PipelineStateFlags::UnbindOnSwitch)) == 0)
+    {
+        return;
+    }
+
+    if (!replaced && cache.SetObject(StateObject::ComputeShader, nullptr))
+    {
+        context->CSSetShader(nullptr, nullptr, 0);
+    }
+    bindingList->UnbindCompute(context, overrides, groupSlots);
 }
 
 
@@ -0,0 +1,134 @@
+#include "d3d11/constant_ring.hpp"
+#include "d3d11/d3d11.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+D3D11ConstantRing::D3D11ConstantRing(ID3D11Device* device, bool retainRanges, uint32_t capacity)
+    : device(device), retainRanges(retainRanges), ring(capacity, OffsetAlignment)
+{
+    // Sub-ranges are only usable if the driver both honours the offsets and allows no-overwrite maps of dynamic
+    // constant buffers, which deferred contexts would reject otherwise.
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+    {
+        offsetting = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
+
+    if (offsetting)
+    {
+        buffers.push_back(CreateBuffer(capacity));
+    }
+}
+
+void D3D11ConstantRing::Reset() noexcept
+{
+    ring.Reset();
+    currentBuffer = 0;
+    ringUsed = false;
+    std::fill(std::begin(sizeClassUsed), std::end(sizeClassUsed), 0u);
+}
+
+PrismObj<D3D11Buffer> D3D11ConstantRing::CreateBuffer(uint32_t size)
+{
+    BufferDesc desc = {};
+    desc.type = BufferType::ConstantBuffer;
+    desc.widthInBytes = size;
+    desc.cpuAccessFlags = CpuAccessFlags::Write;
+    desc.gpuAccessFlags = GpuAccessFlags::Read;
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.ByteWidth = size;
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    ComPtr<ID3D11Buffer> d3dBuffer;
+    HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &d3dBuffer);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to create constant ring buffer");
+    }
+
+    return MakePrismObj<D3D11Buffer>(desc, std::move(d3dBuffer));
+}
+
+TransientConstants D3D11ConstantRing::Write(ID3D11DeviceContext* context, const void* data, uint32_t size)
+{
+    if (size == 0 || size > MaxSize)
+    {
+        throw std::runtime_error("Transient constants exceed the maximum constant buffer size");
+    }
+
+    if (!offsetting)
+    {
+        return WriteEmulated(context, data, size);
+    }
+
+    UploadRingAllocation allocation;
+    if (!ring.Allocate(size, allocation))
+    {
+        return WriteEmulated(context, data, size);
+    }
+
+    // The discard of the first write after Reset stays on the first buffer, later wraps move on to the next one so
+    // the ranges handed out before keep their memory.
+    if (allocation.discard && ringUsed)
+    {
+        if (!retainRanges)
+        {
+            discardGeneration++;
+        }
+        else if (++currentBuffer == static_cast<uint32_t>(buffers.size()))
+        {
+            buffers.push_back(CreateBuffer(ring.GetCapacity()));
+        }
+    }
+    ringUsed = true;
+
+    auto& buffer = buffers[currentBuffer];
+    auto d3dBuffer = buffer->GetBuffer();
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = context->Map(d3dBuffer, 0, allocation.discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to map constant ring buffer");
+    }
+
+    memcpy(static_cast<uint8_t*>(mapped.pData) + allocation.offset, data, size);
+    context->Unmap(d3dBuffer, 0);
+
+    return { buffer.Get(), allocation.offset / ConstantSize, allocation.size / ConstantSize };
+}
+
+TransientConstants D3D11ConstantRing::WriteEmulated(ID3D11DeviceContext* context, const void* data, uint32_t size)
+{
+    // Size classes go from 256 bytes up to the 64 KB constant buffer limit. A discard renames the buffer, so reusing
+    // a buffer never stalls on draws still in flight, only ranges bound after the reuse would see the new contents.
+    const uint32_t sizeClass = static_cast<uint32_t>(std::bit_width((size - 1) / OffsetAlignment));
+    auto& pool = sizeClasses[sizeClass];
+    const uint32_t index = retainRanges ? sizeClassUsed[sizeClass]++ : 0;
+    if (index == pool.size())
+    {
+        pool.push_back(CreateBuffer(OffsetAlignment << sizeClass));
+    }
+    else if (!retainRanges)
+    {
+        discardGeneration++;
+    }
+
+    auto& pooled = pool[index];
+    auto d3dBuffer = pooled->GetBuffer();
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = context->Map(d3dBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to map constant ring buffer");
+    }
+
+    memcpy(mapped.pData, data, size);
+    context->Unmap(d3dBuffer, 0);
+
+    return { pooled.Get(), 0, 0 };
+}
+
+HEXA_PRISM_NAMESPACE_END
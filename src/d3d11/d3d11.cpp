@@ -69,6 +69,106 @@ namespace
 		return result;
 	}
 
+	uint32_t MipChainLength(uint32_t width, uint32_t height, uint32_t depth)
+	{
+		uint32_t size = std::max(width, std::max(height, depth));
+		uint32_t levels = 1;
+		while (size > 1)
+		{
+			size >>= 1;
+			levels++;
+		}
+		return levels;
+	}
+
+	// 'storage' receives the converted entries and must outlive the create call that consumes them.
+	const D3D11_SUBRESOURCE_DATA* ConvertInitialData(const SubresourceData* initialData, uint32_t count, std::vector<D3D11_SUBRESOURCE_DATA>& storage)
+	{
+		if (!initialData)
+		{
+			return nullptr;
+		}
+
+		storage.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			storage[i].pSysMem = initialData[i].data;
+			storage[i].SysMemPitch = initialData[i].rowPitch;
+			storage[i].SysMemSlicePitch = initialData[i].slicePitch;
+		}
+		return storage.data();
+	}
+
+	UINT ConvertCopyFlags(CopyFlags flags)
+	{
+		UINT result = 0;
+		if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(CopyFlags::NoOverwrite)) != 0)
+			result |= D3D11_COPY_NO_OVERWRITE;
+		if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(CopyFlags::Discard)) != 0)
+			result |= D3D11_COPY_DISCARD;
+		return result;
+	}
+
+	UINT ConvertClearFlags(DepthStencilViewClearFlags flags)
+	{
+		UINT result = 0;
+		if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(DepthStencilViewClearFlags::Depth)) != 0)
+			result |= D3D11_CLEAR_DEPTH;
+		if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(DepthStencilViewClearFlags::Stencil)) != 0)
+			result |= D3D11_CLEAR_STENCIL;
+		return result;
+	}
+
+	// Converts UTF-8 to UTF-16, invalid input gives an empty string.
+	std::wstring ToWideString(const char* text)
+	{
+		const int required = MultiByteToWideChar(CP_UTF8, 0, text, -1, nullptr, 0);
+		if (required <= 0)
+		{
+			return {};
+		}
+
+		std::wstring result(static_cast<size_t>(required - 1), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, text, -1, result.data(), required);
+		return result;
+	}
+
+	// Bytes of a texel, or of a 4x4 block for block compressed formats. Packed and video formats are not covered.
+	bool GetFormatBlock(DXGI_FORMAT format, uint32_t& bytes, uint32_t& blockSize)
+	{
+		auto in = [format](DXGI_FORMAT first, DXGI_FORMAT last) { return format >= first && format <= last; };
+
+		blockSize = 1;
+		if (in(DXGI_FORMAT_R32G32B32A32_TYPELESS, DXGI_FORMAT_R32G32B32A32_SINT))
+			bytes = 16;
+		else if (in(DXGI_FORMAT_R32G32B32_TYPELESS, DXGI_FORMAT_R32G32B32_SINT))
+			bytes = 12;
+		else if (in(DXGI_FORMAT_R16G16B16A16_TYPELESS, DXGI_FORMAT_X32_TYPELESS_G8X24_UINT))
+			bytes = 8;
+		else if (in(DXGI_FORMAT_R10G10B10A2_TYPELESS, DXGI_FORMAT_X24_TYPELESS_G8_UINT) || format == DXGI_FORMAT_R9G9B9E5_SHAREDEXP
+			|| in(DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB))
+			bytes = 4;
+		else if (in(DXGI_FORMAT_R8G8_TYPELESS, DXGI_FORMAT_R16_SINT) || in(DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_B5G5R5A1_UNORM)
+			|| format == DXGI_FORMAT_B4G4R4A4_UNORM)
+			bytes = 2;
+		else if (in(DXGI_FORMAT_R8_TYPELESS, DXGI_FORMAT_A8_UNORM))
+			bytes = 1;
+		else if (in(DXGI_FORMAT_BC1_TYPELESS, DXGI_FORMAT_BC1_UNORM_SRGB) || in(DXGI_FORMAT_BC4_TYPELESS, DXGI_FORMAT_BC4_SNORM))
+		{
+			bytes = 8;
+			blockSize = 4;
+		}
+		else if (in(DXGI_FORMAT_BC2_TYPELESS, DXGI_FORMAT_BC3_UNORM_SRGB) || in(DXGI_FORMAT_BC5_TYPELESS, DXGI_FORMAT_BC5_SNORM)
+			|| in(DXGI_FORMAT_BC6H_TYPELESS, DXGI_FORMAT_BC7_UNORM_SRGB))
+		{
+			bytes = 16;
+			blockSize = 4;
+		}
+		else
+			return false;
+		return true;
+	}
+
 	UINT ConvertSwapChainFlags(SwapChainFlags flags)
 	{
 		return static_cast<UINT>(flags);
@@ -162,23 +262,165 @@ D3D11SamplerState::D3D11SamplerState(const SamplerDesc& desc, ComPtr<ID3D11Sampl
 
 void D3D11CommandList::UnsetPipelineState()
 {
-	if (currentPSO)
+	if (graphicsPSO)
 	{
-		if (auto oldGraphicsState = dynamic_cast<D3D11GraphicsPipelineState*>(currentPSO))
+		graphicsPSO->UnsetState(context.Get(), stateCache, graphicsBindings, bindingSet, GetGroupSlots());
+		graphicsPSO = nullptr;
+	}
+	if (computePSO)
+	{
+		computePSO->UnsetState(context.Get(), stateCache, computeBindings, bindingSet, GetGroupSlots());
+		UnbindGroupComputeUAVs();
+		computePSO = nullptr;
+	}
+}
+
+void D3D11CommandList::InvalidateBindings()
+{
+	graphicsBindings.Invalidate();
+	computeBindings.Invalidate();
+
+	for (auto& attached : bindingGroups)
+	{
+		attached.graphics.Invalidate();
+		attached.compute.Invalidate();
+	}
+
+	pushConstants.boundStages = 0;
+}
+
+void D3D11CommandList::CommitBindingGroups(const D3D11ResourceBindingList& bindingList, bool compute)
+{
+	static constexpr uint32_t ComputeRanges = BindingVersionTable::MaskOf(ShaderStage::Compute);
+
+	for (auto& attached : bindingGroups)
+	{
+		if (!attached.group)
 		{
-			oldGraphicsState->UnsetState(context.Get());
+			continue;
 		}
-		if (auto oldComputeState = dynamic_cast<D3D11ComputePipelineState*>(currentPSO))
+
+		if (attached.validatedListId != bindingList.GetVersions().GetId() || attached.validatedLayoutVersion != bindingList.GetLayoutVersion())
 		{
-			oldComputeState->UnsetState(context.Get());
+			if (!attached.group->IsCompatible(bindingList))
+			{
+				throw std::runtime_error("Binding group is not compatible with the pipeline state.");
+			}
+
+			attached.validatedListId = bindingList.GetVersions().GetId();
+			attached.validatedLayoutVersion = bindingList.GetLayoutVersion();
+		}
+
+		auto& tracker = compute ? attached.compute : attached.graphics;
+		const uint32_t dirtyRanges = tracker.Acquire(attached.group->GetVersions()) & (compute ? ComputeRanges : ~ComputeRanges);
+		if (dirtyRanges != 0)
+		{
+			attached.group->Bind(context, dirtyRanges);
+		}
+	}
+}
+
+void D3D11CommandList::UnbindGroupComputeUAVs()
+{
+	// A group UAV left on the compute stage would make the runtime silently drop a graphics SRV of the same resource.
+	for (auto& attached : bindingGroups)
+	{
+		if (attached.group)
+		{
+			attached.group->UnbindComputeUAVs(context);
+			attached.compute.Invalidate();
 		}
-		currentPSO = nullptr;
+	}
+}
+
+void D3D11CommandList::CommitPushConstants(const D3D11ResourceBindingList& bindingList, ShaderStageFlags stages)
+{
+	const uint32_t declared = static_cast<uint32_t>(bindingList.GetPushConstantStages()) & static_cast<uint32_t>(stages);
+	if (declared == 0)
+	{
+		return;
+	}
+
+	// Another list may declare the block at different slots, everything it declares has to be bound again.
+	if (pushConstants.listId != bindingList.GetVersions().GetId() || pushConstants.layoutVersion != bindingList.GetLayoutVersion())
+	{
+		pushConstants.boundStages = 0;
+		pushConstants.listId = bindingList.GetVersions().GetId();
+		pushConstants.layoutVersion = bindingList.GetLayoutVersion();
+	}
+
+	// A later write discarded the memory of the block, it is written again and every stage sees the new range.
+	if (pushConstants.range.buffer && pushConstants.discardGeneration != constantRing->GetDiscardGeneration())
+	{
+		pushConstants.range = {};
+		pushConstants.boundStages = 0;
+	}
+
+	uint32_t pending = declared & (pushConstants.dirtyStages | ~pushConstants.boundStages);
+	if (pending == 0)
+	{
+		return;
+	}
+
+	if (!pushConstants.range.buffer)
+	{
+		pushConstants.range = WriteConstants(pushConstants.data, std::max(pushConstants.size, 16u));
+
+		// Writing the block itself may have renamed the buffer the clean stages are still bound to.
+		if (pushConstants.discardGeneration != constantRing->GetDiscardGeneration())
+		{
+			pushConstants.discardGeneration = constantRing->GetDiscardGeneration();
+			pushConstants.boundStages = 0;
+			pending = declared;
+		}
+	}
+
+	auto buffer = static_cast<D3D11Buffer*>(pushConstants.range.buffer)->GetBuffer();
+	for (uint32_t bits = pending; bits != 0; bits &= bits - 1)
+	{
+		const auto stage = static_cast<ShaderStage>(std::countr_zero(bits));
+		D3D11DescriptorRange::BindConstants(context.Get(), stage, bindingList.GetPushConstantSlot(stage), buffer, pushConstants.range.firstConstant, pushConstants.range.numConstants);
+	}
+
+	pushConstants.boundStages |= pending;
+	pushConstants.dirtyStages &= ~pending;
+}
+
+void D3D11CommandList::CommitGraphicsBindings()
+{
+	if (graphicsPSO)
+	{
+		CommitBindingGroups(graphicsPSO->GetBindingList(), false);
+		graphicsPSO->CommitBindings(context.Get(), graphicsBindings, variableUploads, bindingSet, GetGroupSlots());
+		CommitPushConstants(graphicsPSO->GetBindingList(), ShaderStageFlags::AllGraphics);
+	}
+}
+
+void D3D11CommandList::CommitComputeBindings()
+{
+	if (computePSO)
+	{
+		CommitBindingGroups(computePSO->GetBindingList(), true);
+		computePSO->CommitBindings(context.Get(), computeBindings, variableUploads, bindingSet, GetGroupSlots());
+		CommitPushConstants(computePSO->GetBindingList(), ShaderStageFlags::Compute);
 	}
 }
 
 D3D11CommandList::D3D11CommandList(ComPtr<ID3D11DeviceContext4>&& context, const CommandListType type)
 	: context(std::move(context)), type(type)
 {
+	// Without driver command lists the runtime emulates deferred contexts and applies a destination box of
+	// UpdateSubresource to the source pointer as well.
+	if (type != CommandListType::Immediate)
+	{
+		ComPtr<ID3D11Device> device;
+		this->context->GetDevice(&device);
+		D3D11_FEATURE_DATA_THREADING threading = {};
+		if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading))))
+		{
+			offsetUpdateSource = !threading.DriverCommandLists;
+		}
+	}
 }
 
 CommandListType D3D11CommandList::GetType() const noexcept
@@ -189,6 +431,21 @@ CommandListType D3D11CommandList::GetType() const noexcept
 void D3D11CommandList::Begin()
 {
 	commandList.Reset();
+	graphicsPSO = nullptr;
+	computePSO = nullptr;
+	bindingSet = nullptr;
+	for (uint32_t i = 0; i < BindingGroup::MaxAttachedGroups; i++)
+	{
+		SetBindingGroup(i, nullptr);
+	}
+	InvalidateBindings();
+	stateCache.Invalidate();
+	variableUploads.Invalidate();
+	pushConstants = {};
+	if (constantRing)
+	{
+		constantRing->Reset();
+	}
 }
 
 void D3D11CommandList::End()
@@ -198,56 +455,143 @@ void D3D11CommandList::End()
 	{
 		throw std::runtime_error("Failed to finish command list.");
 	}
+
+	// Finishing resets the deferred context, the ring range and the bound slots are gone with it.
+	stateCache.Invalidate();
+	pushConstants.range = {};
+	pushConstants.boundStages = 0;
+	if (constantRing)
+	{
+		constantRing->Reset();
+	}
 }
 
 void D3D11CommandList::SetGraphicsPipelineState(GraphicsPipelineState* state)
 {
-	UnsetPipelineState();
-	if (state)
+	// Setting the bound state again is not skipped, it restores whatever direct state calls changed since. The state
+	// cache filters the parts that are still current.
+	auto d3dState = static_cast<D3D11GraphicsPipelineState*>(state);
+
+	if (computePSO)
 	{
-		auto d3dState = static_cast<D3D11GraphicsPipelineState*>(state);
-		d3dState->SetState(context.Get());
-		currentPSO = state;
+		computePSO->UnsetState(context.Get(), stateCache, computeBindings, bindingSet, GetGroupSlots());
+		UnbindGroupComputeUAVs();
+		computePSO = nullptr;
+	}
+
+	if (graphicsPSO && graphicsPSO != d3dState)
+	{
+		graphicsPSO->UnsetState(context.Get(), stateCache, graphicsBindings, bindingSet, GetGroupSlots(), d3dState != nullptr);
+	}
+
+	graphicsPSO = d3dState;
+	if (d3dState)
+	{
+		CommitBindingGroups(d3dState->GetBindingList(), false);
+		d3dState->SetState(context.Get(), stateCache, graphicsBindings, bindingSet, GetGroupSlots());
 	}
 }
 
 void D3D11CommandList::SetComputePipelineState(ComputePipelineState* state)
 {
-	UnsetPipelineState();
-	if (state)
+	auto d3dState = static_cast<D3D11ComputePipelineState*>(state);
+
+	if (graphicsPSO)
 	{
-		auto d3dState = static_cast<D3D11ComputePipelineState*>(state);
-		d3dState->SetState(context.Get());
-		currentPSO = state;
+		graphicsPSO->UnsetState(context.Get(), stateCache, graphicsBindings, bindingSet, GetGroupSlots());
+		graphicsPSO = nullptr;
+	}
+
+	if (computePSO && computePSO != d3dState)
+	{
+		computePSO->UnsetState(context.Get(), stateCache, computeBindings, bindingSet, GetGroupSlots(), d3dState != nullptr);
+		if (!d3dState)
+		{
+			UnbindGroupComputeUAVs();
+		}
+	}
+
+	// Binding compute UAVs makes the runtime drop any aliasing SRVs, so the graphics slots can no longer be trusted,
+	// including the ones owned by binding groups.
+	graphicsBindings.Invalidate();
+	for (auto& attached : bindingGroups)
+	{
+		attached.graphics.Invalidate();
+	}
+
+	computePSO = d3dState;
+	if (d3dState)
+	{
+		CommitBindingGroups(d3dState->GetBindingList(), true);
+		d3dState->SetState(context.Get(), stateCache, computeBindings, bindingSet, GetGroupSlots());
 	}
 }
 
-void D3D11CommandList::SetVertexBuffer(const uint32_t slot, Buffer* buffer, const uint32_t stride, const uint32_t offset)
+void D3D11CommandList::SetBindingSet(BindingSet* bindingSet)
 {
-	if (!buffer)
+	// Takes effect on the next draw or dispatch, the trackers notice the swap and rebind only the affected ranges.
+	this->bindingSet = static_cast<D3D11BindingSet*>(bindingSet);
+}
+
+void D3D11CommandList::SetBindingGroup(uint32_t index, BindingGroup* group)
+{
+	if (index >= BindingGroup::MaxAttachedGroups)
+	{
+		throw std::runtime_error("Binding group index out of range.");
+	}
+
+	auto d3dGroup = static_cast<D3D11BindingGroup*>(group);
+	if (bindingGroups[index].group == d3dGroup)
 	{
-		ID3D11Buffer* nullBuffer = nullptr;
-		context->IASetVertexBuffers(slot, 1, &nullBuffer, &stride, &offset);
 		return;
 	}
 
-	const auto d3dBuffer = static_cast<D3D11Buffer*>(buffer);
-	ID3D11Buffer* d3dBufferPtr = d3dBuffer->GetBuffer();
-	context->IASetVertexBuffers(slot, 1, &d3dBufferPtr, &stride, &offset);
+	bindingGroups[index] = {};
+	bindingGroups[index].group = d3dGroup;
+
+	SlotMask slots[BindingVersionTable::RangeCount];
+	hasBindingGroups = false;
+	for (const auto& attached : bindingGroups)
+	{
+		if (!attached.group)
+		{
+			continue;
+		}
+
+		hasBindingGroups = true;
+		for (uint32_t i = 0; i < BindingVersionTable::RangeCount; i++)
+		{
+			slots[i] |= attached.group->GetSlots()[i];
+		}
+	}
+
+	// Groups sharing one layout leave the pipeline state bindings alone, only the new group binds on the next commit.
+	// If the excluded slots changed, the pipeline state has to resubmit its ranges on the next draw or dispatch.
+	if (!std::equal(std::begin(slots), std::end(slots), std::begin(groupSlots)))
+	{
+		std::copy(std::begin(slots), std::end(slots), std::begin(groupSlots));
+		graphicsBindings.Invalidate();
+		computeBindings.Invalidate();
+	}
+}
+
+void D3D11CommandList::SetVertexBuffer(const uint32_t slot, Buffer* buffer, const uint32_t stride, const uint32_t offset)
+{
+	ID3D11Buffer* d3dBuffer = buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr;
+	if (stateCache.SetVertexBuffer(slot, d3dBuffer, stride, offset))
+	{
+		context->IASetVertexBuffers(slot, 1, &d3dBuffer, &stride, &offset);
+	}
 }
 
 void D3D11CommandList::SetIndexBuffer(Buffer* buffer, const Format format, const uint32_t offset)
 {
 	const DXGI_FORMAT dxgiFormat = ConvertFormat(format);
-	
-	if (!buffer)
+	ID3D11Buffer* d3dBuffer = buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr;
+	if (stateCache.SetIndexBuffer(d3dBuffer, dxgiFormat, offset))
 	{
-		context->IASetIndexBuffer(nullptr, dxgiFormat, offset);
-		return;
+		context->IASetIndexBuffer(d3dBuffer, dxgiFormat, offset);
 	}
-
-	const auto d3dBuffer = static_cast<D3D11Buffer*>(buffer);
-	context->IASetIndexBuffer(d3dBuffer->GetBuffer(), dxgiFormat, offset);
 }
 
 void D3D11CommandList::SetRenderTarget(RenderTargetView* rtv, DepthStencilView* dsv)
@@ -267,7 +611,15 @@ void D3D11CommandList::SetRenderTarget(RenderTargetView* rtv, DepthStencilView*
 		d3dDsv = d3d11Dsv->GetView();
 	}
 
+	// An unchanged output merger cannot have unbound any input, so the binding trackers stay valid as well.
+	const void* views[] = { d3dRtv };
+	if (!stateCache.SetRenderTargets(1, views, d3dDsv))
+	{
+		return;
+	}
+
 	context->OMSetRenderTargets(1, &d3dRtv, d3dDsv);
+	InvalidateBindings();
 }
 
 void D3D11CommandList::SetRenderTargetsAndUnorderedAccessViews(
@@ -311,10 +663,17 @@ void D3D11CommandList::SetRenderTargetsAndUnorderedAccessViews(
 	}
 
 	context->OMSetRenderTargetsAndUnorderedAccessViews(count, d3dRtvs, d3dDsv, uavSlot, uavCount, d3dUavs, pUavInitialCount);
+	stateCache.InvalidateRenderTargets();
+	InvalidateBindings();
 }
 
 void D3D11CommandList::SetViewport(const Viewport& viewport)
 {
+	if (!stateCache.SetViewports(1, &viewport))
+	{
+		return;
+	}
+
 	D3D11_VIEWPORT vp;
 	vp.TopLeftX = viewport.x;
 	vp.TopLeftY = viewport.y;
@@ -327,6 +686,11 @@ void D3D11CommandList::SetViewport(const Viewport& viewport)
 
 void D3D11CommandList::SetViewports(const uint32_t viewportCount, const Viewport* viewports)
 {
+	if (!stateCache.SetViewports(viewportCount, viewports))
+	{
+		return;
+	}
+
 	D3D11_VIEWPORT vps[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
 
 	for (uint32_t i = 0; i < viewportCount; i++)
@@ -343,6 +707,11 @@ void D3D11CommandList::SetViewports(const uint32_t viewportCount, const Viewport
 
 void D3D11CommandList::SetScissorRects(const Rect* rects, const uint32_t rectCount)
 {
+	if (!stateCache.SetScissorRects(rectCount, rects))
+	{
+		return;
+	}
+
 	D3D11_RECT d3dRects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
 	for (size_t i = 0; i < rectCount; ++i)
 	{
@@ -357,38 +726,185 @@ void D3D11CommandList::SetScissorRects(const Rect* rects, const uint32_t rectCou
 
 void D3D11CommandList::SetPrimitiveTopology(PrimitiveTopology topology)
 {
+	if (!stateCache.SetTopology(static_cast<uint32_t>(topology)))
+	{
+		return;
+	}
+
 	context->IASetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(topology));
 }
 
 void D3D11CommandList::DrawInstanced(const uint32_t vertexCount, const uint32_t instanceCount, const uint32_t vertexOffset, const uint32_t instanceOffset)
 {
+	CommitGraphicsBindings();
 	context->DrawInstanced(vertexCount, instanceCount, vertexOffset, instanceOffset);
 }
 
 void D3D11CommandList::DrawIndexedInstanced(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t indexOffset, const int32_t vertexOffset, const uint32_t instanceOffset)
 {
+	CommitGraphicsBindings();
 	context->DrawIndexedInstanced(indexCount, instanceCount, indexOffset, vertexOffset, instanceOffset);
 }
 
 void D3D11CommandList::DrawIndexedInstancedIndirect(Buffer* bufferForArgs, const uint32_t alignedByteOffsetForArgs)
 {
+	CommitGraphicsBindings();
 	const auto d3dBuffer = static_cast<D3D11Buffer*>(bufferForArgs);
 	context->DrawIndexedInstancedIndirect(d3dBuffer->GetBuffer(), alignedByteOffsetForArgs);
 }
 
 void D3D11CommandList::DrawInstancedIndirect(Buffer* bufferForArgs, const uint32_t alignedByteOffsetForArgs)
 {
+	CommitGraphicsBindings();
 	const auto d3dBuffer = static_cast<D3D11Buffer*>(bufferForArgs);
 	context->DrawInstancedIndirect(d3dBuffer->GetBuffer(), alignedByteOffsetForArgs);
 }
 
+uint32_t D3D11CommandList::ResolveDrawCount(uint32_t maxCount, Buffer* countBuffer, uint32_t countOffset, MultiDrawFlags flags)
+{
+	// D3D11 has no count buffer draws. By default all records are drawn and the ones past the count are expected to
+	// hold zero instances, reading the count would stall the CPU on the GPU in the middle of recording.
+	if (!countBuffer || (static_cast<uint32_t>(flags) & static_cast<uint32_t>(MultiDrawFlags::ReadCountOnCpu)) == 0)
+	{
+		return maxCount;
+	}
+
+	// Opted in: CPU readable counts are read directly, GPU written counts are copied into a small staging buffer
+	// first, both map for reading and wait until the GPU produced the value.
+	if (type == CommandListType::Deferred)
+	{
+		throw std::runtime_error("Draw count buffers can only be read on the immediate context.");
+	}
+
+	auto d3dBuffer = static_cast<D3D11Buffer*>(countBuffer);
+	ID3D11Buffer* source = d3dBuffer->GetBuffer();
+	uint32_t readOffset = countOffset;
+
+	if ((static_cast<uint32_t>(countBuffer->GetDesc().cpuAccessFlags) & static_cast<uint32_t>(CpuAccessFlags::Read)) == 0)
+	{
+		if (!drawCountReadback)
+		{
+			ComPtr<ID3D11Device> device;
+			context->GetDevice(&device);
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = 16;
+			desc.Usage = D3D11_USAGE_STAGING;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+			if (FAILED(device->CreateBuffer(&desc, nullptr, &drawCountReadback)))
+			{
+				throw std::runtime_error("Failed to create the draw count readback buffer.");
+			}
+		}
+
+		D3D11_BOX box = { countOffset, 0, 0, countOffset + static_cast<UINT>(sizeof(uint32_t)), 1, 1 };
+		context->CopySubresourceRegion(drawCountReadback.Get(), 0, 0, 0, 0, source, 0, &box);
+		source = drawCountReadback.Get();
+		readOffset = 0;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	if (FAILED(context->Map(source, 0, D3D11_MAP_READ, 0, &mapped)))
+	{
+		throw std::runtime_error("Failed to read the draw count buffer.");
+	}
+
+	uint32_t count;
+	memcpy(&count, static_cast<const uint8_t*>(mapped.pData) + readOffset, sizeof(count));
+	context->Unmap(source, 0);
+	return std::min(count, maxCount);
+}
+
+void D3D11CommandList::MultiDrawIndexedIndirect(Buffer* argsBuffer, const uint32_t maxCount, const uint32_t stride, Buffer* countBuffer, const uint32_t argsOffset, const uint32_t countOffset, const MultiDrawFlags flags)
+{
+	const uint32_t count = ResolveDrawCount(maxCount, countBuffer, countOffset, flags);
+	if (count == 0)
+	{
+		return;
+	}
+
+	CommitGraphicsBindings();
+	ID3D11Buffer* d3dBuffer = static_cast<D3D11Buffer*>(argsBuffer)->GetBuffer();
+	for (uint32_t i = 0, offset = argsOffset; i < count; i++, offset += stride)
+	{
+		context->DrawIndexedInstancedIndirect(d3dBuffer, offset);
+	}
+}
+
+void D3D11CommandList::MultiDrawIndirect(Buffer* argsBuffer, const uint32_t maxCount, const uint32_t stride, Buffer* countBuffer, const uint32_t argsOffset, const uint32_t countOffset, const MultiDrawFlags flags)
+{
+	const uint32_t count = ResolveDrawCount(maxCount, countBuffer, countOffset, flags);
+	if (count == 0)
+	{
+		return;
+	}
+
+	CommitGraphicsBindings();
+	ID3D11Buffer* d3dBuffer = static_cast<D3D11Buffer*>(argsBuffer)->GetBuffer();
+	for (uint32_t i = 0, offset = argsOffset; i < count; i++, offset += stride)
+	{
+		context->DrawInstancedIndirect(d3dBuffer, offset);
+	}
+}
+
+void D3D11CommandList::SubmitDraws(const DrawBatch& batch)
+{
+	if (batch.count != 0 && !batch.counts)
+	{
+		throw std::invalid_argument("Draw batch requires counts");
+	}
+
+	if (batch.bindingGroups && batch.bindingGroupIndex >= BindingGroup::MaxAttachedGroups)
+	{
+		throw std::invalid_argument("Draw batch binding group index out of range");
+	}
+
+	// The class is final, so the setters below are direct calls. Their state cache drops whatever repeats.
+	for (uint32_t i = 0; i < batch.count; i++)
+	{
+		if (batch.pipelineStates && batch.pipelineStates[i] != graphicsPSO)
+		{
+			SetGraphicsPipelineState(batch.pipelineStates[i]);
+		}
+
+		if (batch.bindingGroups && batch.bindingGroups[i] != bindingGroups[batch.bindingGroupIndex].group)
+		{
+			SetBindingGroup(batch.bindingGroupIndex, batch.bindingGroups[i]);
+		}
+
+		if (batch.vertexBuffers)
+		{
+			SetVertexBuffer(0, batch.vertexBuffers[i], batch.vertexStrides ? batch.vertexStrides[i] : 0, batch.vertexOffsets ? batch.vertexOffsets[i] : 0);
+		}
+
+		const uint32_t instanceCount = batch.instanceCounts ? batch.instanceCounts[i] : 1;
+		const uint32_t firstElement = batch.firstElements ? batch.firstElements[i] : 0;
+		const uint32_t firstInstance = batch.firstInstances ? batch.firstInstances[i] : 0;
+
+		CommitGraphicsBindings();
+
+		Buffer* indexBuffer = batch.indexBuffers ? batch.indexBuffers[i] : nullptr;
+		if (indexBuffer)
+		{
+			SetIndexBuffer(indexBuffer, batch.indexFormat, 0);
+			context->DrawIndexedInstanced(batch.counts[i], instanceCount, firstElement, batch.baseVertices ? batch.baseVertices[i] : 0, firstInstance);
+		}
+		else
+		{
+			context->DrawInstanced(batch.counts[i], instanceCount, firstElement, firstInstance);
+		}
+	}
+}
+
 void D3D11CommandList::Dispatch(const uint32_t threadGroupCountX, const uint32_t threadGroupCountY, const uint32_t threadGroupCountZ)
 {
+	CommitComputeBindings();
 	context->Dispatch(threadGroupCountX, threadGroupCountY, threadGroupCountZ);
 }
 
 void D3D11CommandList::DispatchIndirect(Buffer* dispatchArgs, const uint32_t offset)
 {
+	CommitComputeBindings();
 	const auto d3dBuffer = static_cast<D3D11Buffer*>(dispatchArgs);
 	context->DispatchIndirect(d3dBuffer->GetBuffer(), offset);
 }
@@ -397,6 +913,156 @@ void D3D11CommandList::ExecuteCommandList(CommandList* commandList)
 {
 	const auto cmdList = static_cast<D3D11CommandList*>(commandList);
 	context->ExecuteCommandList(cmdList->commandList.Get(), FALSE);
+	graphicsPSO = nullptr;
+	computePSO = nullptr;
+	InvalidateBindings();
+	stateCache.Invalidate();
+	// The executed list may have uploaded an older version of a reflected constant buffer.
+	variableUploads.Invalidate();
+}
+
+// Applies the translated commands directly. State calls go through the state cache and draws commit the bindings
+// first, exactly as the setters do. The class is final, so the member calls below are not virtual.
+void D3D11CommandList::ExecuteBundle(NativeCommandBundle* bundle)
+{
+	const auto d3dBundle = static_cast<D3D11NativeBundle*>(bundle);
+	for (const auto& command : d3dBundle->commands)
+	{
+		switch (command.op)
+		{
+		case CommandOp::SetGraphicsPipelineState:
+			SetGraphicsPipelineState(command.graphicsState);
+			break;
+		case CommandOp::SetComputePipelineState:
+			SetComputePipelineState(command.computeState);
+			break;
+		case CommandOp::SetBindingSet:
+			bindingSet = command.bindingSet;
+			break;
+		case CommandOp::SetBindingGroup:
+			SetBindingGroup(command.bindingGroup.index, command.bindingGroup.group);
+			break;
+		case CommandOp::SetVertexBuffer:
+		{
+			const auto& c = command.vertexBuffer;
+			if (stateCache.SetVertexBuffer(c.slot, c.buffer, c.stride, c.offset))
+			{
+				context->IASetVertexBuffers(c.slot, 1, &c.buffer, &c.stride, &c.offset);
+			}
+			break;
+		}
+		case CommandOp::SetIndexBuffer:
+		{
+			const auto& c = command.indexBuffer;
+			if (stateCache.SetIndexBuffer(c.buffer, c.format, c.offset))
+			{
+				context->IASetIndexBuffer(c.buffer, c.format, c.offset);
+			}
+			break;
+		}
+		case CommandOp::SetRenderTarget:
+		{
+			const auto& c = command.renderTarget;
+			const void* views[] = { c.rtv };
+			if (stateCache.SetRenderTargets(1, views, c.dsv))
+			{
+				context->OMSetRenderTargets(1, &c.rtv, c.dsv);
+				InvalidateBindings();
+			}
+			break;
+		}
+		case CommandOp::SetViewports:
+		{
+			const auto& c = command.range;
+			if (stateCache.SetViewports(c.count, d3dBundle->viewports.data() + c.first))
+			{
+				context->RSSetViewports(c.count, d3dBundle->d3dViewports.data() + c.first);
+			}
+			break;
+		}
+		case CommandOp::SetScissorRects:
+		{
+			const auto& c = command.range;
+			if (stateCache.SetScissorRects(c.count, d3dBundle->scissorRects.data() + c.first))
+			{
+				context->RSSetScissorRects(c.count, d3dBundle->d3dScissorRects.data() + c.first);
+			}
+			break;
+		}
+		case CommandOp::SetPrimitiveTopology:
+			if (stateCache.SetTopology(static_cast<uint32_t>(command.topology)))
+			{
+				context->IASetPrimitiveTopology(command.topology);
+			}
+			break;
+		case CommandOp::SetPushConstants:
+		{
+			const auto& c = command.pushConstants;
+			SetPushConstants(c.stages, c.offset, c.size, c.data);
+			break;
+		}
+		case CommandOp::DrawInstanced:
+		{
+			const auto& c = command.draw;
+			CommitGraphicsBindings();
+			context->DrawInstanced(c.vertexCount, c.instanceCount, c.vertexOffset, c.instanceOffset);
+			break;
+		}
+		case CommandOp::DrawIndexedInstanced:
+		{
+			const auto& c = command.drawIndexed;
+			CommitGraphicsBindings();
+			context->DrawIndexedInstanced(c.indexCount, c.instanceCount, c.indexOffset, c.vertexOffset, c.instanceOffset);
+			break;
+		}
+		case CommandOp::DrawInstancedIndirect:
+			CommitGraphicsBindings();
+			context->DrawInstancedIndirect(command.indirect.args, command.indirect.offset);
+			break;
+		case CommandOp::DrawIndexedInstancedIndirect:
+			CommitGraphicsBindings();
+			context->DrawIndexedInstancedIndirect(command.indirect.args, command.indirect.offset);
+			break;
+		case CommandOp::Dispatch:
+		{
+			const auto& c = command.dispatch;
+			CommitComputeBindings();
+			context->Dispatch(c.x, c.y, c.z);
+			break;
+		}
+		case CommandOp::DispatchIndirect:
+			CommitComputeBindings();
+			context->DispatchIndirect(command.indirect.args, command.indirect.offset);
+			break;
+		case CommandOp::ClearRenderTargetView:
+			context->ClearRenderTargetView(command.clearRenderTarget.rtv, command.clearRenderTarget.color);
+			break;
+		case CommandOp::ClearDepthStencilView:
+		{
+			const auto& c = command.clearDepthStencil;
+			context->ClearDepthStencilView(c.dsv, c.flags, c.depth, c.stencil);
+			break;
+		}
+		case CommandOp::ClearUnorderedAccessViewUint:
+			context->ClearUnorderedAccessViewUint(command.clearUnorderedAccess.uav, command.clearUnorderedAccess.values);
+			break;
+		case CommandOp::CopyResource:
+			context->CopyResource(command.copy.dst, command.copy.src);
+			break;
+		case CommandOp::CopySubresourceRegion:
+		{
+			const auto& r = d3dBundle->copyRegions[command.index];
+			context->CopySubresourceRegion1(r.dst, r.dstSubresource, r.dstX, r.dstY, r.dstZ, r.src, r.srcSubresource, r.hasBox ? &r.box : nullptr, r.flags);
+			break;
+		}
+		case CommandOp::BeginEvent:
+			context->BeginEventInt(d3dBundle->eventNames[command.index].c_str(), 0);
+			break;
+		case CommandOp::EndEvent:
+			context->EndEvent();
+			break;
+		}
+	}
 }
 
 void D3D11CommandList::ClearRenderTargetView(RenderTargetView* rtv, const Color& color)
@@ -408,14 +1074,8 @@ void D3D11CommandList::ClearRenderTargetView(RenderTargetView* rtv, const Color&
 
 void D3D11CommandList::ClearDepthStencilView(DepthStencilView* dsv, const DepthStencilViewClearFlags flags, const float depth, const char stencil)
 {
-	UINT clearFlags = 0;
-	if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(DepthStencilViewClearFlags::Depth)) != 0)
-		clearFlags |= D3D11_CLEAR_DEPTH;
-	if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(DepthStencilViewClearFlags::Stencil)) != 0)
-		clearFlags |= D3D11_CLEAR_STENCIL;
-
 	const auto d3d11Dsv = static_cast<ID3D11DepthStencilView*>(dsv->GetNativePointer());
-	context->ClearDepthStencilView(d3d11Dsv, clearFlags, depth, static_cast<UINT8>(stencil));
+	context->ClearDepthStencilView(d3d11Dsv, ConvertClearFlags(flags), depth, static_cast<UINT8>(stencil));
 }
 
 void D3D11CommandList::ClearUnorderedAccessViewUint(UnorderedAccessView* uav, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
@@ -443,14 +1103,117 @@ void D3D11CommandList::CopyResource(Resource* dstResource, Resource* srcResource
 	context->CopyResource(static_cast<ID3D11Resource*>(dstResource->GetNativePointer()), static_cast<ID3D11Resource*>(srcResource->GetNativePointer()));
 }
 
+void D3D11CommandList::CopySubresourceRegion(Resource* dstResource, const uint32_t dstSubresource, const uint32_t dstX, const uint32_t dstY, const uint32_t dstZ, Resource* srcResource, const uint32_t srcSubresource, const Box* srcBox, const CopyFlags flags)
+{
+	D3D11_BOX box;
+	if (srcBox)
+	{
+		box = { srcBox->left, srcBox->top, srcBox->front, srcBox->right, srcBox->bottom, srcBox->back };
+	}
+
+	context->CopySubresourceRegion1(static_cast<ID3D11Resource*>(dstResource->GetNativePointer()), dstSubresource, dstX, dstY, dstZ,
+		static_cast<ID3D11Resource*>(srcResource->GetNativePointer()), srcSubresource, srcBox ? &box : nullptr, ConvertCopyFlags(flags));
+}
+
+// Moves the source pointer back by the box origin, so the runtime's offset lands on the data again. See "Calling
+// UpdateSubresource on a deferred context" in the ID3D11DeviceContext::UpdateSubresource documentation.
+const void* D3D11CommandList::AdjustUpdateSource(ID3D11Resource* resource, const D3D11_BOX& box, const void* data, uint32_t rowPitch, uint32_t depthPitch)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	resource->GetType(&dimension);
+
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	switch (dimension)
+	{
+	case D3D11_RESOURCE_DIMENSION_BUFFER:
+		return static_cast<const uint8_t*>(data) - box.left;
+	case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+	{
+		D3D11_TEXTURE1D_DESC desc;
+		static_cast<ID3D11Texture1D*>(resource)->GetDesc(&desc);
+		format = desc.Format;
+		break;
+	}
+	case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+	{
+		D3D11_TEXTURE2D_DESC desc;
+		static_cast<ID3D11Texture2D*>(resource)->GetDesc(&desc);
+		format = desc.Format;
+		break;
+	}
+	case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+	{
+		D3D11_TEXTURE3D_DESC desc;
+		static_cast<ID3D11Texture3D*>(resource)->GetDesc(&desc);
+		format = desc.Format;
+		break;
+	}
+	default:
+		break;
+	}
+
+	uint32_t bytes;
+	uint32_t blockSize;
+	if (!GetFormatBlock(format, bytes, blockSize))
+	{
+		throw std::invalid_argument("Format does not support boxed updates on deferred contexts of this driver");
+	}
+
+	const size_t offset = static_cast<size_t>(box.front) * depthPitch + static_cast<size_t>(box.top / blockSize) * rowPitch
+		+ static_cast<size_t>(box.left / blockSize) * bytes;
+	return static_cast<const uint8_t*>(data) - offset;
+}
+
+void D3D11CommandList::UpdateSubresource(Resource* dstResource, const uint32_t dstSubresource, const Box* dstBox, const void* data, const uint32_t rowPitch, const uint32_t depthPitch, const CopyFlags flags)
+{
+	const auto resource = static_cast<ID3D11Resource*>(dstResource->GetNativePointer());
+	D3D11_BOX box;
+	if (dstBox)
+	{
+		box = { dstBox->left, dstBox->top, dstBox->front, dstBox->right, dstBox->bottom, dstBox->back };
+		if (offsetUpdateSource)
+		{
+			data = AdjustUpdateSource(resource, box, data, rowPitch, depthPitch);
+		}
+	}
+
+	context->UpdateSubresource1(resource, dstSubresource, dstBox ? &box : nullptr, data, rowPitch, depthPitch, ConvertCopyFlags(flags));
+}
+
 void D3D11CommandList::GenerateMips(ShaderResourceView* srv)
 {
 	context->GenerateMips(static_cast<ID3D11ShaderResourceView*>(srv->GetNativePointer()));
 }
 
+void D3D11CommandList::UnbindShaderResources()
+{
+	static ID3D11ShaderResourceView* const nullSrvs[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {};
+	static ID3D11UnorderedAccessView* const nullUavs[D3D11_1_UAV_SLOT_COUNT] = {};
+
+	context->VSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->HSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->DSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->GSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->PSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->CSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullSrvs);
+	context->CSSetUnorderedAccessViews(0, D3D11_1_UAV_SLOT_COUNT, nullUavs, nullptr);
+
+	// The trackers of the list and of every attached group believe the slots are still bound.
+	InvalidateBindings();
+}
+
 void D3D11CommandList::ClearState()
 {
 	context->ClearState();
+	stateCache.Invalidate();
+	graphicsPSO = nullptr;
+	computePSO = nullptr;
+	bindingSet = nullptr;
+	for (uint32_t i = 0; i < BindingGroup::MaxAttachedGroups; i++)
+	{
+		SetBindingGroup(i, nullptr);
+	}
+	InvalidateBindings();
 }
 
 void D3D11CommandList::Flush()
@@ -561,6 +1324,21 @@ bool D3D11CommandList::QueryGetData(Query* query, void* data, uint32_t size, Que
 	return true;
 }
 
+void D3D11CommandList::Signal(Fence* fence, const uint64_t value)
+{
+	if (type != CommandListType::Immediate)
+	{
+		throw std::runtime_error("Fences can only be signaled on the immediate context.");
+	}
+
+	const auto d3dFence = static_cast<D3D11Fence*>(fence);
+	const auto hr = context->Signal(d3dFence->GetFence(), value);
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed to signal fence.");
+	}
+}
+
 void D3D11CommandList::BeginEvent(const char* name)
 {
 	if (!name)
@@ -599,6 +1377,243 @@ void D3D11CommandList::EndEvent()
 	context->EndEvent();
 }
 
+TransientConstants D3D11CommandList::WriteConstants(const void* data, uint32_t size)
+{
+	if (!constantRing)
+	{
+		ComPtr<ID3D11Device> device;
+		context->GetDevice(&device);
+		// The immediate list never begins, keeping every range alive would grow without bound.
+		constantRing = std::make_unique<D3D11ConstantRing>(device.Get(), type != CommandListType::Immediate);
+	}
+
+	return constantRing->Write(context.Get(), data, size);
+}
+
+void D3D11CommandList::SetPushConstants(ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data)
+{
+	if (offset > MaxPushConstantsSize || size > MaxPushConstantsSize - offset)
+	{
+		throw std::runtime_error("Push constants exceed MaxPushConstantsSize.");
+	}
+
+	memcpy(pushConstants.data + offset, data, size);
+	pushConstants.size = std::max(pushConstants.size, offset + size);
+	pushConstants.dirtyStages |= static_cast<uint32_t>(stages);
+	pushConstants.range = {};
+}
+
+// D3D11NativeBundle Implementation
+
+D3D11NativeBundle::D3D11NativeBundle(const CommandStream& stream)
+{
+	commands.reserve(stream.GetPacketCount());
+	stream.ForEachPacket([this](const CommandPacket* packet)
+	{
+		Translate(commands.emplace_back(), packet, true);
+	});
+}
+
+void D3D11NativeBundle::Update(const uint32_t index, const CommandPacket* packet)
+{
+	if (index >= commands.size() || commands[index].op != packet->op)
+	{
+		throw std::invalid_argument("Packet does not belong to the bundle");
+	}
+
+	Translate(commands[index], packet, false);
+}
+
+void D3D11NativeBundle::Translate(Command& command, const CommandPacket* packet, const bool added)
+{
+	auto toBuffer = [](Buffer* buffer) { return buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr; };
+	auto toResource = [](Resource* resource) { return static_cast<ID3D11Resource*>(resource->GetNativePointer()); };
+
+	// A packet translated again keeps its entries in the side arrays, its count cannot change.
+	auto reserveRange = [&command, added](auto& values, auto& nativeValues, uint32_t count)
+	{
+		if (added)
+		{
+			command.range = { static_cast<uint32_t>(values.size()), count };
+			values.resize(values.size() + count);
+			nativeValues.resize(nativeValues.size() + count);
+		}
+		else if (command.range.count != count)
+		{
+			throw std::invalid_argument("Patched packet changed its element count");
+		}
+		return command.range.first;
+	};
+
+	auto reserveIndex = [&command, added](auto& values)
+	{
+		if (added)
+		{
+			command.index = static_cast<uint32_t>(values.size());
+			values.emplace_back();
+		}
+		return command.index;
+	};
+
+	command.op = packet->op;
+	switch (packet->op)
+	{
+	case CommandOp::SetGraphicsPipelineState:
+		command.graphicsState = static_cast<D3D11GraphicsPipelineState*>(static_cast<const SetGraphicsPipelineStatePacket*>(packet)->state);
+		break;
+	case CommandOp::SetComputePipelineState:
+		command.computeState = static_cast<D3D11ComputePipelineState*>(static_cast<const SetComputePipelineStatePacket*>(packet)->state);
+		break;
+	case CommandOp::SetBindingSet:
+		command.bindingSet = static_cast<D3D11BindingSet*>(static_cast<const SetBindingSetPacket*>(packet)->bindingSet);
+		break;
+	case CommandOp::SetBindingGroup:
+	{
+		const auto& p = *static_cast<const SetBindingGroupPacket*>(packet);
+		if (p.index >= BindingGroup::MaxAttachedGroups)
+		{
+			throw std::runtime_error("Binding group index out of range.");
+		}
+		command.bindingGroup = { p.index, static_cast<D3D11BindingGroup*>(p.group) };
+		break;
+	}
+	case CommandOp::SetVertexBuffer:
+	{
+		const auto& p = *static_cast<const SetVertexBufferPacket*>(packet);
+		command.vertexBuffer = { p.slot, p.stride, p.offset, toBuffer(p.buffer) };
+		break;
+	}
+	case CommandOp::SetIndexBuffer:
+	{
+		const auto& p = *static_cast<const SetIndexBufferPacket*>(packet);
+		command.indexBuffer = { ConvertFormat(p.format), p.offset, toBuffer(p.buffer) };
+		break;
+	}
+	case CommandOp::SetRenderTarget:
+	{
+		const auto& p = *static_cast<const SetRenderTargetPacket*>(packet);
+		command.renderTarget.rtv = p.rtv ? static_cast<D3D11RenderTargetView*>(p.rtv)->GetView() : nullptr;
+		command.renderTarget.dsv = p.dsv ? static_cast<D3D11DepthStencilView*>(p.dsv)->GetView() : nullptr;
+		break;
+	}
+	case CommandOp::SetViewports:
+	{
+		const auto& p = *static_cast<const SetViewportsPacket*>(packet);
+		const auto source = reinterpret_cast<const Viewport*>(&p + 1);
+		const uint32_t first = reserveRange(viewports, d3dViewports, p.count);
+		for (uint32_t i = 0; i < p.count; i++)
+		{
+			const Viewport& viewport = source[i];
+			viewports[first + i] = viewport;
+			d3dViewports[first + i] = { viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+		}
+		break;
+	}
+	case CommandOp::SetScissorRects:
+	{
+		const auto& p = *static_cast<const SetScissorRectsPacket*>(packet);
+		const auto source = reinterpret_cast<const Rect*>(&p + 1);
+		const uint32_t first = reserveRange(scissorRects, d3dScissorRects, p.count);
+		for (uint32_t i = 0; i < p.count; i++)
+		{
+			const Rect& rect = source[i];
+			scissorRects[first + i] = rect;
+			D3D11_RECT& d3dRect = d3dScissorRects[first + i];
+			d3dRect.left = rect.left;
+			d3dRect.top = rect.top;
+			d3dRect.right = rect.right;
+			d3dRect.bottom = rect.bottom;
+		}
+		break;
+	}
+	case CommandOp::SetPrimitiveTopology:
+		command.topology = static_cast<D3D11_PRIMITIVE_TOPOLOGY>(static_cast<const SetPrimitiveTopologyPacket*>(packet)->topology);
+		break;
+	case CommandOp::SetPushConstants:
+	{
+		const auto& p = *static_cast<const SetPushConstantsPacket*>(packet);
+		command.pushConstants = { p.stages, p.offset, p.size, &p + 1 };
+		break;
+	}
+	case CommandOp::DrawInstanced:
+	{
+		const auto& p = *static_cast<const DrawInstancedPacket*>(packet);
+		command.draw = { p.vertexCount, p.instanceCount, p.vertexOffset, p.instanceOffset };
+		break;
+	}
+	case CommandOp::DrawIndexedInstanced:
+	{
+		const auto& p = *static_cast<const DrawIndexedInstancedPacket*>(packet);
+		command.drawIndexed = { p.indexCount, p.instanceCount, p.indexOffset, p.vertexOffset, p.instanceOffset };
+		break;
+	}
+	case CommandOp::DrawInstancedIndirect:
+	case CommandOp::DrawIndexedInstancedIndirect:
+	{
+		const auto& p = *static_cast<const DrawIndirectPacket*>(packet);
+		command.indirect = { p.offset, toBuffer(p.args) };
+		break;
+	}
+	case CommandOp::Dispatch:
+	{
+		const auto& p = *static_cast<const DispatchPacket*>(packet);
+		command.dispatch = { p.x, p.y, p.z };
+		break;
+	}
+	case CommandOp::DispatchIndirect:
+	{
+		const auto& p = *static_cast<const DispatchIndirectPacket*>(packet);
+		command.indirect = { p.offset, toBuffer(p.args) };
+		break;
+	}
+	case CommandOp::ClearRenderTargetView:
+	{
+		const auto& p = *static_cast<const ClearRenderTargetViewPacket*>(packet);
+		command.clearRenderTarget = { { p.color.r, p.color.g, p.color.b, p.color.a }, static_cast<D3D11RenderTargetView*>(p.rtv)->GetView() };
+		break;
+	}
+	case CommandOp::ClearDepthStencilView:
+	{
+		const auto& p = *static_cast<const ClearDepthStencilViewPacket*>(packet);
+		command.clearDepthStencil = { ConvertClearFlags(p.flags), static_cast<UINT8>(p.stencil), p.depth, static_cast<ID3D11DepthStencilView*>(p.dsv->GetNativePointer()) };
+		break;
+	}
+	case CommandOp::ClearUnorderedAccessViewUint:
+	{
+		const auto& p = *static_cast<const ClearUnorderedAccessViewUintPacket*>(packet);
+		command.clearUnorderedAccess = { { p.values[0], p.values[1], p.values[2], p.values[3] }, static_cast<ID3D11UnorderedAccessView*>(p.uav->GetNativePointer()) };
+		break;
+	}
+	case CommandOp::CopyResource:
+	{
+		const auto& p = *static_cast<const CopyResourcePacket*>(packet);
+		command.copy = { toResource(p.dst), toResource(p.src) };
+		break;
+	}
+	case CommandOp::CopySubresourceRegion:
+	{
+		const auto& p = *static_cast<const CopySubresourceRegionPacket*>(packet);
+		CopyRegion& region = copyRegions[reserveIndex(copyRegions)];
+		region.dst = toResource(p.dst);
+		region.src = toResource(p.src);
+		region.dstSubresource = p.dstSubresource;
+		region.dstX = p.dstX;
+		region.dstY = p.dstY;
+		region.dstZ = p.dstZ;
+		region.srcSubresource = p.srcSubresource;
+		region.flags = ConvertCopyFlags(p.flags);
+		region.hasBox = p.hasBox;
+		region.box = { p.box.left, p.box.top, p.box.front, p.box.right, p.box.bottom, p.box.back };
+		break;
+	}
+	case CommandOp::BeginEvent:
+		eventNames[reserveIndex(eventNames)] = ToWideString(reinterpret_cast<const char*>(static_cast<const BeginEventPacket*>(packet) + 1));
+		break;
+	case CommandOp::EndEvent:
+		break;
+	}
+}
+
 // D3D11GraphicsDevice Implementation
 
 bool D3D11GraphicsDevice::Initialize()
@@ -715,6 +1730,11 @@ PrismObj<Buffer> D3D11GraphicsDevice::CreateBuffer(const BufferDesc& desc, const
 		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 		bufferDesc.BindFlags |= ConvertBindFlags(desc.gpuAccessFlags);
 		break;
+
+	case BufferType::IndirectArgs:
+		bufferDesc.BindFlags = ConvertBindFlags(desc.gpuAccessFlags);
+		bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+		break;
 	
 	default:
 		bufferDesc.BindFlags = ConvertBindFlags(desc.gpuAccessFlags);
@@ -741,7 +1761,7 @@ PrismObj<Buffer> D3D11GraphicsDevice::CreateBuffer(const BufferDesc& desc, const
 	return MakePrismObj<D3D11Buffer>(desc, std::move(d3dBuffer));
 }
 
-PrismObj<Texture1D> D3D11GraphicsDevice::CreateTexture1D(const Texture1DDesc& desc)
+PrismObj<Texture1D> D3D11GraphicsDevice::CreateTexture1D(const Texture1DDesc& desc, const SubresourceData* initialData)
 {
 	D3D11_TEXTURE1D_DESC texDesc = {};
 	texDesc.Width = desc.width;
@@ -753,8 +1773,12 @@ PrismObj<Texture1D> D3D11GraphicsDevice::CreateTexture1D(const Texture1DDesc& de
 	texDesc.CPUAccessFlags = ConvertCpuAccessFlags(desc.cpuAccessFlags);
 	texDesc.MiscFlags = ConvertResourceMiscFlags(desc.miscFlags);
 
+	// A mip count of zero asks for the full chain.
+	const uint32_t subresourceCount = (desc.mipLevels ? desc.mipLevels : MipChainLength(desc.width, 1, 1)) * desc.arraySize;
+	std::vector<D3D11_SUBRESOURCE_DATA> subresourceData;
+
 	ComPtr<ID3D11Texture1D> d3dTexture;
-	const HRESULT hr = device->CreateTexture1D(&texDesc, nullptr, &d3dTexture);
+	const HRESULT hr = device->CreateTexture1D(&texDesc, ConvertInitialData(initialData, subresourceCount, subresourceData), &d3dTexture);
 	if (FAILED(hr))
 	{
 		return {};
@@ -763,7 +1787,7 @@ PrismObj<Texture1D> D3D11GraphicsDevice::CreateTexture1D(const Texture1DDesc& de
 	return MakePrismObj<D3D11Texture1D>(desc, std::move(d3dTexture));
 }
 
-PrismObj<Texture2D> D3D11GraphicsDevice::CreateTexture2D(const Texture2DDesc& desc)
+PrismObj<Texture2D> D3D11GraphicsDevice::CreateTexture2D(const Texture2DDesc& desc, const SubresourceData* initialData)
 {
 	D3D11_TEXTURE2D_DESC texDesc = {};
 	texDesc.Width = desc.width;
@@ -778,8 +1802,11 @@ PrismObj<Texture2D> D3D11GraphicsDevice::CreateTexture2D(const Texture2DDesc& de
 	texDesc.CPUAccessFlags = ConvertCpuAccessFlags(desc.cpuAccessFlags);
 	texDesc.MiscFlags = ConvertResourceMiscFlags(desc.miscFlags);
 
+	const uint32_t subresourceCount = (desc.mipLevels ? desc.mipLevels : MipChainLength(desc.width, desc.height, 1)) * desc.arraySize;
+	std::vector<D3D11_SUBRESOURCE_DATA> subresourceData;
+
 	ComPtr<ID3D11Texture2D> d3dTexture;
-	const HRESULT hr = device->CreateTexture2D(&texDesc, nullptr, &d3dTexture);
+	const HRESULT hr = device->CreateTexture2D(&texDesc, ConvertInitialData(initialData, subresourceCount, subresourceData), &d3dTexture);
 	if (FAILED(hr))
 	{
 		return {};
@@ -788,7 +1815,7 @@ PrismObj<Texture2D> D3D11GraphicsDevice::CreateTexture2D(const Texture2DDesc& de
 	return MakePrismObj<D3D11Texture2D>(desc, std::move(d3dTexture));
 }
 
-PrismObj<Texture3D> D3D11GraphicsDevice::CreateTexture3D(const Texture3DDesc& desc)
+PrismObj<Texture3D> D3D11GraphicsDevice::CreateTexture3D(const Texture3DDesc& desc, const SubresourceData* initialData)
 {
 	D3D11_TEXTURE3D_DESC texDesc = {};
 	texDesc.Width = desc.width;
@@ -801,8 +1828,11 @@ PrismObj<Texture3D> D3D11GraphicsDevice::CreateTexture3D(const Texture3DDesc& de
 	texDesc.CPUAccessFlags = ConvertCpuAccessFlags(desc.cpuAccessFlags);
 	texDesc.MiscFlags = ConvertResourceMiscFlags(desc.miscFlags);
 
+	const uint32_t subresourceCount = desc.mipLevels ? desc.mipLevels : MipChainLength(desc.width, desc.height, desc.depth);
+	std::vector<D3D11_SUBRESOURCE_DATA> subresourceData;
+
 	ComPtr<ID3D11Texture3D> d3dTexture;
-	const HRESULT hr = device->CreateTexture3D(&texDesc, nullptr, &d3dTexture);
+	const HRESULT hr = device->CreateTexture3D(&texDesc, ConvertInitialData(initialData, subresourceCount, subresourceData), &d3dTexture);
 	if (FAILED(hr))
 	{
 		return {};
@@ -1180,6 +2210,16 @@ PrismObj<SamplerState> D3D11GraphicsDevice::CreateSamplerState(const SamplerDesc
 	return MakePrismObj<D3D11SamplerState>(desc, std::move(samplerState));
 }
 
+PrismObj<BindingSet> D3D11GraphicsDevice::CreateBindingSet()
+{
+	return MakePrismObj<D3D11BindingSet>();
+}
+
+PrismObj<BindingGroup> D3D11GraphicsDevice::CreateBindingGroup(const BindingGroupDesc& desc)
+{
+	return MakePrismObj<D3D11BindingGroup>(desc);
+}
+
 PrismObj<GraphicsPipeline> D3D11GraphicsDevice::CreateGraphicsPipeline(const GraphicsPipelineDesc& desc)
 {
 	return MakePrismObj<D3D11GraphicsPipeline>(this, desc);
@@ -1454,4 +2494,171 @@ PrismObj<Query> D3D11GraphicsDevice::CreateQuery(const QueryDesc& desc)
 	return MakePrismObj<D3D11Query>(desc, std::move(query));
 }
 
+PrismObj<Fence> D3D11GraphicsDevice::CreateFence(const uint64_t initialValue)
+{
+	ComPtr<ID3D11Device5> device5;
+	HRESULT hr = device.As(&device5);
+	if (FAILED(hr))
+	{
+		return {};
+	}
+
+	ComPtr<ID3D11Fence> fence;
+	hr = device5->CreateFence(initialValue, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
+	if (FAILED(hr))
+	{
+		return {};
+	}
+
+	HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (!event)
+	{
+		return {};
+	}
+
+	return MakePrismObj<D3D11Fence>(std::move(fence), event);
+}
+
+D3D11Fence::~D3D11Fence()
+{
+	CloseHandle(event);
+}
+
+uint64_t D3D11Fence::GetCompletedValue()
+{
+	return fence->GetCompletedValue();
+}
+
+bool D3D11Fence::Wait(const uint64_t value, const uint32_t timeoutMs)
+{
+	if (fence->GetCompletedValue() >= value)
+	{
+		return true;
+	}
+
+	if (timeoutMs == 0)
+	{
+		return false;
+	}
+
+	// The completion event is shared, concurrent waits are serialized. A wait that timed out may still set the
+	// event later, so every wake up checks the value again.
+	std::lock_guard lock(mutex);
+	while (fence->GetCompletedValue() < value)
+	{
+		if (FAILED(fence->SetEventOnCompletion(value, event)))
+		{
+			throw std::runtime_error("Failed to wait for fence.");
+		}
+
+		if (WaitForSingleObject(event, timeoutMs == Infinite ? INFINITE : timeoutMs) != WAIT_OBJECT_0)
+		{
+			return fence->GetCompletedValue() >= value;
+		}
+	}
+
+	return true;
+}
+
+PrismObj<NativeCommandBundle> D3D11GraphicsDevice::CreateNativeBundle(const CommandStream& stream)
+{
+	return MakePrismObj<D3D11NativeBundle>(stream);
+}
+
+PrismObj<UploadContext> D3D11GraphicsDevice::CreateUploadContext(const uint32_t chunkSize, const uint32_t chunkCount)
+{
+	return MakePrismObj<D3D11UploadContext>(device.Get(), immediateContext->GetContext(), chunkSize, chunkCount);
+}
+
+PrismObj<Readback> D3D11GraphicsDevice::ReadbackAsync(Resource* resource, const uint32_t subresource, const Box* region)
+{
+	if (!resource)
+	{
+		throw std::invalid_argument("Resource cannot be null");
+	}
+
+	if (!stagingPool)
+	{
+		stagingPool = std::make_shared<D3D11StagingPool>(device.Get(), immediateContext->GetContext());
+	}
+
+	// The staging copy holds only the region, so its shape is the region extent of the selected mip.
+	D3D11StagingPool::Key key = {};
+	D3D11_BOX extent = { 0, 0, 0, 1, 1, 1 };
+	bool depthStencil = false;
+	if (const auto buffer = dynamic_cast<D3D11Buffer*>(resource))
+	{
+		key.dimension = D3D11_RESOURCE_DIMENSION_BUFFER;
+		extent.right = buffer->GetDesc().widthInBytes;
+	}
+	else if (const auto texture1D = dynamic_cast<D3D11Texture1D*>(resource))
+	{
+		D3D11_TEXTURE1D_DESC desc;
+		texture1D->GetTexture()->GetDesc(&desc);
+		const uint32_t mip = subresource % desc.MipLevels;
+		key.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE1D;
+		key.format = desc.Format;
+		extent.right = std::max(1u, desc.Width >> mip);
+		depthStencil = (desc.BindFlags & D3D11_BIND_DEPTH_STENCIL) != 0;
+	}
+	else if (const auto texture2D = dynamic_cast<D3D11Texture2D*>(resource))
+	{
+		D3D11_TEXTURE2D_DESC desc;
+		texture2D->GetTexture()->GetDesc(&desc);
+		if (desc.SampleDesc.Count > 1)
+		{
+			throw std::invalid_argument("Multisampled textures must be resolved before reading them back");
+		}
+
+		const uint32_t mip = subresource % desc.MipLevels;
+		key.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+		key.format = desc.Format;
+		extent.right = std::max(1u, desc.Width >> mip);
+		extent.bottom = std::max(1u, desc.Height >> mip);
+		depthStencil = (desc.BindFlags & D3D11_BIND_DEPTH_STENCIL) != 0;
+	}
+	else if (const auto texture3D = dynamic_cast<D3D11Texture3D*>(resource))
+	{
+		D3D11_TEXTURE3D_DESC desc;
+		texture3D->GetTexture()->GetDesc(&desc);
+		const uint32_t mip = subresource % desc.MipLevels;
+		key.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE3D;
+		key.format = desc.Format;
+		extent.right = std::max(1u, desc.Width >> mip);
+		extent.bottom = std::max(1u, desc.Height >> mip);
+		extent.back = std::max(1u, desc.Depth >> mip);
+	}
+	else
+	{
+		throw std::invalid_argument("Resource type cannot be read back");
+	}
+
+	D3D11_BOX box = extent;
+	if (region)
+	{
+		// CopySubresourceRegion requires a null box for depth stencil resources.
+		if (depthStencil)
+		{
+			throw std::invalid_argument("Depth stencil resources can only be read back whole");
+		}
+
+		if (region->left >= region->right || region->top >= region->bottom || region->front >= region->back
+			|| region->right > extent.right || region->bottom > extent.bottom || region->back > extent.back)
+		{
+			throw std::invalid_argument("Readback region lies outside the subresource");
+		}
+		box = { region->left, region->top, region->front, region->right, region->bottom, region->back };
+	}
+
+	key.width = box.right - box.left;
+	key.height = box.bottom - box.top;
+	key.depth = box.back - box.front;
+
+	auto staging = stagingPool->Acquire(key);
+	const auto source = static_cast<ID3D11Resource*>(resource->GetNativePointer());
+	immediateContext->GetContext()->CopySubresourceRegion(staging.Get(), 0, 0, 0, 0, source, subresource, region ? &box : nullptr);
+
+	return MakePrismObj<D3D11Readback>(stagingPool, key, std::move(staging));
+}
+
 HEXA_PRISM_NAMESPACE_END
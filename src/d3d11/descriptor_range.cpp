@@ -2,7 +2,7 @@
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
-	static D3D11ShaderParameter* Find(D3D11ShaderParameter* buckets, uint32_t capacity, uint32_t hash, const char* key)
+	static D3D11DescriptorBucket* Find(D3D11DescriptorBucket* buckets, uint32_t capacity, uint32_t hash, const char* key)
 	{
 		uint32_t index = hash % capacity;
 		bool exit = false;
@@ -13,7 +13,7 @@ HEXA_PRISM_NAMESPACE_BEGIN
 			{
 				return entry;
 			}
-			else if (entry->hash == hash && strcmp(key, entry->name.get()) == 0)
+			else if (entry->hash == hash && strcmp(key, entry->name) == 0)
 			{
 				return entry;
 			}
@@ -34,94 +34,91 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		return nullptr;
 	}
 
-	D3D11DescriptorRange::D3D11DescriptorRange(ShaderStage stage, ShaderParameterType type, D3D11ShaderParameter* parameters, int parametersLength)
+	void D3D11DescriptorRange::Initialize(D3D11DescriptorArena& hot, D3D11DescriptorArena& cold, ShaderStage stage, ShaderParameterType type, const D3D11ShaderParameter* parameters, uint32_t parametersLength)
 	{
 		this->stage = stage;
 		this->type = type;
 
-		if (parametersLength > 0)
-		{
-			buckets = make_uarray_uninitialized<D3D11ShaderParameter>(parametersLength);
-			PrismZeroMemoryT(buckets.data(), parametersLength);
-		}
-
 		uint32_t startSlot = std::numeric_limits<uint32_t>::max();
 		uint32_t maxSlot = 0;
-		for (int i = 0; i < parametersLength; i++)
+		for (uint32_t i = 0; i < parametersLength; i++)
 		{
-			D3D11ShaderParameter& parameter = parameters[i];
+			const D3D11ShaderParameter& parameter = parameters[i];
 			startSlot = std::min(startSlot, parameter.index);
-			maxSlot = std::max(maxSlot, parameter.index);
-			auto param = Find(buckets.data(), parametersLength, parameter.hash, parameter.name.data());
-			*param = std::move(parameter);
+			maxSlot = std::max(maxSlot, parameter.index + std::max(parameter.size, 1u) - 1);
 		}
 
-		uint32_t rangeWidth = parametersLength == 0 ? 0 : (maxSlot + 1) - startSlot;
+		if (parametersLength == 0)
+		{
+			return;
+		}
+
+		uint32_t rangeWidth = (maxSlot + 1) - startSlot;
+
+		if (rangeWidth > SlotMask::MaxSlots)
+		{
+			throw std::runtime_error("Descriptor range exceeds the maximum slot count");
+		}
 
 		this->startSlot = startSlot;
 		this->count = rangeWidth;
+		this->bucketCount = parametersLength;
 
-		if (parametersLength == 0)
+		// Slot data is read on every bind and lives in the hot part, the name table is only needed by setters.
+		resources = hot.Allocate<void*>(rangeWidth);
+		if (type == ShaderParameterType::UAV)
 		{
-			return;
+			initialCounts = hot.Allocate<uint32_t>(rangeWidth);
 		}
-		resources = make_uarray_uninitialized<void*>(rangeWidth);
-		PrismZeroMemory(resources.data(), rangeWidth * sizeof(void*));
 
-		if (type == ShaderParameterType::UAV)
+		buckets = cold.Allocate<D3D11DescriptorBucket>(parametersLength);
+		if (buckets)
 		{
-			initialCounts = make_uarray_uninitialized<uint32_t>(rangeWidth);
-			for (uint32_t i = 0; i < rangeWidth; i++)
+			PrismZeroMemoryT(buckets, parametersLength);
+		}
+
+		for (uint32_t i = 0; i < parametersLength; i++)
+		{
+			const D3D11ShaderParameter& parameter = parameters[i];
+			const char* name = cold.AllocateString(parameter.name.c_str());
+			if (cold.IsMeasuring())
 			{
-				initialCounts[i] = std::numeric_limits<uint32_t>::max();
+				continue;
 			}
+
+			auto bucket = Find(buckets, parametersLength, parameter.hash, name);
+			bucket->name = name;
+			bucket->hash = parameter.hash;
+			bucket->index = parameter.index;
+			bucket->size = parameter.size;
+			declared.SetRange(parameter.index - startSlot, std::max(parameter.size, 1u));
 		}
-	}
 
-	D3D11DescriptorRange::~D3D11DescriptorRange()
-	{
-	}
+		if (hot.IsMeasuring())
+		{
+			return;
+		}
 
-	D3D11DescriptorRange::D3D11DescriptorRange(D3D11DescriptorRange&& other) noexcept
-		: stage(other.stage)
-		, type(other.type)
-		, startSlot(other.startSlot)
-		, count(other.count)
-		, resources(std::move(other.resources))
-		, initialCounts(std::move(other.initialCounts))
-		, ranges(std::move(other.ranges))
-		, buckets(std::move(other.buckets))
-	{
-		other.count = 0;
-	}
+		PrismZeroMemory(resources, rangeWidth * sizeof(void*));
 
-	D3D11DescriptorRange& D3D11DescriptorRange::operator=(D3D11DescriptorRange&& other) noexcept
-	{
-		if (this != &other)
+		if (initialCounts)
 		{
-			stage = other.stage;
-			type = other.type;
-			startSlot = other.startSlot;
-			count = other.count;
-			resources = std::move(other.resources);
-			initialCounts = std::move(other.initialCounts);
-			ranges = std::move(other.ranges);
-			buckets = std::move(other.buckets);
-
-			other.count = 0;
+			for (uint32_t i = 0; i < rangeWidth; i++)
+			{
+				initialCounts[i] = std::numeric_limits<uint32_t>::max();
+			}
 		}
-		return *this;
 	}
 
-	D3D11ShaderParameter* D3D11DescriptorRange::GetByName(const char* name) const
+	D3D11DescriptorBucket* D3D11DescriptorRange::GetByName(const char* name) const
 	{
-		if (buckets.size() == 0)
+		if (bucketCount == 0)
 		{
 			throw std::out_of_range("Key not found");
 		}
 
 		uint32_t hash = HashString(name);
-		auto pEntry = Find(buckets.data(), buckets.size(), hash, name);
+		auto pEntry = Find(buckets, bucketCount, hash, name);
 		if (pEntry != nullptr && pEntry->hash == hash)
 		{
 			return pEntry;
@@ -129,16 +126,16 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		throw std::out_of_range("Key not found");
 	}
 
-	bool D3D11DescriptorRange::TryGetByName(const char* name, D3D11ShaderParameter*& parameter) const
+	bool D3D11DescriptorRange::TryGetByName(const char* name, D3D11DescriptorBucket*& parameter) const
 	{
-		if (buckets.size() == 0)
+		if (bucketCount == 0)
 		{
 			parameter = {};
 			return false;
 		}
 
 		uint32_t hash = HashString(name);
-		auto pEntry = Find(buckets.data(), buckets.size(), hash, name);
+		auto pEntry = Find(buckets, bucketCount, hash, name);
 		if (pEntry != nullptr && pEntry->hash == hash)
 		{
 			parameter = pEntry;
@@ -153,6 +150,10 @@ HEXA_PRISM_NAMESPACE_BEGIN
 		auto parameter = GetByName(name);
 		auto old = resources[parameter->index - startSlot];
 		resources[parameter->index - startSlot] = resource;
+		if (old != resource)
+		{
+			changes++;
+		}
 		if ((old != nullptr) != (resource != nullptr))
 		{
 			UpdateRanges(parameter->index - startSlot, resource == nullptr);
@@ -161,15 +162,20 @@ HEXA_PRISM_NAMESPACE_BEGIN
 
 	bool D3D11DescriptorRange::TrySetByName(const char* name, void* resource, uint32_t initialValue)
 	{
-		D3D11ShaderParameter* parameter;
+		D3D11DescriptorBucket* parameter;
 		if (TryGetByName(name, parameter))
 		{
 			auto index = parameter->index - startSlot;
 			auto old = resources[index];
 			resources[index] = resource;
-			if (initialCounts)
+			if (old != resource)
+			{
+				changes++;
+			}
+			if (initialCounts && initialCounts[index] != initialValue)
 			{
 				initialCounts[index] = initialValue;
+				changes++;
 			}
 			if ((old != nullptr) != (resource != nullptr))
 			{
@@ -183,7 +189,7 @@ HEXA_PRISM_NAMESPACE_BEGIN
 
 	void D3D11DescriptorRange::UpdateByName(const char* name, void* oldState, void* state, uint32_t initialValue)
 	{
-		D3D11ShaderParameter* parameter;
+		D3D11DescriptorBucket* parameter;
 		if (TryGetByName(name, parameter))
 		{
 			auto index = parameter->index - startSlot;
@@ -195,9 +201,14 @@ HEXA_PRISM_NAMESPACE_BEGIN
 			}
 
 			resources[index] = state;
-			if (initialCounts)
+			if (old != state)
+			{
+				changes++;
+			}
+			if (initialCounts && initialCounts[index] != initialValue)
 			{
 				initialCounts[index] = initialValue;
+				changes++;
 			}
 			if ((old != nullptr) != (state != nullptr))
 			{
@@ -208,165 +219,232 @@ HEXA_PRISM_NAMESPACE_BEGIN
 
 	void D3D11DescriptorRange::UpdateRanges(uint32_t idx, bool clear)
 	{
-		if (clear)
-		{
-			for (uint32_t i = 0; i < ranges.size(); i++)
-			{
-				ResourceRange* range = ranges.data() + i;
-				uint32_t rangeStart = static_cast<uint32_t>(range->start - resources.data());
-				uint32_t rangeEnd = rangeStart + range->length - 1;
+		occupied.Assign(idx, !clear);
+	}
 
-				if (idx >= rangeStart && idx <= rangeEnd)
-				{
-					if (range->length == 1)
-					{
-						ranges.erase(ranges.begin() + i);
-					}
-					else if (idx == rangeStart)
-					{
-						range->start++;
-						range->length--;
-					}
-					else if (idx == rangeEnd)
-					{
-						range->length--;
-					}
-					else
-					{
-						ResourceRange newRange{
-							range->start + (idx - rangeStart + 1),
-							rangeEnd - idx
-						};
-
-						range->length = idx - rangeStart;
-						ranges.insert(ranges.begin() + i + 1, newRange);
-					}
-					return;
-				}
-			}
+#define DEFINE_BIND_FUNCTION(funcName, type) \
+	static void funcName(const ComPtr<ID3D11DeviceContext3>& ctx, uint32_t startSlot, uint32_t count, void** resources) \
+	{ \
+		ctx->funcName(startSlot, count, reinterpret_cast<type>(resources)); \
+	}
+
+	DEFINE_BIND_FUNCTION(VSSetShaderResources, ID3D11ShaderResourceView* const*)
+	DEFINE_BIND_FUNCTION(HSSetShaderResources, ID3D11ShaderResourceView* const*)
+	DEFINE_BIND_FUNCTION(DSSetShaderResources, ID3D11ShaderResourceView* const*)
+	DEFINE_BIND_FUNCTION(GSSetShaderResources, ID3D11ShaderResourceView* const*)
+	DEFINE_BIND_FUNCTION(PSSetShaderResources, ID3D11ShaderResourceView* const*)
+	DEFINE_BIND_FUNCTION(CSSetShaderResources, ID3D11ShaderResourceView* const*)
+
+	DEFINE_BIND_FUNCTION(VSSetConstantBuffers, ID3D11Buffer* const*)
+	DEFINE_BIND_FUNCTION(HSSetConstantBuffers, ID3D11Buffer* const*)
+	DEFINE_BIND_FUNCTION(DSSetConstantBuffers, ID3D11Buffer* const*)
+	DEFINE_BIND_FUNCTION(GSSetConstantBuffers, ID3D11Buffer* const*)
+	DEFINE_BIND_FUNCTION(PSSetConstantBuffers, ID3D11Buffer* const*)
+	DEFINE_BIND_FUNCTION(CSSetConstantBuffers, ID3D11Buffer* const*)
+
+	DEFINE_BIND_FUNCTION(VSSetSamplers, ID3D11SamplerState* const*)
+	DEFINE_BIND_FUNCTION(HSSetSamplers, ID3D11SamplerState* const*)
+	DEFINE_BIND_FUNCTION(DSSetSamplers, ID3D11SamplerState* const*)
+	DEFINE_BIND_FUNCTION(GSSetSamplers, ID3D11SamplerState* const*)
+	DEFINE_BIND_FUNCTION(PSSetSamplers, ID3D11SamplerState* const*)
+	DEFINE_BIND_FUNCTION(CSSetSamplers, ID3D11SamplerState* const*)
+
+#undef DEFINE_BIND_FUNCTION
+
+	static constexpr D3D11DescriptorRange::BindCallback BindCallbacks[][6] =
+	{
+		{ VSSetShaderResources, HSSetShaderResources, DSSetShaderResources, GSSetShaderResources, PSSetShaderResources, CSSetShaderResources },
+		{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+		{ VSSetConstantBuffers, HSSetConstantBuffers, DSSetConstantBuffers, GSSetConstantBuffers, PSSetConstantBuffers, CSSetConstantBuffers },
+		{ VSSetSamplers, HSSetSamplers, DSSetSamplers, GSSetSamplers, PSSetSamplers, CSSetSamplers },
+	};
+
+	using BindConstantsCallback = void(*)(ID3D11DeviceContext3* context, uint32_t slot, ID3D11Buffer* buffer, uint32_t firstConstant, uint32_t numConstants);
+
+#define DEFINE_BIND_CONSTANTS_FUNCTION(funcName) \
+	static void funcName(ID3D11DeviceContext3* ctx, uint32_t slot, ID3D11Buffer* buffer, uint32_t firstConstant, uint32_t numConstants) \
+	{ \
+		ctx->funcName(slot, 1, &buffer, &firstConstant, &numConstants); \
+	}
+
+	DEFINE_BIND_CONSTANTS_FUNCTION(VSSetConstantBuffers1)
+	DEFINE_BIND_CONSTANTS_FUNCTION(HSSetConstantBuffers1)
+	DEFINE_BIND_CONSTANTS_FUNCTION(DSSetConstantBuffers1)
+	DEFINE_BIND_CONSTANTS_FUNCTION(GSSetConstantBuffers1)
+	DEFINE_BIND_CONSTANTS_FUNCTION(PSSetConstantBuffers1)
+	DEFINE_BIND_CONSTANTS_FUNCTION(CSSetConstantBuffers1)
+
+#undef DEFINE_BIND_CONSTANTS_FUNCTION
+
+	static constexpr BindConstantsCallback BindConstantsCallbacks[6] =
+	{
+		VSSetConstantBuffers1, HSSetConstantBuffers1, DSSetConstantBuffers1, GSSetConstantBuffers1, PSSetConstantBuffers1, CSSetConstantBuffers1
+	};
+
+	D3D11DescriptorRange::BindCallback D3D11DescriptorRange::GetBindCallback(ShaderParameterType type, ShaderStage stage)
+	{
+		return BindCallbacks[static_cast<size_t>(type)][static_cast<size_t>(stage)];
+	}
+
+	void D3D11DescriptorRange::BindConstants(ID3D11DeviceContext3* context, ShaderStage stage, uint32_t slot, ID3D11Buffer* buffer, uint32_t firstConstant, uint32_t numConstants)
+	{
+		if (numConstants == 0)
+		{
+			BindCallbacks[static_cast<size_t>(ShaderParameterType::CBV)][static_cast<size_t>(stage)](context, slot, 1, reinterpret_cast<void**>(&buffer));
+			return;
 		}
-		else
+
+		BindConstantsCallbacks[static_cast<size_t>(stage)](context, slot, buffer, firstConstant, numConstants);
+	}
+
+	static SlotMask Without(const SlotMask& mask, uint32_t startSlot, const SlotMask* excluded)
+	{
+		return excluded ? mask & ~(*excluded >> startSlot) : mask;
+	}
+
+	void D3D11DescriptorRange::Bind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func, std::span<const D3D11BindingOverride> overrides, const SlotMask* excluded) const
+	{
+		void** source = resources;
+		void* patched[SlotMask::MaxSlots];
+		if (!overrides.empty())
 		{
-			for (uint32_t i = 0; i < ranges.size(); i++)
+			memcpy(patched, resources, count * sizeof(void*));
+			for (const auto& entry : overrides)
 			{
-				ResourceRange* range = ranges.data() + i;
-				uint32_t rangeStart = static_cast<uint32_t>(range->start - resources.data());
-				uint32_t rangeEnd = rangeStart + range->length - 1;
-
-				if (idx == rangeStart - 1)
-				{
-					range->start--;
-					range->length++;
-
-					if (i > 0)
-					{
-						ResourceRange* previousRange = ranges.data() + i - 1;
-						if (previousRange->start + previousRange->length == range->start)
-						{
-							previousRange->length += range->length;
-							ranges.erase(ranges.begin() + i);
-						}
-					}
-					return;
-				}
-				else if (idx == rangeEnd + 1)
-				{
-					range->length++;
-
-					if (i < ranges.size() - 1)
-					{
-						ResourceRange* nextRange = ranges.data() + i + 1;
-						if (range->start + range->length == nextRange->start)
-						{
-							range->length += nextRange->length;
-							ranges.erase(ranges.begin() + i + 1);
-						}
-					}
-					return;
-				}
-				else if (idx < rangeStart)
-				{
-					ResourceRange newRange{ resources.data() + idx, 1 };
-					ranges.insert(ranges.begin() + i, newRange);
-
-					if (i < ranges.size() - 1)
-					{
-						ResourceRange* nextRange = ranges.data() + i + 1;
-						if (newRange.start + newRange.length == nextRange->start)
-						{
-							ranges[i].length += nextRange->length;
-							ranges.erase(ranges.begin() + i + 1);
-						}
-					}
-					return;
-				}
+				patched[entry.slot] = entry.resource;
 			}
+			source = patched;
+		}
 
-			ResourceRange endRange{ resources.data() + idx, 1 };
-			ranges.push_back(endRange);
+		const SlotMask slots = Without(declared, startSlot, excluded);
+		slots.ForEachRange([&](const SlotRange& range)
+		{
+			func(context, startSlot + range.start, range.length, source + range.start);
+		});
 
-			if (ranges.size() > 1)
+		if (type != ShaderParameterType::CBV)
+		{
+			return;
+		}
+
+		for (const auto& entry : overrides)
+		{
+			if (entry.numConstants != 0 && entry.resource && slots.Test(entry.slot))
 			{
-				ResourceRange* previousRange = ranges.data() + ranges.size() - 2;
-				if (previousRange->start + previousRange->length == endRange.start)
-				{
-					previousRange->length += endRange.length;
-					ranges.erase(ranges.begin() + ranges.size() - 1);
-				}
+				BindConstants(context.Get(), stage, startSlot + entry.slot, static_cast<ID3D11Buffer*>(entry.resource), entry.firstConstant, entry.numConstants);
 			}
 		}
 	}
 
-	void D3D11DescriptorRange::Bind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func) const
+	void D3D11DescriptorRange::BindUAV(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides, const SlotMask* excluded) const
 	{
-		for (auto& range : ranges)
+		void** source = resources;
+		uint32_t* sourceCounts = initialCounts;
+		void* patched[SlotMask::MaxSlots];
+		uint32_t patchedCounts[SlotMask::MaxSlots];
+		if (!overrides.empty())
 		{
-			if (range.length > 0)
+			memcpy(patched, resources, count * sizeof(void*));
+			memcpy(patchedCounts, initialCounts, count * sizeof(uint32_t));
+			for (const auto& entry : overrides)
 			{
-				void** res = range.start;
-				auto start = static_cast<uint32_t>(range.start - resources.data());
-				func(context, startSlot + start, range.length, res);
+				patched[entry.slot] = entry.resource;
+				patchedCounts[entry.slot] = entry.initialCount;
 			}
+			source = patched;
+			sourceCounts = patchedCounts;
 		}
+
+		Without(declared, startSlot, excluded).ForEachRange([&](const SlotRange& range)
+		{
+			auto views = reinterpret_cast<ID3D11UnorderedAccessView**>(source + range.start);
+			context->CSSetUnorderedAccessViews(startSlot + range.start, range.length, views, sourceCounts + range.start);
+		});
 	}
 
-	void D3D11DescriptorRange::BindUAV(const ComPtr<ID3D11DeviceContext3>& context) const
+	void D3D11DescriptorRange::Unbind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func, bool overridden, const SlotMask* excluded) const
 	{
-		for (auto& range : ranges)
+		void* nullResources[SlotMask::MaxSlots] = {};
+		Without(overridden ? declared : occupied, startSlot, excluded).ForEachRange([&](const SlotRange& range)
 		{
-			if (range.length > 0)
-			{
-				void** res = range.start;
-				auto start = static_cast<uint32_t>(range.start - resources.data());
-				context->CSSetUnorderedAccessViews(startSlot + start, range.length, reinterpret_cast<ID3D11UnorderedAccessView**>(res), initialCounts.data());
-			}
-		}
+			func(context, startSlot + range.start, range.length, nullResources);
+		});
 	}
 
-	void D3D11DescriptorRange::Unbind(const ComPtr<ID3D11DeviceContext3>& context, BindCallback func) const
+	void D3D11DescriptorRange::UnbindUAV(const ComPtr<ID3D11DeviceContext3>& context, bool overridden, const SlotMask* excluded) const
 	{
-		void* nullResources[256] = {};
-		for (auto& range : ranges)
+		void* nullResources[SlotMask::MaxSlots] = {};
+		Without(overridden ? declared : occupied, startSlot, excluded).ForEachRange([&](const SlotRange& range)
 		{
-			if (range.length > 0)
+			context->CSSetUnorderedAccessViews(startSlot + range.start, range.length, reinterpret_cast<ID3D11UnorderedAccessView**>(nullResources), initialCounts + range.start);
+		});
+	}
+
+	D3D11DescriptorRange* D3D11DescriptorStorage::Layout(D3D11DescriptorArena& hot, D3D11DescriptorArena& cold, std::span<const ShaderStage> stages, const std::vector<D3D11ShaderParameter>& parameters)
+	{
+		const size_t rangeCount = static_cast<size_t>(ShaderParameterType::Sampler) + 1;
+		D3D11DescriptorRange* ranges = hot.Allocate<D3D11DescriptorRange>(rangeCount * stages.size());
+
+		// Parameters are sorted by (type, stage), so every range consumes the next run of them.
+		size_t cursor = 0;
+		for (size_t i = 0; i < rangeCount * stages.size(); i++)
+		{
+			const auto type = static_cast<ShaderParameterType>(i / stages.size());
+			const auto stage = stages[i % stages.size()];
+
+			const size_t first = cursor;
+			while (cursor < parameters.size() && parameters[cursor].type == type && parameters[cursor].stage == stage)
 			{
-				auto start = static_cast<uint32_t>(range.start - resources.data());
-				func(context, startSlot + start, range.length, nullResources);
+				cursor++;
 			}
+
+			D3D11DescriptorRange measured;
+			D3D11DescriptorRange* range = ranges ? new (&ranges[i]) D3D11DescriptorRange() : &measured;
+			range->Initialize(hot, cold, stage, type, parameters.data() + first, static_cast<uint32_t>(cursor - first));
 		}
+
+		return ranges;
 	}
 
-	void D3D11DescriptorRange::UnbindUAV(const ComPtr<ID3D11DeviceContext3>& context) const
+	std::span<D3D11DescriptorRange> D3D11DescriptorStorage::Build(std::span<const ShaderStage> stages, std::vector<D3D11ShaderParameter>& parameters)
 	{
-		void* nullResources[256] = {};
-		for (auto& range : ranges)
+		Reset();
+
+		std::stable_sort(parameters.begin(), parameters.end(), [](const D3D11ShaderParameter& a, const D3D11ShaderParameter& b)
 		{
-			if (range.length > 0)
+			if (a.type != b.type)
 			{
-				auto start = static_cast<uint32_t>(range.start - resources.data());
-				context->CSSetUnorderedAccessViews(startSlot + start, range.length, reinterpret_cast<ID3D11UnorderedAccessView**>(nullResources), initialCounts.data() + start);
+				return a.type < b.type;
 			}
+			return a.stage < b.stage;
+		});
+
+		// The first pass only measures, the second places everything at the same offsets inside the block.
+		D3D11DescriptorArena hotMeasure;
+		D3D11DescriptorArena coldMeasure;
+		Layout(hotMeasure, coldMeasure, stages, parameters);
+
+		const size_t hotSize = (hotMeasure.GetSize() + Alignment - 1) & ~(Alignment - 1);
+		block = ::operator new(hotSize + coldMeasure.GetSize(), std::align_val_t(Alignment));
+
+		D3D11DescriptorArena hot(block);
+		D3D11DescriptorArena cold(static_cast<uint8_t*>(block) + hotSize);
+		ranges = Layout(hot, cold, stages, parameters);
+		rangeCount = (static_cast<size_t>(ShaderParameterType::Sampler) + 1) * stages.size();
+		return GetRanges();
+	}
+
+	void D3D11DescriptorStorage::Reset()
+	{
+		// Ranges are trivially destructible views, releasing the block is all that is needed.
+		if (block)
+		{
+			::operator delete(block, std::align_val_t(Alignment));
+			block = nullptr;
 		}
+
+		ranges = nullptr;
+		rangeCount = 0;
 	}
 
 HEXA_PRISM_NAMESPACE_END
@@ -173,6 +173,26 @@ void D3D11GraphicsPipeline::Compile()
 	}
 
 	valid = success;
+
+	std::lock_guard lock(variableLayoutMutex);
+	variableLayout.reset();
+}
+
+std::shared_ptr<const D3D11VariableLayout> D3D11GraphicsPipeline::GetVariableLayout()
+{
+	std::lock_guard lock(variableLayoutMutex);
+	if (!variableLayout)
+	{
+		auto layout = std::make_shared<D3D11VariableLayout>();
+		layout->Reflect(vertexShaderBlob, ShaderStage::Vertex);
+		layout->Reflect(hullShaderBlob, ShaderStage::Hull);
+		layout->Reflect(domainShaderBlob, ShaderStage::Domain);
+		layout->Reflect(geometryShaderBlob, ShaderStage::Geometry);
+		layout->Reflect(pixelShaderBlob, ShaderStage::Pixel);
+		layout->Finalize();
+		variableLayout = std::move(layout);
+	}
+	return variableLayout;
 }
 
 HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
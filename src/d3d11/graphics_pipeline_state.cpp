@@ -201,41 +201,87 @@ D3D11GraphicsPipelineState::D3D11GraphicsPipelineState(const PrismObj<D3D11Graph
 	bindingList = std::make_unique<D3D11ResourceBindingList>(pipeline.Get(), desc.flags);
 }
 
-void D3D11GraphicsPipelineState::SetState(ID3D11DeviceContext3* context)
+void D3D11GraphicsPipelineState::SetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots)
 {
+	// Pipeline states built from the same pipeline or sharing state objects only resubmit what differs.
 	auto pipe = pipeline.AsPtr<D3D11GraphicsPipeline>();
-	context->VSSetShader(pipe->vs.Get(), nullptr, 0);
-	context->HSSetShader(pipe->hs.Get(), nullptr, 0);
-	context->DSSetShader(pipe->ds.Get(), nullptr, 0);
-	context->GSSetShader(pipe->gs.Get(), nullptr, 0);
-	context->PSSetShader(pipe->ps.Get(), nullptr, 0);
+	if (cache.SetObject(StateObject::VertexShader, pipe->vs.Get()))
+		context->VSSetShader(pipe->vs.Get(), nullptr, 0);
+	if (cache.SetObject(StateObject::HullShader, pipe->hs.Get()))
+		context->HSSetShader(pipe->hs.Get(), nullptr, 0);
+	if (cache.SetObject(StateObject::DomainShader, pipe->ds.Get()))
+		context->DSSetShader(pipe->ds.Get(), nullptr, 0);
+	if (cache.SetObject(StateObject::GeometryShader, pipe->gs.Get()))
+		context->GSSetShader(pipe->gs.Get(), nullptr, 0);
+	if (cache.SetObject(StateObject::PixelShader, pipe->ps.Get()))
+		context->PSSetShader(pipe->ps.Get(), nullptr, 0);
 
-	context->RSSetState(rasterizerState.Get());
+	if (cache.SetObject(StateObject::RasterizerState, rasterizerState.Get()))
+		context->RSSetState(rasterizerState.Get());
 
 	float blendFactor[4] = { desc.blendFactor.r, desc.blendFactor.g, desc.blendFactor.b, desc.blendFactor.a };
-	context->OMSetBlendState(blendState.Get(), blendFactor, desc.sampleMask);
-	context->OMSetDepthStencilState(depthStencilState.Get(), desc.stencilRef);
-	context->IASetInputLayout(inputLayout.Get());
-	context->IASetPrimitiveTopology(primitiveTopology);
+	if (cache.SetBlendState(blendState.Get(), blendFactor, desc.sampleMask))
+		context->OMSetBlendState(blendState.Get(), blendFactor, desc.sampleMask);
+	if (cache.SetDepthStencilState(depthStencilState.Get(), desc.stencilRef))
+		context->OMSetDepthStencilState(depthStencilState.Get(), desc.stencilRef);
+	if (cache.SetObject(StateObject::InputLayout, inputLayout.Get()))
+		context->IASetInputLayout(inputLayout.Get());
+	if (cache.SetTopology(primitiveTopology))
+		context->IASetPrimitiveTopology(primitiveTopology);
 
-	bindingList->BindGraphics(context);
+	const uint32_t dirtyRanges = AcquireBindings(tracker, *bindingList, bindingSet);
+	bindingList->BindGraphics(context, dirtyRanges, ResolveOverrides(bindingSet, *bindingList), groupSlots);
 }
 
-void D3D11GraphicsPipelineState::UnsetState(ID3D11DeviceContext3* context)
+void D3D11GraphicsPipelineState::CommitBindings(ID3D11DeviceContext3* context, BindingTracker& tracker, D3D11VariableUploadCache& uploads, D3D11BindingSet* bindingSet, const SlotMask* groupSlots)
 {
-	context->VSSetShader(nullptr, nullptr, 0);
-	context->HSSetShader(nullptr, nullptr, 0);
-	context->DSSetShader(nullptr, nullptr, 0);
-	context->GSSetShader(nullptr, nullptr, 0);
-	context->PSSetShader(nullptr, nullptr, 0);
-
-	context->RSSetState(nullptr);
-	context->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-	context->OMSetDepthStencilState(nullptr, 0);
-	context->IASetInputLayout(nullptr);
-	context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
-
-	bindingList->UnbindGraphics(context);
+	bindingList->UploadState(context, uploads);
+
+	const uint32_t dirtyRanges = AcquireBindings(tracker, *bindingList, bindingSet);
+	if (dirtyRanges != 0)
+	{
+		bindingList->BindGraphics(context, dirtyRanges, ResolveOverrides(bindingSet, *bindingList), groupSlots);
+	}
+}
+
+void D3D11GraphicsPipelineState::UnsetState(ID3D11DeviceContext3* context, StateCache& cache, BindingTracker& tracker, D3D11BindingSet* bindingSet, const SlotMask* groupSlots, bool replaced)
+{
+	// Graphics SRVs may alias the output merger, but every output merger change invalidates the trackers and rebinds
+	// them, so by default the next state simply overwrites the slots.
+	if ((static_cast<uint32_t>(bindingList->GetFlags()) & static_cast<uint32_t>(PipelineStateFlags::UnbindOnSwitch)) == 0)
+	{
+		return;
+	}
+
+	// A replacing graphics state sets its own shaders and state objects, clearing them first would only double the calls.
+	if (!replaced)
+	{
+		if (cache.SetObject(StateObject::VertexShader, nullptr))
+			context->VSSetShader(nullptr, nullptr, 0);
+		if (cache.SetObject(StateObject::HullShader, nullptr))
+			context->HSSetShader(nullptr, nullptr, 0);
+		if (cache.SetObject(StateObject::DomainShader, nullptr))
+			context->DSSetShader(nullptr, nullptr, 0);
+		if (cache.SetObject(StateObject::GeometryShader, nullptr))
+			context->GSSetShader(nullptr, nullptr, 0);
+		if (cache.SetObject(StateObject::PixelShader, nullptr))
+			context->PSSetShader(nullptr, nullptr, 0);
+
+		static constexpr float defaultBlendFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		if (cache.SetObject(StateObject::RasterizerState, nullptr))
+			context->RSSetState(nullptr);
+		if (cache.SetBlendState(nullptr, defaultBlendFactor, 0xFFFFFFFF))
+			context->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+		if (cache.SetDepthStencilState(nullptr, 0))
+			context->OMSetDepthStencilState(nullptr, 0);
+		if (cache.SetObject(StateObject::InputLayout, nullptr))
+			context->IASetInputLayout(nullptr);
+		if (cache.SetTopology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED))
+			context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
+	}
+
+	bindingList->UnbindGraphics(context, ResolveOverrides(bindingSet, *bindingList), groupSlots);
+	tracker.Invalidate();
 }
 
-HEXA_PRISM_NAMESPACE_END
\ No newline at end of file
+HEXA_PRISM_NAMESPACE_END
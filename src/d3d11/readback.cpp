@@ -0,0 +1,153 @@
+#include "d3d11/readback.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+ComPtr<ID3D11Resource> D3D11StagingPool::Create(const Key& key)
+{
+    ComPtr<ID3D11Resource> resource;
+    HRESULT hr = E_FAIL;
+    switch (key.dimension)
+    {
+    case D3D11_RESOURCE_DIMENSION_BUFFER:
+    {
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = key.width;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        ComPtr<ID3D11Buffer> buffer;
+        hr = device->CreateBuffer(&desc, nullptr, &buffer);
+        resource = buffer;
+        break;
+    }
+    case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+    {
+        D3D11_TEXTURE1D_DESC desc = {};
+        desc.Width = key.width;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = key.format;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        ComPtr<ID3D11Texture1D> texture;
+        hr = device->CreateTexture1D(&desc, nullptr, &texture);
+        resource = texture;
+        break;
+    }
+    case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+    {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = key.width;
+        desc.Height = key.height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = key.format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        ComPtr<ID3D11Texture2D> texture;
+        hr = device->CreateTexture2D(&desc, nullptr, &texture);
+        resource = texture;
+        break;
+    }
+    case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+    {
+        D3D11_TEXTURE3D_DESC desc = {};
+        desc.Width = key.width;
+        desc.Height = key.height;
+        desc.Depth = key.depth;
+        desc.MipLevels = 1;
+        desc.Format = key.format;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        ComPtr<ID3D11Texture3D> texture;
+        hr = device->CreateTexture3D(&desc, nullptr, &texture);
+        resource = texture;
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to create staging resource.");
+    }
+
+    return resource;
+}
+
+size_t D3D11StagingPool::GetFreeCount()
+{
+    std::lock_guard lock(mutex);
+    return freeList.size();
+}
+
+ComPtr<ID3D11Resource> D3D11StagingPool::Acquire(const Key& key)
+{
+    {
+        std::lock_guard lock(mutex);
+        for (size_t i = 0; i < freeList.size(); i++)
+        {
+            if (freeList[i].key == key)
+            {
+                auto resource = std::move(freeList[i].resource);
+                freeList[i] = std::move(freeList.back());
+                freeList.pop_back();
+                return resource;
+            }
+        }
+    }
+
+    return Create(key);
+}
+
+void D3D11StagingPool::Recycle(const Key& key, ComPtr<ID3D11Resource>&& resource)
+{
+    std::lock_guard lock(mutex);
+    freeList.push_back({ key, std::move(resource) });
+}
+
+void D3D11StagingPool::Trim()
+{
+    std::lock_guard lock(mutex);
+    freeList.clear();
+}
+
+D3D11Readback::~D3D11Readback()
+{
+    if (mapped)
+    {
+        pool->GetContext()->Unmap(staging.Get(), 0);
+    }
+    pool->Recycle(key, std::move(staging));
+}
+
+bool D3D11Readback::TryMap(bool wait)
+{
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    const HRESULT hr = pool->GetContext()->Map(staging.Get(), 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+    {
+        return false;
+    }
+
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to map readback.");
+    }
+
+    data = { mappedResource.pData, mappedResource.RowPitch, mappedResource.DepthPitch };
+    mapped = true;
+    return true;
+}
+
+const ReadbackData& D3D11Readback::Wait()
+{
+    if (!mapped)
+    {
+        TryMap(true);
+    }
+    return data;
+}
+
+HEXA_PRISM_NAMESPACE_END
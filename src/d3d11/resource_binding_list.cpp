@@ -4,10 +4,120 @@
 
 HEXA_PRISM_NAMESPACE_BEGIN
 
-D3D11GlobalResourceList::StateChangedHandlerList D3D11GlobalResourceList::StateChanged = {};
+uint32_t D3D11GlobalResourceList::GetOrCreateId(const char* name)
+{
+    auto it = nameToId.find(name);
+    if (it != nameToId.end())
+    {
+        return it->second;
+    }
+
+    const auto id = static_cast<uint32_t>(entries.size());
+    entries.push_back({ name, { ShaderParameterType::SRV, nullptr, static_cast<uint32_t>(-1) }, {} });
+    nameToId.emplace(name, id);
+    return id;
+}
+
+void D3D11GlobalResourceList::SetState(const char* name, D3D11ShaderParameterState state)
+{
+    std::lock_guard lock(mutex);
+    auto& entry = entries[GetOrCreateId(name)];
+    const auto oldState = entry.state;
+    if (oldState.Type == state.Type && oldState.Resource == state.Resource && oldState.InitialCount == state.InitialCount)
+    {
+        return;
+    }
+
+    entry.state = state;
+
+    for (auto bindingList : entry.subscribers)
+    {
+        if (oldState.Type != state.Type)
+        {
+            // The name moved to another descriptor type, release the slots of the old one first.
+            if (oldState.Resource)
+            {
+                bindingList->GlobalStateChanged(entry.name.c_str(), oldState, { oldState.Type, nullptr, static_cast<uint32_t>(-1) });
+            }
+            bindingList->GlobalStateChanged(entry.name.c_str(), { state.Type, nullptr, static_cast<uint32_t>(-1) }, state);
+            continue;
+        }
+
+        bindingList->GlobalStateChanged(entry.name.c_str(), oldState, state);
+    }
+}
+
+void D3D11GlobalResourceList::SetCBV(const char* name, Buffer* buffer)
+{
+    void* p = buffer ? static_cast<D3D11Buffer*>(buffer)->GetBuffer() : nullptr;
+    SetState(name, { ShaderParameterType::CBV, p, static_cast<uint32_t>(-1) });
+}
+
+void D3D11GlobalResourceList::SetSampler(const char* name, SamplerState* sampler)
+{
+    void* p = sampler ? static_cast<D3D11SamplerState*>(sampler)->GetSamplerState() : nullptr;
+    SetState(name, { ShaderParameterType::Sampler, p, static_cast<uint32_t>(-1) });
+}
+
+void D3D11GlobalResourceList::SetSRV(const char* name, ShaderResourceView* view)
+{
+    void* p = view ? static_cast<D3D11ShaderResourceView*>(view)->GetView() : nullptr;
+    SetState(name, { ShaderParameterType::SRV, p, static_cast<uint32_t>(-1) });
+}
+
+void D3D11GlobalResourceList::SetUAV(const char* name, UnorderedAccessView* view, uint32_t initialCount)
+{
+    void* p = view ? static_cast<D3D11UnorderedAccessView*>(view)->GetView() : nullptr;
+    SetState(name, { ShaderParameterType::UAV, p, initialCount });
+}
+
+void D3D11GlobalResourceList::Register(D3D11ResourceBindingList* bindingList, const std::vector<const char*>& names, std::vector<uint32_t>& ids)
+{
+    std::lock_guard lock(mutex);
+
+    ids.clear();
+    ids.reserve(names.size());
+    for (auto name : names)
+    {
+        ids.push_back(GetOrCreateId(name));
+    }
+
+    // A name may be declared by several stages, subscribe only once.
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    for (auto id : ids)
+    {
+        auto& entry = entries[id];
+        entry.subscribers.push_back(bindingList);
+
+        if (entry.state.Resource)
+        {
+            bindingList->GlobalStateChanged(entry.name.c_str(), { entry.state.Type, nullptr, static_cast<uint32_t>(-1) }, entry.state);
+        }
+    }
+}
+
+void D3D11GlobalResourceList::Unregister(D3D11ResourceBindingList* bindingList, std::vector<uint32_t>& ids)
+{
+    std::lock_guard lock(mutex);
+
+    for (auto id : ids)
+    {
+        auto& subscribers = entries[id].subscribers;
+        auto it = std::find(subscribers.begin(), subscribers.end(), bindingList);
+        if (it != subscribers.end())
+        {
+            *it = subscribers.back();
+            subscribers.pop_back();
+        }
+    }
+
+    ids.clear();
+}
 
 D3D11ResourceBindingList::D3D11ResourceBindingList(D3D11GraphicsPipeline* pipeline, PipelineStateFlags flags)
-    : pipeline(pipeline), flags(flags)
+    : pipeline(pipeline), flags(flags), device(pipeline->device->GetDevice()), globals(&pipeline->device->GetGlobalResourceList())
 {
     pipeline->AddRef();
     // onCompileToken = pipeline->OnCompile.Subscribe([this](Pipeline* p) { OnPipelineCompile(p); });
@@ -15,7 +125,7 @@ D3D11ResourceBindingList::D3D11ResourceBindingList(D3D11GraphicsPipeline* pipeli
 }
 
 D3D11ResourceBindingList::D3D11ResourceBindingList(D3D11ComputePipeline* pipeline, PipelineStateFlags flags)
-    : pipeline(pipeline), flags(flags)
+    : pipeline(pipeline), flags(flags), device(pipeline->device->GetDevice()), globals(&pipeline->device->GetGlobalResourceList())
 {
     pipeline->AddRef();
     // onCompileToken = pipeline->OnCompile.Subscribe([this](Pipeline* p) { OnPipelineCompile(p); });
@@ -24,7 +134,7 @@ D3D11ResourceBindingList::D3D11ResourceBindingList(D3D11ComputePipeline* pipelin
 
 D3D11ResourceBindingList::~D3D11ResourceBindingList()
 {
-    globalStateChangedToken.Unsubscribe();
+    globals->Unregister(this, globalIds);
     onCompileToken.Unsubscribe();
     
     pipeline->Release();
@@ -32,15 +142,6 @@ D3D11ResourceBindingList::~D3D11ResourceBindingList()
     Clear();
 }
 
-void D3D11ResourceBindingList::Hook()
-{
-    globalStateChangedToken = D3D11GlobalResourceList::StateChanged.Subscribe(
-        [this](const char* name, D3D11ShaderParameterState oldState, D3D11ShaderParameterState state)
-        {
-            GlobalStateChanged(name, oldState, state);
-        });
-}
-
 void D3D11ResourceBindingList::GlobalStateChanged(const char* name, D3D11ShaderParameterState oldState, D3D11ShaderParameterState state)
 {
     switch (state.Type)
@@ -48,57 +149,113 @@ void D3D11ResourceBindingList::GlobalStateChanged(const char* name, D3D11ShaderP
     case ShaderParameterType::SRV:
         for (auto& range : rangesSRVs)
         {
-            range.UpdateByName(name, oldState.Resource, state.Resource);
+            UpdateByName(range, name, oldState.Resource, state.Resource);
         }
         break;
 
     case ShaderParameterType::UAV:
         for (auto& range : rangesUAVs)
         {
-            range.UpdateByName(name, oldState.Resource, state.Resource, state.InitialCount);
+            UpdateByName(range, name, oldState.Resource, state.Resource, state.InitialCount);
         }
         break;
 
     case ShaderParameterType::CBV:
         for (auto& range : rangesCBVs)
         {
-            range.UpdateByName(name, oldState.Resource, state.Resource);
+            UpdateByName(range, name, oldState.Resource, state.Resource);
         }
         break;
 
     case ShaderParameterType::Sampler:
         for (auto& range : rangesSamplers)
         {
-            range.UpdateByName(name, oldState.Resource, state.Resource);
+            UpdateByName(range, name, oldState.Resource, state.Resource);
         }
         break;
     }
 }
 
+bool D3D11ResourceBindingList::SetByName(D3D11DescriptorRange& range, const char* name, void* resource, uint32_t initialCount)
+{
+    const uint32_t changes = range.changes;
+    const bool found = range.TrySetByName(name, resource, initialCount);
+    if (range.changes != changes)
+    {
+        versions.MarkDirty(range.type, range.stage);
+    }
+    return found;
+}
+
+void D3D11ResourceBindingList::UpdateByName(D3D11DescriptorRange& range, const char* name, void* oldResource, void* resource, uint32_t initialCount)
+{
+    const uint32_t changes = range.changes;
+    range.UpdateByName(name, oldResource, resource, initialCount);
+    if (range.changes != changes)
+    {
+        versions.MarkDirty(range.type, range.stage);
+    }
+}
+
 void D3D11ResourceBindingList::OnPipelineCompile(Pipeline* pipeline)
 {
     Clear();
 
+    std::vector<D3D11ShaderParameter> parameters;
+
     if (auto graphicsPipeline = dynamic_cast<D3D11GraphicsPipeline*>(pipeline))
     {
-        Reflect(graphicsPipeline->vertexShaderBlob, ShaderStage::Vertex);
-        Reflect(graphicsPipeline->hullShaderBlob, ShaderStage::Hull);
-        Reflect(graphicsPipeline->domainShaderBlob, ShaderStage::Domain);
-        Reflect(graphicsPipeline->geometryShaderBlob, ShaderStage::Geometry);
-        Reflect(graphicsPipeline->pixelShaderBlob, ShaderStage::Pixel);
+        static constexpr ShaderStage stages[] = { ShaderStage::Vertex, ShaderStage::Hull, ShaderStage::Domain, ShaderStage::Geometry, ShaderStage::Pixel };
+
+        Reflect(graphicsPipeline->vertexShaderBlob, ShaderStage::Vertex, parameters);
+        Reflect(graphicsPipeline->hullShaderBlob, ShaderStage::Hull, parameters);
+        Reflect(graphicsPipeline->domainShaderBlob, ShaderStage::Domain, parameters);
+        Reflect(graphicsPipeline->geometryShaderBlob, ShaderStage::Geometry, parameters);
+        Reflect(graphicsPipeline->pixelShaderBlob, ShaderStage::Pixel, parameters);
+        Build(stages, parameters);
+
+        if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(PipelineStateFlags::ReflectVariables)) != 0)
+        {
+            variables = std::make_unique<D3D11VariableList>(graphicsPipeline->GetVariableLayout());
+        }
     }
 
     if (auto computePipeline = dynamic_cast<D3D11ComputePipeline*>(pipeline))
     {
-        Reflect(computePipeline->computeShaderBlob, ShaderStage::Compute);
+        static constexpr ShaderStage stages[] = { ShaderStage::Compute };
+
+        Reflect(computePipeline->computeShaderBlob, ShaderStage::Compute, parameters);
+        Build(stages, parameters);
+
+        if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(PipelineStateFlags::ReflectVariables)) != 0)
+        {
+            variables = std::make_unique<D3D11VariableList>(computePipeline->GetVariableLayout());
+        }
     }
 
-    rangesSRVs.shrink_to_fit();
-    rangesUAVs.shrink_to_fit();
-    rangesCBVs.shrink_to_fit();
-    rangesSamplers.shrink_to_fit();
-    
-    D3D11GlobalResourceList::SetState(this);
+    versions.MarkAllDirty();
+    layoutVersion++;
+
+    RegisterGlobals();
+}
+
+void D3D11ResourceBindingList::RegisterGlobals()
+{
+    globals->Unregister(this, globalIds);
+
+    std::vector<const char*> names;
+    for (auto* ranges : { &rangesSRVs, &rangesUAVs, &rangesCBVs, &rangesSamplers })
+    {
+        for (const auto& range : *ranges)
+        {
+            for (uint32_t i = 0; i < range.bucketCount; i++)
+            {
+                names.push_back(range.buckets[i].name);
+            }
+        }
+    }
+
+    globals->Register(this, names, globalIds);
 }
 
 static ShaderParameterType ConvertShaderInputType(D3D_SHADER_INPUT_TYPE type)
@@ -129,15 +286,10 @@ static ShaderParameterType ConvertShaderInputType(D3D_SHADER_INPUT_TYPE type)
     }
 }
 
-void D3D11ResourceBindingList::Reflect(const PrismObj<Blob>& shader, ShaderStage stage)
+void D3D11ResourceBindingList::Reflect(const PrismObj<Blob>& shader, ShaderStage stage, std::vector<D3D11ShaderParameter>& parameters)
 {
     if (!shader)
     {
-        rangesSRVs.emplace_back(stage, ShaderParameterType::SRV, nullptr, 0);
-        rangesUAVs.emplace_back(stage, ShaderParameterType::UAV, nullptr, 0);
-        rangesCBVs.emplace_back(stage, ShaderParameterType::CBV, nullptr, 0);
-        rangesSamplers.emplace_back(stage, ShaderParameterType::Sampler, nullptr, 0);
-        rangesVariables.emplace_back();
         return;
     }
 
@@ -155,8 +307,7 @@ void D3D11ResourceBindingList::Reflect(const PrismObj<Blob>& shader, ShaderStage
         throw std::runtime_error("Failed to get shader description");
     }
 
-    std::vector<D3D11ShaderParameter> shaderParametersInStage;
-    shaderParametersInStage.reserve(shaderDesc.BoundResources);
+    parameters.reserve(parameters.size() + shaderDesc.BoundResources);
 
     for (uint32_t i = 0; i < shaderDesc.BoundResources; i++)
     {
@@ -173,55 +324,70 @@ void D3D11ResourceBindingList::Reflect(const PrismObj<Blob>& shader, ShaderStage
         parameter.stage = stage;
         parameter.type = ConvertShaderInputType(shaderInputBindDesc.Type);
 
+        if (parameter.type == ShaderParameterType::CBV && strcmp(shaderInputBindDesc.Name, CommandList::PushConstantsName) == 0)
+        {
+            pushConstantSlots[static_cast<uint32_t>(stage)] = parameter.index;
+            pushConstantStages = static_cast<ShaderStageFlags>(static_cast<uint32_t>(pushConstantStages) | (1u << static_cast<uint32_t>(stage)));
+            continue;
+        }
+
         parameter.name = String(shaderInputBindDesc.Name);
         parameter.hash = D3D11DescriptorRange::HashString(parameter.name.c_str());
 
-        shaderParametersInStage.push_back(parameter);
+        parameters.push_back(parameter);
     }
+}
 
-    std::vector<D3D11ShaderParameter> srvParams;
-    std::vector<D3D11ShaderParameter> uavParams;
-    std::vector<D3D11ShaderParameter> cbvParams;
-    std::vector<D3D11ShaderParameter> samplerParams;
+void D3D11ResourceBindingList::Build(std::span<const ShaderStage> stages, std::vector<D3D11ShaderParameter>& parameters)
+{
+    const auto ranges = storage.Build(stages, parameters);
 
-    for (const auto& param : shaderParametersInStage)
-    {
-        switch (param.type)
-        {
-        case ShaderParameterType::SRV:
-            srvParams.push_back(param);
-            break;
-        case ShaderParameterType::UAV:
-            uavParams.push_back(param);
-            break;
-        case ShaderParameterType::CBV:
-            cbvParams.push_back(param);
-            break;
-        case ShaderParameterType::Sampler:
-            samplerParams.push_back(param);
-            break;
-        }
-    }
+    const size_t stageCount = stages.size();
+    rangesSRVs = ranges.subspan(static_cast<size_t>(ShaderParameterType::SRV) * stageCount, stageCount);
+    rangesUAVs = ranges.subspan(static_cast<size_t>(ShaderParameterType::UAV) * stageCount, stageCount);
+    rangesCBVs = ranges.subspan(static_cast<size_t>(ShaderParameterType::CBV) * stageCount, stageCount);
+    rangesSamplers = ranges.subspan(static_cast<size_t>(ShaderParameterType::Sampler) * stageCount, stageCount);
+}
 
-    rangesSRVs.emplace_back(stage, ShaderParameterType::SRV, srvParams.data(), static_cast<int>(srvParams.size()));
-    rangesUAVs.emplace_back(stage, ShaderParameterType::UAV, uavParams.data(), static_cast<int>(uavParams.size()));
-    rangesCBVs.emplace_back(stage, ShaderParameterType::CBV, cbvParams.data(), static_cast<int>(cbvParams.size()));
-    rangesSamplers.emplace_back(stage, ShaderParameterType::Sampler, samplerParams.data(), static_cast<int>(samplerParams.size()));
+void D3D11ResourceBindingList::Clear()
+{
+    rangesSRVs = {};
+    rangesUAVs = {};
+    rangesCBVs = {};
+    rangesSamplers = {};
+    storage.Reset();
+    pushConstantStages = ShaderStageFlags::None;
+
+    variables.reset();
+}
 
-    if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(PipelineStateFlags::ReflectVariables)) != 0)
+std::span<const D3D11DescriptorRange> D3D11ResourceBindingList::GetRanges(ShaderParameterType type) const noexcept
+{
+    switch (type)
     {
-        // TODO: Implement variable reflection
-        rangesVariables.emplace_back();
+    case ShaderParameterType::SRV:
+        return rangesSRVs;
+    case ShaderParameterType::UAV:
+        return rangesUAVs;
+    case ShaderParameterType::CBV:
+        return rangesCBVs;
+    case ShaderParameterType::Sampler:
+        return rangesSamplers;
     }
+    return {};
 }
 
-void D3D11ResourceBindingList::Clear()
+static D3D11DescriptorRange& FindRange(std::span<D3D11DescriptorRange> ranges, ShaderStage stage)
 {
-    rangesSRVs.clear();
-    rangesUAVs.clear();
-    rangesCBVs.clear();
-    rangesSamplers.clear();
-    rangesVariables.clear();
+    for (auto& range : ranges)
+    {
+        if (range.stage == stage)
+        {
+            return range;
+        }
+    }
+
+    throw std::out_of_range("Shader stage is not part of the pipeline");
 }
 
 void D3D11ResourceBindingList::SetSRV(const char* name, ShaderResourceView* srv)
@@ -229,7 +395,7 @@ void D3D11ResourceBindingList::SetSRV(const char* name, ShaderResourceView* srv)
     void* p = srv ? static_cast<D3D11ShaderResourceView*>(srv)->GetView() : nullptr;
     for (auto& range : rangesSRVs)
     {
-        range.TrySetByName(name, p);
+        SetByName(range, name, p);
     }
 }
 
@@ -237,7 +403,7 @@ void D3D11ResourceBindingList::SetSRV(const char* name, void* srv)
 {
     for (auto& range : rangesSRVs)
     {
-        range.TrySetByName(name, srv);
+        SetByName(range, name, srv);
     }
 }
 
@@ -246,7 +412,7 @@ void D3D11ResourceBindingList::SetUAV(const char* name, UnorderedAccessView* uav
     void* p = uav ? static_cast<D3D11UnorderedAccessView*>(uav)->GetView() : nullptr;
     for (auto& range : rangesUAVs)
     {
-        range.TrySetByName(name, p, initialCount);
+        SetByName(range, name, p, initialCount);
     }
 }
 
@@ -254,7 +420,7 @@ void D3D11ResourceBindingList::SetUAV(const char* name, void* uav, uint32_t init
 {
     for (auto& range : rangesUAVs)
     {
-        range.TrySetByName(name, uav, initialCount);
+        SetByName(range, name, uav, initialCount);
     }
 }
 
@@ -263,7 +429,7 @@ void D3D11ResourceBindingList::SetCBV(const char* name, Buffer* cbv)
     void* p = cbv ? static_cast<D3D11Buffer*>(cbv)->GetBuffer() : nullptr;
     for (auto& range : rangesCBVs)
     {
-        range.TrySetByName(name, p);
+        SetByName(range, name, p);
     }
 }
 
@@ -271,7 +437,7 @@ void D3D11ResourceBindingList::SetCBV(const char* name, void* cbv)
 {
     for (auto& range : rangesCBVs)
     {
-        range.TrySetByName(name, cbv);
+        SetByName(range, name, cbv);
     }
 }
 
@@ -280,7 +446,7 @@ void D3D11ResourceBindingList::SetSampler(const char* name, SamplerState* sample
     void* p = sampler ? static_cast<D3D11SamplerState*>(sampler)->GetSamplerState() : nullptr;
     for (auto& range : rangesSamplers)
     {
-        range.TrySetByName(name, p);
+        SetByName(range, name, p);
     }
 }
 
@@ -288,126 +454,169 @@ void D3D11ResourceBindingList::SetSampler(const char* name, void* sampler)
 {
     for (auto& range : rangesSamplers)
     {
-        range.TrySetByName(name, sampler);
+        SetByName(range, name, sampler);
     }
 }
 
 void D3D11ResourceBindingList::SetSRV(const char* name, ShaderStage stage, ShaderResourceView* srv)
 {
     void* p = srv ? static_cast<D3D11ShaderResourceView*>(srv)->GetView() : nullptr;
-    rangesSRVs[static_cast<size_t>(stage)].TrySetByName(name, p);
+    SetByName(FindRange(rangesSRVs, stage), name, p);
 }
 
 void D3D11ResourceBindingList::SetUAV(const char* name, ShaderStage stage, UnorderedAccessView* uav, uint32_t initialCount)
 {
     void* p = uav ? static_cast<D3D11UnorderedAccessView*>(uav)->GetView() : nullptr;
-    rangesUAVs[static_cast<size_t>(stage)].TrySetByName(name, p, initialCount);
+    SetByName(FindRange(rangesUAVs, stage), name, p, initialCount);
 }
 
 void D3D11ResourceBindingList::SetCBV(const char* name, ShaderStage stage, Buffer* cbv)
 {
     void* p = cbv ? static_cast<D3D11Buffer*>(cbv)->GetBuffer() : nullptr;
-    rangesCBVs[static_cast<size_t>(stage)].TrySetByName(name, p);
+    SetByName(FindRange(rangesCBVs, stage), name, p);
 }
 
 void D3D11ResourceBindingList::SetSampler(const char* name, ShaderStage stage, SamplerState* sampler)
 {
     void* p = sampler ? static_cast<D3D11SamplerState*>(sampler)->GetSamplerState() : nullptr;
-    rangesSamplers[static_cast<size_t>(stage)].TrySetByName(name, p);
+    SetByName(FindRange(rangesSamplers, stage), name, p);
 }
 
-void D3D11ResourceBindingList::UploadState(void* context)
+bool D3D11ResourceBindingList::WriteVariable(const char* name, uint32_t stageMask, const void* value, size_t size)
 {
-    for (auto& var : rangesVariables)
+    if (!variables)
     {
-        var.Upload(context);
+        return false;
     }
-}
 
-#define DEFINE_BIND_FUNCTION(funcName, type) \
-    static void funcName(const ComPtr<ID3D11DeviceContext3>& ctx, uint32_t startSlot, uint32_t count, void** resources) \
-    { \
-        ctx->funcName(startSlot, count, reinterpret_cast<type>(resources)); \
+    const auto& layout = variables->GetLayout();
+    const uint32_t hash = D3D11DescriptorRange::HashString(name);
+    bool found = false;
+
+    for (uint32_t i = 0; i < layout.buffers.size(); i++)
+    {
+        const auto& buffer = layout.buffers[i];
+        if ((buffer.stageMask & stageMask) == 0)
+        {
+            continue;
+        }
+
+        for (const auto& variable : buffer.variables)
+        {
+            if (variable.hash != hash || strcmp(variable.name.c_str(), name) != 0)
+            {
+                continue;
+            }
+
+            variables->Write(i, variable, value, size);
+            found = true;
+
+            // The backing buffer is created on first write, so constant buffers that are only ever fed
+            // through SetCBV or the global resource list are left alone.
+            if (!variables->GetBuffer(i))
+            {
+                void* cbv = variables->CreateBuffer(device, i);
+                for (auto& range : rangesCBVs)
+                {
+                    if ((buffer.stageMask & (1u << static_cast<uint32_t>(range.stage))) != 0)
+                    {
+                        SetByName(range, buffer.name.c_str(), cbv);
+                    }
+                }
+            }
+            break;
+        }
     }
 
-DEFINE_BIND_FUNCTION(VSSetShaderResources, ID3D11ShaderResourceView* const*)
-DEFINE_BIND_FUNCTION(HSSetShaderResources, ID3D11ShaderResourceView* const*)
-DEFINE_BIND_FUNCTION(DSSetShaderResources, ID3D11ShaderResourceView* const*)
-DEFINE_BIND_FUNCTION(GSSetShaderResources, ID3D11ShaderResourceView* const*)
-DEFINE_BIND_FUNCTION(PSSetShaderResources, ID3D11ShaderResourceView* const*)
+    return found;
+}
 
-DEFINE_BIND_FUNCTION(VSSetConstantBuffers, ID3D11Buffer* const*)
-DEFINE_BIND_FUNCTION(HSSetConstantBuffers, ID3D11Buffer* const*)
-DEFINE_BIND_FUNCTION(DSSetConstantBuffers, ID3D11Buffer* const*)
-DEFINE_BIND_FUNCTION(GSSetConstantBuffers, ID3D11Buffer* const*)
-DEFINE_BIND_FUNCTION(PSSetConstantBuffers, ID3D11Buffer* const*)
+void D3D11ResourceBindingList::UploadState(ID3D11DeviceContext3* context, D3D11VariableUploadCache& uploads) const
+{
+    if (variables)
+    {
+        variables->Upload(context, uploads);
+    }
+}
 
-DEFINE_BIND_FUNCTION(VSSetSamplers, ID3D11SamplerState* const*)
-DEFINE_BIND_FUNCTION(HSSetSamplers, ID3D11SamplerState* const*)
-DEFINE_BIND_FUNCTION(DSSetSamplers, ID3D11SamplerState* const*)
-DEFINE_BIND_FUNCTION(GSSetSamplers, ID3D11SamplerState* const*)
-DEFINE_BIND_FUNCTION(PSSetSamplers, ID3D11SamplerState* const*)
+static std::span<const D3D11BindingOverride> OverridesOf(std::span<const D3D11BindingOverride> overrides, const D3D11DescriptorRange& range)
+{
+    if (overrides.empty())
+    {
+        return {};
+    }
 
-DEFINE_BIND_FUNCTION(CSSetShaderResources, ID3D11ShaderResourceView* const*)
-DEFINE_BIND_FUNCTION(CSSetConstantBuffers, ID3D11Buffer* const*)
-DEFINE_BIND_FUNCTION(CSSetSamplers, ID3D11SamplerState* const*)
+    const uint32_t index = BindingVersionTable::IndexOf(range.type, range.stage);
+    auto first = std::lower_bound(overrides.begin(), overrides.end(), index, [](const D3D11BindingOverride& entry, uint32_t value) { return entry.range < value; });
+    auto last = std::upper_bound(first, overrides.end(), index, [](uint32_t value, const D3D11BindingOverride& entry) { return value < entry.range; });
+    return { first, last };
+}
 
-void D3D11ResourceBindingList::BindGraphics(const ComPtr<ID3D11DeviceContext3>& context)
+static const SlotMask* ExcludedOf(const SlotMask* excludedSlots, const D3D11DescriptorRange& range)
 {
-    rangesSRVs[static_cast<size_t>(ShaderStage::Vertex)].Bind(context, VSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Hull)].Bind(context, HSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Domain)].Bind(context, DSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Geometry)].Bind(context, GSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Pixel)].Bind(context, PSSetShaderResources);
+    return excludedSlots ? &excludedSlots[BindingVersionTable::IndexOf(range.type, range.stage)] : nullptr;
+}
 
-    rangesCBVs[static_cast<size_t>(ShaderStage::Vertex)].Bind(context, VSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Hull)].Bind(context, HSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Domain)].Bind(context, DSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Geometry)].Bind(context, GSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Pixel)].Bind(context, PSSetConstantBuffers);
+// Types bound through the per-stage input slots, UAVs go through CSSetUnorderedAccessViews.
+static constexpr ShaderParameterType InputTypes[] = { ShaderParameterType::SRV, ShaderParameterType::CBV, ShaderParameterType::Sampler };
 
-    rangesSamplers[static_cast<size_t>(ShaderStage::Vertex)].Bind(context, VSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Hull)].Bind(context, HSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Domain)].Bind(context, DSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Geometry)].Bind(context, GSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Pixel)].Bind(context, PSSetSamplers);
+void D3D11ResourceBindingList::BindGraphics(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges, std::span<const D3D11BindingOverride> overrides, const SlotMask* excludedSlots)
+{
+    // Walk type-major, matching the order the ranges are laid out in memory.
+    for (const auto type : InputTypes)
+    {
+        for (const auto& range : GetRanges(type))
+        {
+            if ((dirtyRanges & BindingVersionTable::MaskOf(type, range.stage)) != 0)
+            {
+                range.Bind(context, D3D11DescriptorRange::GetBindCallback(type, range.stage), OverridesOf(overrides, range), ExcludedOf(excludedSlots, range));
+            }
+        }
+    }
 }
 
-void D3D11ResourceBindingList::UnbindGraphics(const ComPtr<ID3D11DeviceContext3>& context)
+void D3D11ResourceBindingList::UnbindGraphics(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides, const SlotMask* excludedSlots)
 {
-    rangesSRVs[static_cast<size_t>(ShaderStage::Vertex)].Unbind(context, VSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Hull)].Unbind(context, HSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Domain)].Unbind(context, DSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Geometry)].Unbind(context, GSSetShaderResources);
-    rangesSRVs[static_cast<size_t>(ShaderStage::Pixel)].Unbind(context, PSSetShaderResources);
+    for (const auto type : InputTypes)
+    {
+        for (const auto& range : GetRanges(type))
+        {
+            range.Unbind(context, D3D11DescriptorRange::GetBindCallback(type, range.stage), !OverridesOf(overrides, range).empty(), ExcludedOf(excludedSlots, range));
+        }
+    }
+}
 
-    rangesCBVs[static_cast<size_t>(ShaderStage::Vertex)].Unbind(context, VSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Hull)].Unbind(context, HSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Domain)].Unbind(context, DSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Geometry)].Unbind(context, GSSetConstantBuffers);
-    rangesCBVs[static_cast<size_t>(ShaderStage::Pixel)].Unbind(context, PSSetConstantBuffers);
+void D3D11ResourceBindingList::BindCompute(const ComPtr<ID3D11DeviceContext3>& context, uint32_t dirtyRanges, std::span<const D3D11BindingOverride> overrides, const SlotMask* excludedSlots)
+{
+    if ((dirtyRanges & BindingVersionTable::MaskOf(ShaderParameterType::UAV, ShaderStage::Compute)) != 0)
+    {
+        rangesUAVs[0].BindUAV(context, OverridesOf(overrides, rangesUAVs[0]), ExcludedOf(excludedSlots, rangesUAVs[0]));
+    }
 
-    rangesSamplers[static_cast<size_t>(ShaderStage::Vertex)].Unbind(context, VSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Hull)].Unbind(context, HSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Domain)].Unbind(context, DSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Geometry)].Unbind(context, GSSetSamplers);
-    rangesSamplers[static_cast<size_t>(ShaderStage::Pixel)].Unbind(context, PSSetSamplers);
+    for (const auto type : InputTypes)
+    {
+        const auto& range = GetRanges(type)[0];
+        if ((dirtyRanges & BindingVersionTable::MaskOf(type, ShaderStage::Compute)) != 0)
+        {
+            range.Bind(context, D3D11DescriptorRange::GetBindCallback(type, ShaderStage::Compute), OverridesOf(overrides, range), ExcludedOf(excludedSlots, range));
+        }
+    }
 }
 
-void D3D11ResourceBindingList::BindCompute(const ComPtr<ID3D11DeviceContext3>& context)
+void D3D11ResourceBindingList::UnbindCompute(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides, const SlotMask* excludedSlots)
 {
-    rangesUAVs[0].BindUAV(context);
-    rangesSRVs[0].Bind(context, CSSetShaderResources);
-    rangesCBVs[0].Bind(context, CSSetConstantBuffers);
-    rangesSamplers[0].Bind(context, CSSetSamplers);
+    UnbindComputeUAVs(context, overrides, excludedSlots);
+
+    for (const auto type : InputTypes)
+    {
+        const auto& range = GetRanges(type)[0];
+        range.Unbind(context, D3D11DescriptorRange::GetBindCallback(type, ShaderStage::Compute), !OverridesOf(overrides, range).empty(), ExcludedOf(excludedSlots, range));
+    }
 }
 
-void D3D11ResourceBindingList::UnbindCompute(const ComPtr<ID3D11DeviceContext3>& context)
+void D3D11ResourceBindingList::UnbindComputeUAVs(const ComPtr<ID3D11DeviceContext3>& context, std::span<const D3D11BindingOverride> overrides, const SlotMask* excludedSlots)
 {
-    rangesUAVs[0].UnbindUAV(context);
-    rangesSRVs[0].Unbind(context, CSSetShaderResources);
-    rangesCBVs[0].Unbind(context, CSSetConstantBuffers);
-    rangesSamplers[0].Unbind(context, CSSetSamplers);
+    rangesUAVs[0].UnbindUAV(context, !OverridesOf(overrides, rangesUAVs[0]).empty(), ExcludedOf(excludedSlots, rangesUAVs[0]));
 }
 
 HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,220 @@
+#include "d3d11/upload_context.hpp"
+#include "d3d11/d3d11.hpp"
+#include <thread>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+D3D11UploadContext::D3D11UploadContext(ID3D11Device* device, ID3D11DeviceContext* context, uint32_t chunkSize, uint32_t chunkCount)
+    : context(context), chunkSize(chunkSize), chunks(std::max(1u, chunkCount))
+{
+    for (auto& chunk : chunks)
+    {
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = chunkSize;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        if (FAILED(device->CreateBuffer(&desc, nullptr, &chunk.buffer)))
+        {
+            throw std::runtime_error("Failed to create upload staging buffer.");
+        }
+
+        D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+        if (FAILED(device->CreateQuery(&queryDesc, &chunk.query)))
+        {
+            throw std::runtime_error("Failed to create upload query.");
+        }
+    }
+}
+
+D3D11UploadContext::~D3D11UploadContext()
+{
+    if (mapped)
+    {
+        context->Unmap(chunks[current].buffer.Get(), 0);
+    }
+}
+
+bool D3D11UploadContext::IsChunkIdle(Chunk& chunk, bool wait)
+{
+    if (!chunk.busy)
+    {
+        return true;
+    }
+
+    BOOL done = FALSE;
+    while (context->GetData(chunk.query.Get(), &done, sizeof(done), wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK || !done)
+    {
+        if (!wait)
+        {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    chunk.busy = false;
+    return true;
+}
+
+void D3D11UploadContext::OpenChunk()
+{
+    Chunk& chunk = chunks[current];
+    if (!IsChunkIdle(chunk, false))
+    {
+        frameStats.stalls++;
+        totalStats.stalls++;
+        IsChunkIdle(chunk, true);
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    if (FAILED(context->Map(chunk.buffer.Get(), 0, D3D11_MAP_WRITE, 0, &mappedResource)))
+    {
+        throw std::runtime_error("Failed to map upload staging buffer.");
+    }
+
+    mapped = static_cast<uint8_t*>(mappedResource.pData);
+    used = 0;
+}
+
+void D3D11UploadContext::Account(uint64_t bytes, uint32_t copies)
+{
+    frameStats.bytes += bytes;
+    frameStats.uploads++;
+    frameStats.copies += copies;
+    totalStats.bytes += bytes;
+    totalStats.uploads++;
+    totalStats.copies += copies;
+}
+
+void D3D11UploadContext::UploadBuffer(Buffer* dst, uint32_t dstOffset, const void* data, uint32_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    if (dstOffset > dst->GetDesc().widthInBytes || size > dst->GetDesc().widthInBytes - dstOffset)
+    {
+        throw std::invalid_argument("Upload exceeds the destination buffer");
+    }
+
+    auto d3dBuffer = static_cast<D3D11Buffer*>(dst)->GetBuffer();
+
+    // Larger than a whole chunk, the driver stages it. Pending copies go first, they may target the same range.
+    if (size > chunkSize)
+    {
+        Flush();
+        D3D11_BOX box = { dstOffset, 0, 0, dstOffset + size, 1, 1 };
+        context->UpdateSubresource(d3dBuffer, 0, &box, data, 0, 0);
+        Account(size, 1);
+        return;
+    }
+
+    // Copies keep a 16 byte aligned source offset, which lets the driver use its fast paths.
+    uint32_t offset = (used + 15) & ~15u;
+    if (mapped && offset + size > chunkSize)
+    {
+        Flush();
+    }
+
+    if (!mapped)
+    {
+        OpenChunk();
+        offset = 0;
+    }
+
+    memcpy(mapped + offset, data, size);
+    used = offset + size;
+
+    if (!pending.empty())
+    {
+        PendingCopy& last = pending.back();
+        if (last.dst == d3dBuffer && last.dstOffset + last.size == dstOffset && last.srcOffset + last.size == offset)
+        {
+            last.size += size;
+            Account(size, 0);
+            return;
+        }
+    }
+
+    pending.push_back({ d3dBuffer, dstOffset, offset, size });
+    Account(size, 1);
+}
+
+// Rows and slices of a whole subresource, for the bandwidth accounting.
+static void GetSubresourceRows(Resource* resource, uint32_t subresource, uint32_t& rows, uint32_t& slices)
+{
+    rows = 1;
+    slices = 1;
+    if (const auto texture2D = dynamic_cast<D3D11Texture2D*>(resource))
+    {
+        D3D11_TEXTURE2D_DESC desc;
+        texture2D->GetTexture()->GetDesc(&desc);
+        rows = std::max(1u, desc.Height >> (subresource % desc.MipLevels));
+    }
+    else if (const auto texture3D = dynamic_cast<D3D11Texture3D*>(resource))
+    {
+        D3D11_TEXTURE3D_DESC desc;
+        texture3D->GetTexture()->GetDesc(&desc);
+        rows = std::max(1u, desc.Height >> (subresource % desc.MipLevels));
+        slices = std::max(1u, desc.Depth >> (subresource % desc.MipLevels));
+    }
+}
+
+void D3D11UploadContext::UploadTexture(Resource* dst, uint32_t subresource, const SubresourceData& data, const Box* region)
+{
+    D3D11_BOX box;
+    const D3D11_BOX* boxPtr = nullptr;
+    uint32_t rows;
+    uint32_t slices;
+    if (region)
+    {
+        box = { region->left, region->top, region->front, region->right, region->bottom, region->back };
+        boxPtr = &box;
+        rows = region->bottom - region->top;
+        slices = region->back - region->front;
+    }
+    else
+    {
+        GetSubresourceRows(dst, subresource, rows, slices);
+    }
+
+    const uint64_t bytes = slices > 1 ? static_cast<uint64_t>(data.slicePitch) * slices : static_cast<uint64_t>(data.rowPitch) * rows;
+
+    // Texture copies land after the buffer copies recorded so far, keep the recording order.
+    Flush();
+    context->UpdateSubresource(static_cast<ID3D11Resource*>(dst->GetNativePointer()), subresource, boxPtr, data.data, data.rowPitch, data.slicePitch);
+    Account(bytes, 1);
+}
+
+void D3D11UploadContext::Flush()
+{
+    if (!mapped)
+    {
+        return;
+    }
+
+    Chunk& chunk = chunks[current];
+    context->Unmap(chunk.buffer.Get(), 0);
+    mapped = nullptr;
+
+    for (const auto& copy : pending)
+    {
+        D3D11_BOX box = { copy.srcOffset, 0, 0, copy.srcOffset + copy.size, 1, 1 };
+        context->CopySubresourceRegion(copy.dst, 0, copy.dstOffset, 0, 0, chunk.buffer.Get(), 0, &box);
+    }
+    pending.clear();
+
+    context->End(chunk.query.Get());
+    chunk.busy = true;
+    current = (current + 1) % static_cast<uint32_t>(chunks.size());
+}
+
+UploadStats D3D11UploadContext::EndFrame()
+{
+    Flush();
+    const UploadStats stats = frameStats;
+    frameStats = {};
+    return stats;
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,179 @@
+#include "d3d11/variable_list.hpp"
+#include "d3d11/descriptor_range.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+void D3D11VariableLayout::Reflect(const PrismObj<Blob>& shader, ShaderStage stage)
+{
+    if (!shader)
+    {
+        return;
+    }
+
+    ComPtr<ID3D11ShaderReflection> reflection;
+    HRESULT hr = D3DReflect(shader->GetData(), shader->GetLength(), IID_PPV_ARGS(&reflection));
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to reflect shader");
+    }
+
+    D3D11_SHADER_DESC shaderDesc;
+    hr = reflection->GetDesc(&shaderDesc);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to get shader description");
+    }
+
+    for (uint32_t i = 0; i < shaderDesc.ConstantBuffers; i++)
+    {
+        auto constantBuffer = reflection->GetConstantBufferByIndex(i);
+
+        D3D11_SHADER_BUFFER_DESC bufferDesc;
+        if (FAILED(constantBuffer->GetDesc(&bufferDesc)) || bufferDesc.Type != D3D_CT_CBUFFER)
+        {
+            continue;
+        }
+
+        // Push constants are fed by the command list, a shadow copy would never be uploaded.
+        if (strcmp(bufferDesc.Name, CommandList::PushConstantsName) == 0)
+        {
+            continue;
+        }
+
+        const uint32_t hash = D3D11DescriptorRange::HashString(bufferDesc.Name);
+
+        auto it = std::find_if(buffers.begin(), buffers.end(), [&](const D3D11ConstantBufferLayout& buffer)
+        {
+            return buffer.hash == hash && buffer.size == bufferDesc.Size && strcmp(buffer.name.c_str(), bufferDesc.Name) == 0;
+        });
+
+        if (it != buffers.end())
+        {
+            it->stageMask |= 1u << static_cast<uint32_t>(stage);
+            continue;
+        }
+
+        D3D11ConstantBufferLayout layout = {};
+        layout.name = String(bufferDesc.Name);
+        layout.hash = hash;
+        layout.size = bufferDesc.Size;
+        layout.stageMask = 1u << static_cast<uint32_t>(stage);
+        layout.variables.reserve(bufferDesc.Variables);
+
+        for (uint32_t j = 0; j < bufferDesc.Variables; j++)
+        {
+            D3D11_SHADER_VARIABLE_DESC variableDesc;
+            if (FAILED(constantBuffer->GetVariableByIndex(j)->GetDesc(&variableDesc)))
+            {
+                continue;
+            }
+
+            D3D11ShaderVariable variable = {};
+            variable.name = String(variableDesc.Name);
+            variable.hash = D3D11DescriptorRange::HashString(variableDesc.Name);
+            variable.offset = variableDesc.StartOffset;
+            variable.size = variableDesc.Size;
+            layout.variables.push_back(variable);
+        }
+
+        buffers.push_back(std::move(layout));
+    }
+}
+
+void D3D11VariableLayout::Finalize()
+{
+    uint32_t shadowSize = 0;
+    for (auto& buffer : buffers)
+    {
+        buffer.shadowOffset = shadowSize;
+        shadowSize += (buffer.size + 15) & ~15u;
+    }
+
+    defaults.assign(shadowSize, 0);
+}
+
+static std::atomic<uint64_t> nextVariableListId{ 1 };
+
+bool D3D11VariableUploadCache::IsCurrent(uint64_t listId, uint32_t index, uint64_t version) const
+{
+    auto it = entries.find(listId << 16 | index);
+    return it != entries.end() && it->second.generation == generation && it->second.version == version;
+}
+
+void D3D11VariableUploadCache::Record(uint64_t listId, uint32_t index, uint64_t version)
+{
+    entries.insert_or_assign(listId << 16 | index, Entry{ version, generation });
+}
+
+void D3D11VariableUploadCache::Invalidate() noexcept
+{
+    if (entries.size() > MaxEntries)
+    {
+        entries.clear();
+    }
+    generation++;
+}
+
+D3D11VariableList::D3D11VariableList(std::shared_ptr<const D3D11VariableLayout> layout)
+    : layout(std::move(layout)), id(nextVariableListId.fetch_add(1, std::memory_order_relaxed))
+{
+    shadow = this->layout->defaults;
+    buffers.resize(this->layout->buffers.size());
+    versions.resize(this->layout->buffers.size());
+}
+
+ID3D11Buffer* D3D11VariableList::CreateBuffer(ID3D11Device* device, uint32_t index)
+{
+    const auto& layoutBuffer = layout->buffers[index];
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.ByteWidth = (layoutBuffer.size + 15) & ~15u;
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    D3D11_SUBRESOURCE_DATA initialData = {};
+    initialData.pSysMem = shadow.data() + layoutBuffer.shadowOffset;
+
+    HRESULT hr = device->CreateBuffer(&bufferDesc, &initialData, &buffers[index]);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to create constant buffer for reflected variables");
+    }
+
+    return buffers[index].Get();
+}
+
+void D3D11VariableList::Write(uint32_t index, const D3D11ShaderVariable& variable, const void* data, size_t size)
+{
+    const auto& layoutBuffer = layout->buffers[index];
+    memcpy(shadow.data() + layoutBuffer.shadowOffset + variable.offset, data, std::min<size_t>(size, variable.size));
+    versions[index]++;
+}
+
+void D3D11VariableList::Upload(ID3D11DeviceContext3* context, D3D11VariableUploadCache& cache) const
+{
+    for (uint32_t index = 0; index < static_cast<uint32_t>(buffers.size()); index++)
+    {
+        auto buffer = buffers[index].Get();
+        if (!buffer || cache.IsCurrent(id, index, versions[index]))
+        {
+            continue;
+        }
+
+        // WriteDiscard invalidates the whole buffer, so the full shadow copy is written even if a single variable changed.
+        // Every context renames the buffer on its own, so lists recording on different threads do not see each other's maps.
+        const auto& layoutBuffer = layout->buffers[index];
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        {
+            throw std::runtime_error("Failed to map reflected constant buffer");
+        }
+
+        memcpy(mapped.pData, shadow.data() + layoutBuffer.shadowOffset, layoutBuffer.size);
+        context->Unmap(buffer, 0);
+        cache.Record(id, index, versions[index]);
+    }
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,144 @@
+#include "deferred_release.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+DeferredReleaseQueue::DeferredReleaseQueue(Fence* fence, bool background) : fence(fence)
+{
+	if (background)
+	{
+		worker = std::jthread([this] { RunWorker(); });
+	}
+}
+
+DeferredReleaseQueue::~DeferredReleaseQueue()
+{
+	if (worker.joinable())
+	{
+		{
+			std::lock_guard lock(workerMutex);
+			stopping = true;
+		}
+		workerCondition.notify_all();
+		worker.join();
+	}
+
+	std::vector<PrismObject*> remaining;
+	remaining.swap(workerBatch);
+	for (const auto& entry : pending)
+	{
+		remaining.push_back(entry.object);
+	}
+	pending.clear();
+	ReleaseAll(remaining);
+}
+
+void DeferredReleaseQueue::ReleaseAll(std::vector<PrismObject*>& objects) noexcept
+{
+	for (auto object : objects)
+	{
+		object->Release();
+	}
+	objects.clear();
+}
+
+void DeferredReleaseQueue::RunWorker()
+{
+	std::vector<PrismObject*> batch;
+	std::unique_lock lock(workerMutex);
+	while (true)
+	{
+		workerCondition.wait(lock, [&] { return stopping || !workerBatch.empty(); });
+		if (workerBatch.empty())
+		{
+			return;
+		}
+
+		batch.swap(workerBatch);
+		workerBusy = true;
+		lock.unlock();
+		ReleaseAll(batch);
+		lock.lock();
+		workerBusy = false;
+		workerCondition.notify_all();
+	}
+}
+
+size_t DeferredReleaseQueue::GetPendingCount()
+{
+	std::lock_guard lock(mutex);
+	return pending.size();
+}
+
+void DeferredReleaseQueue::Retire(PrismObject* object, uint64_t value)
+{
+	if (!object)
+	{
+		return;
+	}
+
+	// Kept sorted by value, out of order retirements are rare and inserted behind their equals.
+	std::lock_guard lock(mutex);
+	if (pending.empty() || pending.back().value <= value)
+	{
+		pending.push_back({ value, object });
+		return;
+	}
+
+	auto position = std::upper_bound(pending.begin(), pending.end(), value, [](uint64_t v, const Entry& entry) { return v < entry.value; });
+	pending.insert(position, { value, object });
+}
+
+uint32_t DeferredReleaseQueue::Collect()
+{
+	if (!fence)
+	{
+		throw std::runtime_error("Deferred release queue has no fence, pass the completed value.");
+	}
+
+	return Collect(fence->GetCompletedValue());
+}
+
+uint32_t DeferredReleaseQueue::Collect(uint64_t completedValue)
+{
+	std::vector<PrismObject*> batch;
+	{
+		std::lock_guard lock(mutex);
+		while (!pending.empty() && pending.front().value <= completedValue)
+		{
+			batch.push_back(pending.front().object);
+			pending.pop_front();
+		}
+	}
+
+	const auto count = static_cast<uint32_t>(batch.size());
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	if (!worker.joinable())
+	{
+		ReleaseAll(batch);
+		return count;
+	}
+
+	{
+		std::lock_guard lock(workerMutex);
+		workerBatch.insert(workerBatch.end(), batch.begin(), batch.end());
+	}
+	workerCondition.notify_all();
+	return count;
+}
+
+void DeferredReleaseQueue::Flush()
+{
+	if (!worker.joinable())
+	{
+		return;
+	}
+
+	std::unique_lock lock(workerMutex);
+	workerCondition.wait(lock, [&] { return workerBatch.empty() && !workerBusy; });
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,438 @@
+#include "frame_graph.hpp"
+#include <algorithm>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+const FrameGraphTexture& FrameGraphContext::GetTexture(FrameGraphResource resource) const
+{
+	if (resource.index >= graph->resources.size())
+	{
+		throw std::invalid_argument("Invalid frame graph resource");
+	}
+	return graph->resources[resource.index].views;
+}
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::Read(FrameGraphResource resource)
+{
+	if (resource.index >= graph->resources.size())
+	{
+		throw std::invalid_argument("Invalid frame graph resource");
+	}
+	if (pass + 1 != graph->passes.size())
+	{
+		throw std::runtime_error("Frame graph accesses can only be declared on the last added pass.");
+	}
+
+	graph->accesses.push_back({ resource.index, FrameGraphAccess::ShaderResource });
+	graph->passes[pass].shape.accessCount++;
+	return *this;
+}
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::Write(FrameGraphResource resource, FrameGraphAccess access)
+{
+	if (resource.index >= graph->resources.size())
+	{
+		throw std::invalid_argument("Invalid frame graph resource");
+	}
+	if (access == FrameGraphAccess::ShaderResource)
+	{
+		throw std::invalid_argument("Shader resource access is read only");
+	}
+	if (pass + 1 != graph->passes.size())
+	{
+		throw std::runtime_error("Frame graph accesses can only be declared on the last added pass.");
+	}
+
+	graph->accesses.push_back({ resource.index, access });
+	graph->passes[pass].shape.accessCount++;
+	return *this;
+}
+
+FrameGraphPassBuilder& FrameGraphPassBuilder::SetSideEffects()
+{
+	graph->passes[pass].shape.sideEffects = true;
+	return *this;
+}
+
+FrameGraph::FrameGraph(TransientResourcePool* pool) : pool(pool)
+{
+	if (!pool)
+	{
+		throw std::invalid_argument("Frame graph requires a transient resource pool");
+	}
+}
+
+FrameGraphResource FrameGraph::CreateTexture(const char* name, const Texture2DDesc& desc)
+{
+	resources.push_back({ name, desc, false, {} });
+	return { static_cast<uint32_t>(resources.size() - 1) };
+}
+
+FrameGraphResource FrameGraph::ImportTexture(const char* name, const FrameGraphTexture& views)
+{
+	resources.push_back({ name, views.texture ? views.texture->GetDesc() : Texture2DDesc{}, true, views });
+	return { static_cast<uint32_t>(resources.size() - 1) };
+}
+
+FrameGraphPassBuilder FrameGraph::AddPass(const char* name, std::function<void(FrameGraphContext&)> execute)
+{
+	passes.push_back({ name, std::move(execute), { static_cast<uint32_t>(accesses.size()), 0, false } });
+	return { this, static_cast<uint32_t>(passes.size() - 1) };
+}
+
+void FrameGraph::Reset() noexcept
+{
+	resources.clear();
+	accesses.clear();
+	passes.clear();
+}
+
+bool FrameGraph::MatchesCompiled() const noexcept
+{
+	if (resources.size() != compiledResources.size() || accesses.size() != compiledAccesses.size() || passes.size() != compiledPasses.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		const CompiledResource& compiledResource = compiledResources[i];
+		if (resources[i].imported != compiledResource.imported)
+		{
+			return false;
+		}
+		// Imported textures are bound fresh every frame, only the descs of transient ones shape the schedule.
+		if (!compiledResource.imported && !TransientResourcePool::Equals(resources[i].desc, compiledResource.desc))
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < accesses.size(); i++)
+	{
+		if (accesses[i].resource != compiledAccesses[i].resource || accesses[i].access != compiledAccesses[i].access)
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		const PassShape& shape = passes[i].shape;
+		const PassShape& compiledShape = compiledPasses[i];
+		if (shape.firstAccess != compiledShape.firstAccess || shape.accessCount != compiledShape.accessCount || shape.sideEffects != compiledShape.sideEffects)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Walks the passes backwards. A pass lives if it has side effects or writes something that is imported or accessed by
+// a live pass after it. Whatever a live pass accesses is needed from the passes before it: output merger and unordered
+// access writes count as reads too, depth tests, blending and UAV writes see the existing contents.
+void FrameGraph::Cull(std::vector<bool>& live) const
+{
+	live.assign(passes.size(), false);
+	std::vector<bool> needed(resources.size(), false);
+
+	for (size_t i = passes.size(); i-- > 0;)
+	{
+		const PassShape& shape = passes[i].shape;
+		bool keep = shape.sideEffects;
+		for (uint32_t j = 0; j < shape.accessCount && !keep; j++)
+		{
+			const Access& access = accesses[shape.firstAccess + j];
+			keep = access.access != FrameGraphAccess::ShaderResource && (resources[access.resource].imported || needed[access.resource]);
+		}
+
+		if (!keep)
+		{
+			continue;
+		}
+
+		live[i] = true;
+		for (uint32_t j = 0; j < shape.accessCount; j++)
+		{
+			needed[accesses[shape.firstAccess + j].resource] = true;
+		}
+	}
+}
+
+// Greedy interval assignment over the schedule: a slot freed after the last pass using a texture is taken by the
+// next texture with an equal desc whose first pass comes later.
+void FrameGraph::AssignSlots()
+{
+	const size_t resourceCount = resources.size();
+	std::vector<uint32_t> first(resourceCount, InvalidIndex);
+	std::vector<uint32_t> last(resourceCount, InvalidIndex);
+
+	for (uint32_t step = 0; step < schedule.size(); step++)
+	{
+		const PassShape& shape = passes[schedule[step].pass].shape;
+		for (uint32_t j = 0; j < shape.accessCount; j++)
+		{
+			const Access& access = accesses[shape.firstAccess + j];
+			if (resources[access.resource].imported)
+			{
+				continue;
+			}
+
+			if (first[access.resource] == InvalidIndex)
+			{
+				if (access.access == FrameGraphAccess::ShaderResource)
+				{
+					throw std::runtime_error("Frame graph pass reads a transient texture before any pass wrote it.");
+				}
+				first[access.resource] = step;
+			}
+			last[access.resource] = step;
+		}
+	}
+
+	slotDescs.clear();
+	std::vector<uint32_t> freeSlots;
+	for (uint32_t step = 0; step < schedule.size(); step++)
+	{
+		for (size_t r = 0; r < resourceCount; r++)
+		{
+			if (step > 0 && last[r] == step - 1)
+			{
+				freeSlots.push_back(compiledResources[r].slot);
+			}
+		}
+
+		for (size_t r = 0; r < resourceCount; r++)
+		{
+			if (first[r] != step)
+			{
+				continue;
+			}
+
+			const Texture2DDesc& desc = resources[r].desc;
+			auto it = std::find_if(freeSlots.begin(), freeSlots.end(), [&](uint32_t slot) { return TransientResourcePool::Equals(slotDescs[slot], desc); });
+			if (it != freeSlots.end())
+			{
+				compiledResources[r].slot = *it;
+				freeSlots.erase(it);
+			}
+			else
+			{
+				compiledResources[r].slot = static_cast<uint32_t>(slotDescs.size());
+				slotDescs.push_back(desc);
+			}
+		}
+	}
+}
+
+// Replays the schedule against the binding state of every texture. Unbinding shader resources drops every stage's
+// shader resources and the compute unordered access views, unbinding the render targets drops the output merger.
+void FrameGraph::ComputeTransitions()
+{
+	enum class State : uint8_t
+	{
+		None,
+		ShaderResource,
+		Output,
+		UnorderedAccess,
+	};
+
+	// Transient textures are tracked per slot, since aliased ones share their bindings, imported ones after them.
+	const size_t slotCount = slotDescs.size();
+	std::vector<State> states(slotCount + resources.size(), State::None);
+	auto keyOf = [&](uint32_t resource)
+	{
+		return resources[resource].imported ? slotCount + resource : compiledResources[resource].slot;
+	};
+
+	for (CompiledPass& compiledPass : schedule)
+	{
+		const PassShape& shape = passes[compiledPass.pass].shape;
+		uint8_t transitions = 0;
+		for (uint32_t j = 0; j < shape.accessCount; j++)
+		{
+			const Access& access = accesses[shape.firstAccess + j];
+			const State state = states[keyOf(access.resource)];
+			switch (access.access)
+			{
+			case FrameGraphAccess::ShaderResource:
+				if (state == State::Output || state == State::UnorderedAccess)
+				{
+					transitions |= UnbindRenderTargets;
+				}
+				if (state == State::UnorderedAccess)
+				{
+					transitions |= UnbindShaderResources;
+				}
+				break;
+			case FrameGraphAccess::UnorderedAccess:
+				if (state == State::Output)
+				{
+					transitions |= UnbindRenderTargets;
+				}
+				[[fallthrough]];
+			default:
+				if (state == State::ShaderResource)
+				{
+					transitions |= UnbindShaderResources;
+				}
+				break;
+			}
+		}
+
+		for (State& state : states)
+		{
+			if ((transitions & UnbindShaderResources) != 0 && (state == State::ShaderResource || state == State::UnorderedAccess))
+			{
+				state = State::None;
+			}
+			if ((transitions & UnbindRenderTargets) != 0 && (state == State::Output || state == State::UnorderedAccess))
+			{
+				state = State::None;
+			}
+		}
+
+		for (uint32_t j = 0; j < shape.accessCount; j++)
+		{
+			const Access& access = accesses[shape.firstAccess + j];
+			State& state = states[keyOf(access.resource)];
+			switch (access.access)
+			{
+			case FrameGraphAccess::ShaderResource:
+				state = State::ShaderResource;
+				break;
+			case FrameGraphAccess::UnorderedAccess:
+				state = State::UnorderedAccess;
+				break;
+			default:
+				state = State::Output;
+				break;
+			}
+		}
+
+		compiledPass.transitions = transitions;
+		stats.unbinds += ((transitions & UnbindShaderResources) != 0) + ((transitions & UnbindRenderTargets) != 0);
+	}
+}
+
+bool FrameGraph::Compile()
+{
+	if (compiled && MatchesCompiled())
+	{
+		stats.recompiled = false;
+		return false;
+	}
+
+	compiled = false;
+	std::vector<bool> live;
+	Cull(live);
+
+	schedule.clear();
+	for (uint32_t i = 0; i < passes.size(); i++)
+	{
+		if (live[i])
+		{
+			schedule.push_back({ i, 0 });
+		}
+	}
+
+	compiledResources.resize(resources.size());
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		compiledResources[i] = { resources[i].desc, resources[i].imported, InvalidIndex };
+	}
+
+	stats = {};
+	AssignSlots();
+	ComputeTransitions();
+
+	compiledAccesses = accesses;
+	compiledPasses.resize(passes.size());
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		compiledPasses[i] = passes[i].shape;
+	}
+
+	stats.passes = static_cast<uint32_t>(schedule.size());
+	stats.culledPasses = static_cast<uint32_t>(passes.size() - schedule.size());
+	stats.transientTextures = static_cast<uint32_t>(std::count_if(compiledResources.begin(), compiledResources.end(), [](const CompiledResource& resource) { return resource.slot != InvalidIndex; }));
+	stats.physicalTextures = static_cast<uint32_t>(slotDescs.size());
+	stats.recompiled = true;
+	compiled = true;
+	return true;
+}
+
+void FrameGraph::ReleaseSlots() noexcept
+{
+	for (PooledTexture*& texture : slotTextures)
+	{
+		if (texture)
+		{
+			pool->Release(texture);
+			texture = nullptr;
+		}
+	}
+}
+
+void FrameGraph::Execute(CommandList* commandList)
+{
+	Compile();
+
+	slotTextures.assign(slotDescs.size(), nullptr);
+	try
+	{
+		for (size_t slot = 0; slot < slotDescs.size(); slot++)
+		{
+			slotTextures[slot] = pool->AcquireTexture(slotDescs[slot]);
+		}
+
+		for (size_t i = 0; i < resources.size(); i++)
+		{
+			const uint32_t slot = compiledResources[i].slot;
+			if (slot == InvalidIndex)
+			{
+				continue;
+			}
+
+			const PooledTexture* texture = slotTextures[slot];
+			resources[i].views = { texture->texture.Get(), texture->rtv.Get(), texture->srv.Get(), texture->uav.Get(), texture->dsv.Get() };
+		}
+
+		FrameGraphContext context(this, commandList);
+		for (const CompiledPass& compiledPass : schedule)
+		{
+			if ((compiledPass.transitions & UnbindShaderResources) != 0)
+			{
+				commandList->UnbindShaderResources();
+			}
+			if ((compiledPass.transitions & UnbindRenderTargets) != 0)
+			{
+				commandList->SetRenderTarget(nullptr, nullptr);
+			}
+
+			const Pass& pass = passes[compiledPass.pass];
+			commandList->BeginEvent(pass.name);
+			pass.execute(context);
+			commandList->EndEvent();
+		}
+
+		// The pool may hand these textures out in a different role next frame, leave none of them bound.
+		if (!slotTextures.empty())
+		{
+			commandList->UnbindShaderResources();
+			commandList->SetRenderTarget(nullptr, nullptr);
+		}
+	}
+	catch (...)
+	{
+		ReleaseSlots();
+		throw;
+	}
+
+	ReleaseSlots();
+}
+
+HEXA_PRISM_NAMESPACE_END
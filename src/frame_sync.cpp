@@ -0,0 +1,36 @@
+#include "frame_sync.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+void CpuFence::Signal(uint64_t newValue)
+{
+	{
+		std::lock_guard lock(mutex);
+		if (newValue <= value)
+		{
+			return;
+		}
+		value = newValue;
+	}
+	condition.notify_all();
+}
+
+uint64_t CpuFence::GetCompletedValue()
+{
+	std::lock_guard lock(mutex);
+	return value;
+}
+
+bool CpuFence::Wait(uint64_t target, uint32_t timeoutMs)
+{
+	std::unique_lock lock(mutex);
+	if (timeoutMs == Infinite)
+	{
+		condition.wait(lock, [&] { return value >= target; });
+		return true;
+	}
+
+	return condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return value >= target; });
+}
+
+HEXA_PRISM_NAMESPACE_END
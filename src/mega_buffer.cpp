@@ -0,0 +1,163 @@
+#include "mega_buffer.hpp"
+#include <algorithm>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+MegaBuffer::MegaBuffer(GraphicsDevice* device, const MegaBufferDesc& desc)
+	: device(device), desc(desc), allocator(desc.capacity, desc.maxAllocations)
+{
+	buffer = CreateBuffer();
+}
+
+PrismObj<Buffer> MegaBuffer::CreateBuffer()
+{
+	BufferDesc bufferDesc = {};
+	bufferDesc.type = desc.type;
+	bufferDesc.widthInBytes = desc.capacity;
+	bufferDesc.cpuAccessFlags = CpuAccessFlags::None;
+	bufferDesc.gpuAccessFlags = desc.gpuAccessFlags;
+
+	auto result = device->CreateBuffer(bufferDesc, nullptr);
+	if (!result)
+	{
+		throw std::runtime_error("Failed to create mega buffer.");
+	}
+	return result;
+}
+
+const MegaBuffer::Range& MegaBuffer::GetRange(MegaBufferHandle handle) const
+{
+	if (handle.index >= ranges.size() || !ranges[handle.index].live)
+	{
+		throw std::invalid_argument("Mega buffer handle is not live");
+	}
+	return ranges[handle.index];
+}
+
+MegaBufferHandle MegaBuffer::Allocate(uint32_t size, uint32_t alignment)
+{
+	const OffsetAllocation allocation = allocator.Allocate(size, alignment);
+	if (!allocation.IsValid())
+	{
+		return {};
+	}
+
+	uint32_t index;
+	if (!freeHandles.empty())
+	{
+		index = freeHandles.back();
+		freeHandles.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(ranges.size());
+		ranges.emplace_back();
+	}
+
+	ranges[index] = { allocation, size, alignment, true };
+	usedBytes += size;
+	return { index };
+}
+
+void MegaBuffer::Free(MegaBufferHandle handle)
+{
+	if (!handle.IsValid())
+	{
+		return;
+	}
+
+	GetRange(handle);
+	Range& range = ranges[handle.index];
+	allocator.Free(range.allocation);
+	usedBytes -= range.size;
+	range = {};
+	freeHandles.push_back(handle.index);
+}
+
+void MegaBuffer::Upload(CommandList* commandList, MegaBufferHandle handle, const void* data, uint32_t size, uint32_t offset)
+{
+	const Range& range = GetRange(handle);
+	if (offset > range.size || size > range.size - offset)
+	{
+		throw std::invalid_argument("Upload exceeds the mega buffer range");
+	}
+
+	commandList->UpdateBuffer(buffer.Get(), range.allocation.offset + offset, data, size);
+}
+
+uint32_t MegaBuffer::Defragment(CommandList* commandList, PrismObj<Buffer>* previousBuffer)
+{
+	std::vector<uint32_t> order;
+	order.reserve(ranges.size());
+	for (uint32_t i = 0; i < ranges.size(); i++)
+	{
+		if (ranges[i].live)
+		{
+			order.push_back(i);
+		}
+	}
+
+	// Reallocating in offset order packs the ranges front to back and keeps neighbours adjacent, so runs of
+	// ranges that were already packed move with a single copy.
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return ranges[a].allocation.offset < ranges[b].allocation.offset; });
+
+	// Packing is planned on a separate allocator first. Bins round requests up, so a nearly full buffer can fail
+	// to pack, in which case nothing changes.
+	OffsetAllocator packed(desc.capacity, desc.maxAllocations);
+	std::vector<OffsetAllocation> allocations(order.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		allocations[i] = packed.Allocate(ranges[order[i]].size, ranges[order[i]].alignment);
+		if (!allocations[i].IsValid())
+		{
+			return 0;
+		}
+	}
+
+	auto newBuffer = CreateBuffer();
+	allocator = std::move(packed);
+
+	uint32_t copies = 0;
+	uint32_t runSrc = 0;
+	uint32_t runDst = 0;
+	uint32_t runSize = 0;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		Range& range = ranges[order[i]];
+		const uint32_t srcOffset = range.allocation.offset;
+		range.allocation = allocations[i];
+
+		const uint32_t dstOffset = range.allocation.offset;
+		if (runSize != 0 && runSrc + runSize == srcOffset && runDst + runSize == dstOffset)
+		{
+			runSize += range.size;
+			continue;
+		}
+
+		if (runSize != 0)
+		{
+			commandList->CopyBufferRegion(newBuffer.Get(), runDst, buffer.Get(), runSrc, runSize);
+			copies++;
+		}
+
+		runSrc = srcOffset;
+		runDst = dstOffset;
+		runSize = range.size;
+	}
+
+	if (runSize != 0)
+	{
+		commandList->CopyBufferRegion(newBuffer.Get(), runDst, buffer.Get(), runSrc, runSize);
+		copies++;
+	}
+
+	if (previousBuffer)
+	{
+		*previousBuffer = std::move(buffer);
+	}
+	buffer = std::move(newBuffer);
+	generation++;
+	return copies;
+}
+
+HEXA_PRISM_NAMESPACE_END
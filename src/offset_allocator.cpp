@@ -0,0 +1,322 @@
+#include "offset_allocator.hpp"
+#include <bit>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+static constexpr uint32_t MantissaBits = 3;
+static constexpr uint32_t MantissaValue = 1u << MantissaBits;
+static constexpr uint32_t MantissaMask = MantissaValue - 1;
+
+static uint32_t FindLowestSetBitAfter(uint32_t mask, uint32_t start) noexcept
+{
+	const uint64_t before = (uint64_t(1) << start) - 1;
+	const uint32_t after = mask & ~static_cast<uint32_t>(before);
+	return after == 0 ? OffsetAllocation::NoSpace : static_cast<uint32_t>(std::countr_zero(after));
+}
+
+uint32_t OffsetAllocator::SizeToBinRoundUp(uint32_t value) noexcept
+{
+	if (value < MantissaValue)
+	{
+		return value;
+	}
+
+	const uint32_t highestSetBit = 31 - std::countl_zero(value);
+	const uint32_t mantissaStartBit = highestSetBit - MantissaBits;
+	const uint32_t exponent = mantissaStartBit + 1;
+	uint32_t mantissa = (value >> mantissaStartBit) & MantissaMask;
+
+	// A mantissa overflow carries into the exponent, which is the next bin up.
+	if ((value & ((1u << mantissaStartBit) - 1)) != 0)
+	{
+		mantissa++;
+	}
+
+	return (exponent << MantissaBits) + mantissa;
+}
+
+uint32_t OffsetAllocator::SizeToBinRoundDown(uint32_t value) noexcept
+{
+	if (value < MantissaValue)
+	{
+		return value;
+	}
+
+	const uint32_t highestSetBit = 31 - std::countl_zero(value);
+	const uint32_t mantissaStartBit = highestSetBit - MantissaBits;
+	const uint32_t exponent = mantissaStartBit + 1;
+	const uint32_t mantissa = (value >> mantissaStartBit) & MantissaMask;
+	return (exponent << MantissaBits) | mantissa;
+}
+
+uint32_t OffsetAllocator::BinToSize(uint32_t bin) noexcept
+{
+	const uint32_t exponent = bin >> MantissaBits;
+	const uint32_t mantissa = bin & MantissaMask;
+	return exponent == 0 ? mantissa : (mantissa | MantissaValue) << (exponent - 1);
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size, uint32_t maxAllocations) : size(size), maxAllocations(maxAllocations)
+{
+	if (maxAllocations == 0)
+	{
+		throw std::invalid_argument("Offset allocator needs at least one allocation");
+	}
+
+	Reset();
+}
+
+void OffsetAllocator::Reset()
+{
+	freeStorage = 0;
+	usedBinsTop = 0;
+	std::fill_n(usedBins, TopBinCount, uint8_t(0));
+	std::fill_n(binIndices, LeafBinCount, Unused);
+
+	// One node more than allocations, the free space behind the last allocation needs one too.
+	nodes.assign(static_cast<size_t>(maxAllocations) + 1, Node());
+	freeNodes.resize(nodes.size());
+	for (uint32_t i = 0; i < freeNodes.size(); i++)
+	{
+		freeNodes[i] = static_cast<uint32_t>(freeNodes.size()) - i - 1;
+	}
+
+	if (size != 0)
+	{
+		InsertNodeIntoBin(size, 0);
+	}
+}
+
+uint32_t OffsetAllocator::InsertNodeIntoBin(uint32_t dataSize, uint32_t dataOffset)
+{
+	const uint32_t binIndex = SizeToBinRoundDown(dataSize);
+	const uint32_t topBin = binIndex >> MantissaBits;
+	const uint32_t leafBin = binIndex & MantissaMask;
+
+	if (binIndices[binIndex] == Unused)
+	{
+		usedBins[topBin] |= static_cast<uint8_t>(1u << leafBin);
+		usedBinsTop |= 1u << topBin;
+	}
+
+	const uint32_t topNodeIndex = binIndices[binIndex];
+	const uint32_t nodeIndex = freeNodes.back();
+	freeNodes.pop_back();
+
+	Node& node = nodes[nodeIndex];
+	node = Node();
+	node.dataOffset = dataOffset;
+	node.dataSize = dataSize;
+	node.binListNext = topNodeIndex;
+	if (topNodeIndex != Unused)
+	{
+		nodes[topNodeIndex].binListPrev = nodeIndex;
+	}
+	binIndices[binIndex] = nodeIndex;
+
+	freeStorage += dataSize;
+	return nodeIndex;
+}
+
+void OffsetAllocator::RemoveNodeFromBin(uint32_t nodeIndex)
+{
+	Node& node = nodes[nodeIndex];
+
+	if (node.binListPrev != Unused)
+	{
+		nodes[node.binListPrev].binListNext = node.binListNext;
+		if (node.binListNext != Unused)
+		{
+			nodes[node.binListNext].binListPrev = node.binListPrev;
+		}
+	}
+	else
+	{
+		// Head of its bin, the bin may become empty.
+		const uint32_t binIndex = SizeToBinRoundDown(node.dataSize);
+		const uint32_t topBin = binIndex >> MantissaBits;
+		const uint32_t leafBin = binIndex & MantissaMask;
+
+		binIndices[binIndex] = node.binListNext;
+		if (node.binListNext != Unused)
+		{
+			nodes[node.binListNext].binListPrev = Unused;
+		}
+
+		if (binIndices[binIndex] == Unused)
+		{
+			usedBins[topBin] &= static_cast<uint8_t>(~(1u << leafBin));
+			if (usedBins[topBin] == 0)
+			{
+				usedBinsTop &= ~(1u << topBin);
+			}
+		}
+	}
+
+	freeNodes.push_back(nodeIndex);
+	freeStorage -= node.dataSize;
+}
+
+OffsetAllocation OffsetAllocator::Allocate(uint32_t allocationSize, uint32_t alignment)
+{
+	if (alignment == 0)
+	{
+		alignment = 1;
+	}
+
+	const uint64_t paddedSize = static_cast<uint64_t>(allocationSize) + alignment - 1;
+	if (allocationSize == 0 || paddedSize > freeStorage)
+	{
+		return {};
+	}
+
+	const auto requestSize = static_cast<uint32_t>(paddedSize);
+	const uint32_t minBinIndex = SizeToBinRoundUp(requestSize);
+	const uint32_t minTopBin = minBinIndex >> MantissaBits;
+	const uint32_t minLeafBin = minBinIndex & MantissaMask;
+
+	// Rounding the request up to a bin start means every node in the chosen bin fits.
+	uint32_t topBin = minTopBin;
+	uint32_t leafBin = OffsetAllocation::NoSpace;
+	if (topBin < TopBinCount && (usedBinsTop & (1u << topBin)) != 0)
+	{
+		leafBin = FindLowestSetBitAfter(usedBins[topBin], minLeafBin);
+	}
+
+	if (leafBin == OffsetAllocation::NoSpace)
+	{
+		if (minTopBin + 1 >= TopBinCount)
+		{
+			return {};
+		}
+
+		topBin = FindLowestSetBitAfter(usedBinsTop, minTopBin + 1);
+		if (topBin == OffsetAllocation::NoSpace)
+		{
+			return {};
+		}
+		leafBin = static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(usedBins[topBin])));
+	}
+
+	const uint32_t binIndex = (topBin << MantissaBits) | leafBin;
+	const uint32_t nodeIndex = binIndices[binIndex];
+	const uint32_t nodeTotalSize = nodes[nodeIndex].dataSize;
+
+	// Splitting off the remainder takes a node, an exact fit reuses the free node as is.
+	if (nodeTotalSize != requestSize && freeNodes.empty())
+	{
+		return {};
+	}
+
+	RemoveNodeFromBin(nodeIndex);
+	freeNodes.pop_back();
+
+	Node& node = nodes[nodeIndex];
+	node.dataSize = requestSize;
+	node.used = true;
+	node.binListPrev = Unused;
+	node.binListNext = Unused;
+
+	// The remainder stays free as the right neighbour of the allocation.
+	const uint32_t remainder = nodeTotalSize - requestSize;
+	if (remainder > 0)
+	{
+		const uint32_t newNodeIndex = InsertNodeIntoBin(remainder, node.dataOffset + requestSize);
+		Node& newNode = nodes[newNodeIndex];
+		if (node.neighborNext != Unused)
+		{
+			nodes[node.neighborNext].neighborPrev = newNodeIndex;
+		}
+		newNode.neighborPrev = nodeIndex;
+		newNode.neighborNext = node.neighborNext;
+		node.neighborNext = newNodeIndex;
+	}
+
+	const uint32_t alignedOffset = static_cast<uint32_t>((static_cast<uint64_t>(node.dataOffset) + alignment - 1) / alignment * alignment);
+	return { alignedOffset, nodeIndex };
+}
+
+void OffsetAllocator::Free(OffsetAllocation allocation)
+{
+	if (allocation.metadata == OffsetAllocation::NoSpace)
+	{
+		return;
+	}
+
+	if (allocation.metadata >= nodes.size() || !nodes[allocation.metadata].used)
+	{
+		throw std::invalid_argument("Offset allocation is not live");
+	}
+
+	const uint32_t nodeIndex = allocation.metadata;
+	Node& node = nodes[nodeIndex];
+	uint32_t offset = node.dataOffset;
+	uint32_t dataSize = node.dataSize;
+
+	if (node.neighborPrev != Unused && !nodes[node.neighborPrev].used)
+	{
+		const uint32_t prevIndex = node.neighborPrev;
+		const Node& prev = nodes[prevIndex];
+		offset = prev.dataOffset;
+		dataSize += prev.dataSize;
+
+		RemoveNodeFromBin(prevIndex);
+		node.neighborPrev = prev.neighborPrev;
+	}
+
+	if (node.neighborNext != Unused && !nodes[node.neighborNext].used)
+	{
+		const uint32_t nextIndex = node.neighborNext;
+		const Node& next = nodes[nextIndex];
+		dataSize += next.dataSize;
+
+		RemoveNodeFromBin(nextIndex);
+		node.neighborNext = next.neighborNext;
+	}
+
+	const uint32_t neighborPrev = node.neighborPrev;
+	const uint32_t neighborNext = node.neighborNext;
+
+	freeNodes.push_back(nodeIndex);
+	node.used = false;
+
+	const uint32_t combinedIndex = InsertNodeIntoBin(dataSize, offset);
+	nodes[combinedIndex].neighborPrev = neighborPrev;
+	nodes[combinedIndex].neighborNext = neighborNext;
+	if (neighborPrev != Unused)
+	{
+		nodes[neighborPrev].neighborNext = combinedIndex;
+	}
+	if (neighborNext != Unused)
+	{
+		nodes[neighborNext].neighborPrev = combinedIndex;
+	}
+}
+
+uint32_t OffsetAllocator::GetAllocationSize(OffsetAllocation allocation) const
+{
+	if (allocation.metadata >= nodes.size())
+	{
+		return 0;
+	}
+	return nodes[allocation.metadata].dataSize;
+}
+
+OffsetAllocatorReport OffsetAllocator::GetReport() const
+{
+	uint32_t largest = 0;
+	if (usedBinsTop != 0 && !freeNodes.empty())
+	{
+		const uint32_t topBin = 31 - std::countl_zero(usedBinsTop);
+		const uint32_t leafBin = 31 - std::countl_zero(static_cast<uint32_t>(usedBins[topBin]));
+		// Bins only give a lower bound, scan the bin for the exact largest range.
+		for (uint32_t nodeIndex = binIndices[(topBin << MantissaBits) | leafBin]; nodeIndex != Unused; nodeIndex = nodes[nodeIndex].binListNext)
+		{
+			largest = std::max(largest, nodes[nodeIndex].dataSize);
+		}
+	}
+
+	return { freeNodes.empty() ? 0 : freeStorage, largest };
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,186 @@
+#include "radix_sort.hpp"
+#include <barrier>
+#include <cstring>
+#include <thread>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+static constexpr uint32_t RadixBits = 8;
+static constexpr uint32_t RadixSize = 1u << RadixBits;
+static constexpr uint32_t RadixPasses = 64 / RadixBits;
+
+static uint32_t DigitOf(uint64_t key, uint32_t pass)
+{
+	return static_cast<uint32_t>(key >> (pass * RadixBits)) & (RadixSize - 1);
+}
+
+// A pass can be skipped when every key has the same digit in it, the order is left untouched.
+static uint32_t ActivePasses(std::span<const SortItem> items, bool (&active)[RadixPasses])
+{
+	uint64_t differing = 0;
+	const uint64_t first = items[0].key;
+	for (const auto& item : items)
+	{
+		differing |= item.key ^ first;
+	}
+
+	uint32_t count = 0;
+	for (uint32_t pass = 0; pass < RadixPasses; pass++)
+	{
+		active[pass] = DigitOf(differing, pass) != 0;
+		count += active[pass];
+	}
+	return count;
+}
+
+static void SortSerial(std::span<SortItem> items, std::span<SortItem> scratch, const bool (&active)[RadixPasses])
+{
+	SortItem* src = items.data();
+	SortItem* dst = scratch.data();
+	const size_t count = items.size();
+
+	for (uint32_t pass = 0; pass < RadixPasses; pass++)
+	{
+		if (!active[pass])
+		{
+			continue;
+		}
+
+		uint32_t offsets[RadixSize] = {};
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[DigitOf(src[i].key, pass)]++;
+		}
+
+		uint32_t sum = 0;
+		for (auto& offset : offsets)
+		{
+			const uint32_t bucket = offset;
+			offset = sum;
+			sum += bucket;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			dst[offsets[DigitOf(src[i].key, pass)]++] = src[i];
+		}
+
+		std::swap(src, dst);
+	}
+
+	if (src != items.data())
+	{
+		memcpy(items.data(), src, count * sizeof(SortItem));
+	}
+}
+
+static void SortParallel(std::span<SortItem> items, std::span<SortItem> scratch, const bool (&active)[RadixPasses], uint32_t threadCount)
+{
+	const size_t count = items.size();
+	std::vector<uint32_t> histograms(static_cast<size_t>(threadCount) * RadixSize);
+	SortItem* buffers[2] = { items.data(), scratch.data() };
+	uint32_t passIndex = 0;
+	std::barrier sync(threadCount);
+
+	// Every thread owns a fixed slice of the source. Slices scatter to disjoint ranges computed from all histograms,
+	// and lower slices go first within a bucket, which keeps the sort stable.
+	auto worker = [&](uint32_t thread)
+	{
+		const size_t begin = count * thread / threadCount;
+		const size_t end = count * (thread + 1) / threadCount;
+		uint32_t* histogram = histograms.data() + static_cast<size_t>(thread) * RadixSize;
+		uint32_t local = 0;
+
+		for (uint32_t pass = 0; pass < RadixPasses; pass++)
+		{
+			if (!active[pass])
+			{
+				continue;
+			}
+
+			const SortItem* src = buffers[local & 1];
+			SortItem* dst = buffers[(local + 1) & 1];
+
+			std::fill_n(histogram, RadixSize, 0u);
+			for (size_t i = begin; i < end; i++)
+			{
+				histogram[DigitOf(src[i].key, pass)]++;
+			}
+
+			sync.arrive_and_wait();
+
+			uint32_t offsets[RadixSize];
+			uint32_t sum = 0;
+			for (uint32_t bucket = 0; bucket < RadixSize; bucket++)
+			{
+				for (uint32_t other = 0; other < threadCount; other++)
+				{
+					if (other == thread)
+					{
+						offsets[bucket] = sum;
+					}
+					sum += histograms[static_cast<size_t>(other) * RadixSize + bucket];
+				}
+			}
+
+			// The histograms may only be overwritten by the next pass once every thread has read them.
+			sync.arrive_and_wait();
+
+			for (size_t i = begin; i < end; i++)
+			{
+				dst[offsets[DigitOf(src[i].key, pass)]++] = src[i];
+			}
+
+			sync.arrive_and_wait();
+			local++;
+		}
+
+		if (thread == 0)
+		{
+			passIndex = local;
+		}
+	};
+
+	std::vector<std::jthread> threads;
+	threads.reserve(threadCount - 1);
+	for (uint32_t thread = 1; thread < threadCount; thread++)
+	{
+		threads.emplace_back(worker, thread);
+	}
+	worker(0);
+	threads.clear();
+
+	if ((passIndex & 1) != 0)
+	{
+		memcpy(items.data(), scratch.data(), count * sizeof(SortItem));
+	}
+}
+
+void RadixSort(std::span<SortItem> items, std::span<SortItem> scratch, uint32_t threadCount)
+{
+	if (items.size() < 2)
+	{
+		return;
+	}
+
+	if (scratch.size() < items.size())
+	{
+		throw std::invalid_argument("Radix sort scratch buffer is smaller than the input");
+	}
+
+	bool active[RadixPasses];
+	if (ActivePasses(items, active) == 0)
+	{
+		return;
+	}
+
+	if (threadCount <= 1)
+	{
+		SortSerial(items, scratch, active);
+		return;
+	}
+
+	SortParallel(items, scratch, active, threadCount);
+}
+
+HEXA_PRISM_NAMESPACE_END
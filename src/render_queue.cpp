@@ -0,0 +1,180 @@
+#include "render_queue.hpp"
+#include <thread>
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+void RenderQueue::Sort(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	const auto maxThreads = static_cast<uint32_t>(items.size() / MinItemsPerThread);
+	threadCount = std::max(1u, std::min(threadCount, maxThreads));
+
+	scratch.resize(items.size());
+	RadixSort(items, scratch, threadCount);
+}
+
+InstanceStream::InstanceStream(Buffer* buffer, uint32_t slot) : buffer(buffer), slot(slot), ring(buffer->GetDesc().widthInBytes, OffsetAlignment)
+{
+	if (slot == 0)
+	{
+		throw std::invalid_argument("Instance stream slot 0 is reserved for the vertex buffer of the draws");
+	}
+}
+
+uint8_t* InstanceStream::Map(CommandList* commandList, uint32_t size, uint32_t& offset)
+{
+	UploadRingAllocation allocation;
+	if (!ring.Allocate(size, allocation))
+	{
+		throw std::runtime_error("Instance data exceeds the instance stream capacity.");
+	}
+
+	auto mapped = commandList->Map(buffer, 0, allocation.discard ? MapType::WriteDiscard : MapType::WriteNoOverwrite, MapFlags::None);
+	this->mapped = true;
+	offset = allocation.offset;
+	return static_cast<uint8_t*>(mapped.data) + allocation.offset;
+}
+
+void InstanceStream::Unmap(CommandList* commandList)
+{
+	if (mapped)
+	{
+		commandList->Unmap(buffer, 0);
+		mapped = false;
+	}
+}
+
+static bool CanMerge(const DrawPacket& a, const DrawPacket& b) noexcept
+{
+	return a.instanceCount == 1 && b.instanceCount == 1
+		&& a.pipelineState == b.pipelineState
+		&& a.bindingGroup == b.bindingGroup && a.bindingGroupIndex == b.bindingGroupIndex && a.bindingSet == b.bindingSet
+		&& a.vertexBuffer == b.vertexBuffer && a.vertexStride == b.vertexStride && a.vertexOffset == b.vertexOffset
+		&& a.indexBuffer == b.indexBuffer && a.indexFormat == b.indexFormat && a.indexBufferOffset == b.indexBufferOffset
+		&& a.count == b.count && a.startIndex == b.startIndex && a.baseVertex == b.baseVertex && a.startInstance == b.startInstance;
+}
+
+size_t RenderQueue::FindRunEnd(size_t begin) const noexcept
+{
+	const uint32_t first = items[begin].index;
+	const uint32_t size = instanceRanges[first].size;
+	if (size == 0 || !instanceStream)
+	{
+		return begin + 1;
+	}
+
+	// A run is capped by what fits into the stream in one piece.
+	const size_t maxRun = std::max<size_t>(1, instanceStream->GetCapacity() / size);
+	size_t end = begin + 1;
+	while (end < items.size() && end - begin < maxRun)
+	{
+		const uint32_t next = items[end].index;
+		if (instanceRanges[next].size != size || !CanMerge(packets[first], packets[next]))
+		{
+			break;
+		}
+		end++;
+	}
+	return end;
+}
+
+void RenderQueue::Execute(CommandList* commandList)
+{
+	stats = {};
+
+	if (instanceStream)
+	{
+		instanceStream->Reset();
+	}
+
+	const DrawPacket* previous = nullptr;
+	size_t runEnd = 0;
+	for (size_t i = 0; i < items.size(); i = runEnd)
+	{
+		const DrawPacket& packet = packets[items[i].index];
+		const InstanceDataRange& range = instanceRanges[items[i].index];
+		runEnd = FindRunEnd(i);
+
+		if (!previous || previous->pipelineState != packet.pipelineState)
+		{
+			commandList->SetGraphicsPipelineState(packet.pipelineState);
+			stats.pipelineStateChanges++;
+		}
+
+		if (!previous || previous->bindingGroup != packet.bindingGroup || previous->bindingGroupIndex != packet.bindingGroupIndex)
+		{
+			if (previous && previous->bindingGroupIndex != packet.bindingGroupIndex && previous->bindingGroup)
+			{
+				commandList->SetBindingGroup(previous->bindingGroupIndex, nullptr);
+			}
+			commandList->SetBindingGroup(packet.bindingGroupIndex, packet.bindingGroup);
+			stats.bindingChanges++;
+		}
+
+		if (!previous || previous->bindingSet != packet.bindingSet)
+		{
+			commandList->SetBindingSet(packet.bindingSet);
+			stats.bindingChanges++;
+		}
+
+		if (!previous || previous->vertexBuffer != packet.vertexBuffer || previous->vertexStride != packet.vertexStride || previous->vertexOffset != packet.vertexOffset)
+		{
+			commandList->SetVertexBuffer(0, packet.vertexBuffer, packet.vertexStride, packet.vertexOffset);
+			stats.bufferChanges++;
+		}
+
+		uint32_t instanceCount = packet.instanceCount;
+		if (range.size != 0)
+		{
+			if (!instanceStream)
+			{
+				throw std::runtime_error("Draws with instance data require an instance stream.");
+			}
+
+			const auto runLength = static_cast<uint32_t>(runEnd - i);
+			uint32_t offset;
+			uint8_t* dst = instanceStream->Map(commandList, runLength * range.size, offset);
+			for (size_t j = i; j < runEnd; j++)
+			{
+				const InstanceDataRange& source = instanceRanges[items[j].index];
+				memcpy(dst, instanceData.data() + source.offset, source.size);
+				dst += source.size;
+			}
+			instanceStream->Unmap(commandList);
+
+			const uint32_t stride = runLength == 1 && packet.instanceCount != 1 ? 0 : range.size;
+			commandList->SetVertexBuffer(instanceStream->GetSlot(), instanceStream->GetBuffer(), stride, offset);
+			stats.bufferChanges++;
+
+			if (runLength > 1)
+			{
+				instanceCount = runLength;
+				stats.mergedDraws += runLength - 1;
+			}
+		}
+
+		if (packet.indexBuffer)
+		{
+			if (!previous || previous->indexBuffer != packet.indexBuffer || previous->indexFormat != packet.indexFormat || previous->indexBufferOffset != packet.indexBufferOffset)
+			{
+				commandList->SetIndexBuffer(packet.indexBuffer, packet.indexFormat, packet.indexBufferOffset);
+				stats.bufferChanges++;
+			}
+
+			commandList->DrawIndexedInstanced(packet.count, instanceCount, packet.startIndex, packet.baseVertex, packet.startInstance);
+		}
+		else
+		{
+			commandList->DrawInstanced(packet.count, instanceCount, packet.startIndex, packet.startInstance);
+		}
+
+		stats.draws++;
+		previous = &packets[items[runEnd - 1].index];
+	}
+}
+
+HEXA_PRISM_NAMESPACE_END
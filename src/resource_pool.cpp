@@ -0,0 +1,309 @@
+#include "resource_pool.hpp"
+
+HEXA_PRISM_NAMESPACE_BEGIN
+
+static bool HasFlag(GpuAccessFlags flags, GpuAccessFlags flag)
+{
+	return (static_cast<uint32_t>(flags) & static_cast<uint32_t>(flag)) != 0;
+}
+
+static size_t Combine(size_t seed, uint64_t value) noexcept
+{
+	return seed ^ (std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+bool TransientResourcePool::Equals(const Texture2DDesc& a, const Texture2DDesc& b) noexcept
+{
+	return a.gpuAccessFlags == b.gpuAccessFlags && a.cpuAccessFlags == b.cpuAccessFlags && a.format == b.format
+		&& a.width == b.width && a.height == b.height && a.arraySize == b.arraySize && a.mipLevels == b.mipLevels
+		&& a.sampleDesc.count == b.sampleDesc.count && a.sampleDesc.quality == b.sampleDesc.quality && a.miscFlags == b.miscFlags;
+}
+
+bool TransientResourcePool::Equals(const BufferDesc& a, const BufferDesc& b) noexcept
+{
+	return a.type == b.type && a.widthInBytes == b.widthInBytes && a.structureStride == b.structureStride
+		&& a.cpuAccessFlags == b.cpuAccessFlags && a.gpuAccessFlags == b.gpuAccessFlags;
+}
+
+struct DepthFormats
+{
+	Format typeless;
+	Format read;
+};
+
+// Depth formats cannot be bound as shader resources, textures used both ways are created with the typeless format.
+static bool GetDepthFormats(Format format, DepthFormats& formats)
+{
+	switch (format)
+	{
+	case Format::D32Float:
+		formats = { Format::R32Typeless, Format::R32Float };
+		return true;
+	case Format::D24UNormS8UInt:
+		formats = { Format::R24G8Typeless, Format::R24UNormX8Typeless };
+		return true;
+	case Format::D16UNorm:
+		formats = { Format::R16Typeless, Format::R16UNorm };
+		return true;
+	case Format::D32FloatS8X24UInt:
+		formats = { Format::R32G8X24Typeless, Format::R32FloatX8X24Typeless };
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t TransientResourcePool::Hash(const Texture2DDesc& desc) noexcept
+{
+	size_t hash = Combine(0, static_cast<uint64_t>(desc.width) << 32 | desc.height);
+	hash = Combine(hash, static_cast<uint64_t>(desc.arraySize) << 32 | desc.mipLevels);
+	hash = Combine(hash, static_cast<uint64_t>(desc.sampleDesc.count) << 32 | desc.sampleDesc.quality);
+	return Combine(hash, static_cast<uint64_t>(desc.format)
+		| static_cast<uint64_t>(desc.gpuAccessFlags) << 8
+		| static_cast<uint64_t>(desc.cpuAccessFlags) << 16
+		| static_cast<uint64_t>(desc.miscFlags) << 24);
+}
+
+size_t TransientResourcePool::Hash(const BufferDesc& desc) noexcept
+{
+	size_t hash = Combine(0, static_cast<uint64_t>(desc.widthInBytes) << 32 | desc.structureStride);
+	return Combine(hash, static_cast<uint64_t>(desc.type)
+		| static_cast<uint64_t>(desc.cpuAccessFlags) << 32
+		| static_cast<uint64_t>(desc.gpuAccessFlags) << 40);
+}
+
+TransientResourcePool::TransientResourcePool(GraphicsDevice* device, uint32_t evictAfterFrames) : device(device), evictAfterFrames(evictAfterFrames)
+{
+	if (!device)
+	{
+		throw std::invalid_argument("Transient resource pool requires a device");
+	}
+}
+
+void TransientResourcePool::CreateViews(TextureEntry& entry)
+{
+	const Texture2DDesc& desc = entry.desc;
+	const bool array = desc.arraySize > 1;
+	const bool multisampled = desc.sampleDesc.count > 1;
+
+	DepthFormats depthFormats;
+	const bool depth = HasFlag(desc.gpuAccessFlags, GpuAccessFlags::DepthStencil) && GetDepthFormats(desc.format, depthFormats);
+	Resource* resource = entry.texture.Get();
+
+	if (HasFlag(desc.gpuAccessFlags, GpuAccessFlags::Write))
+	{
+		RenderTargetViewDesc rtvDesc = {};
+		rtvDesc.format = desc.format;
+		if (multisampled)
+		{
+			rtvDesc.dimension = array ? RenderTargetViewDimension::Texture2DMSArray : RenderTargetViewDimension::Texture2DMS;
+			rtvDesc.texture2DMSArray = { 0, desc.arraySize };
+		}
+		else
+		{
+			rtvDesc.dimension = array ? RenderTargetViewDimension::Texture2DArray : RenderTargetViewDimension::Texture2D;
+			rtvDesc.texture2DArray = { 0, 0, desc.arraySize };
+		}
+		entry.rtv = device->CreateRenderTargetView(resource, rtvDesc);
+	}
+
+	if (HasFlag(desc.gpuAccessFlags, GpuAccessFlags::Read))
+	{
+		ShaderResourceViewDesc srvDesc = {};
+		srvDesc.format = depth ? depthFormats.read : desc.format;
+		if (multisampled)
+		{
+			srvDesc.dimension = array ? ShaderResourceViewDimension::Texture2DMSArray : ShaderResourceViewDimension::Texture2DMS;
+			srvDesc.texture2DMSArray = { 0, desc.arraySize };
+		}
+		else
+		{
+			srvDesc.dimension = array ? ShaderResourceViewDimension::Texture2DArray : ShaderResourceViewDimension::Texture2D;
+			srvDesc.texture2DArray = { 0, desc.mipLevels == 0 ? UINT32_MAX : desc.mipLevels, 0, desc.arraySize };
+		}
+		entry.srv = device->CreateShaderResourceView(resource, srvDesc);
+	}
+
+	if (HasFlag(desc.gpuAccessFlags, GpuAccessFlags::UA))
+	{
+		UnorderedAccessViewDesc uavDesc = {};
+		uavDesc.format = desc.format;
+		uavDesc.dimension = array ? UnorderedAccessViewDimension::Texture2DArray : UnorderedAccessViewDimension::Texture2D;
+		uavDesc.texture2DArray = { 0, 0, desc.arraySize };
+		entry.uav = device->CreateUnorderedAccessView(resource, uavDesc);
+	}
+
+	if (HasFlag(desc.gpuAccessFlags, GpuAccessFlags::DepthStencil))
+	{
+		DepthStencilViewDesc dsvDesc = {};
+		dsvDesc.format = desc.format;
+		dsvDesc.flags = DepthStencilViewFlags::None;
+		if (multisampled)
+		{
+			dsvDesc.dimension = array ? DepthStencilViewDimension::Texture2DMSArray : DepthStencilViewDimension::Texture2DMS;
+			dsvDesc.texture2DMSArray = { 0, desc.arraySize };
+		}
+		else
+		{
+			dsvDesc.dimension = array ? DepthStencilViewDimension::Texture2DArray : DepthStencilViewDimension::Texture2D;
+			dsvDesc.texture2DArray = { 0, 0, desc.arraySize };
+		}
+		entry.dsv = device->CreateDepthStencilView(resource, dsvDesc);
+	}
+}
+
+PooledTexture* TransientResourcePool::AcquireTexture(const Texture2DDesc& desc)
+{
+	const size_t hash = Hash(desc);
+	auto it = freeTextures.find(hash);
+	if (it != freeTextures.end())
+	{
+		auto& list = it->second;
+		for (size_t i = list.size(); i-- > 0;)
+		{
+			TextureEntry* entry = list[i];
+			if (Equals(entry->desc, desc))
+			{
+				// Taking the most recently released entry lets the older ones age out when demand drops.
+				list.erase(list.begin() + static_cast<ptrdiff_t>(i));
+				entry->acquired = true;
+				entry->lastUsedFrame = frame;
+				frameStats.reused++;
+				totalStats.reused++;
+				return entry;
+			}
+		}
+	}
+
+	auto entry = std::make_unique<TextureEntry>();
+	entry->desc = desc;
+	entry->hash = hash;
+	entry->lastUsedFrame = frame;
+	entry->acquired = true;
+
+	Texture2DDesc createDesc = desc;
+	DepthFormats depthFormats;
+	if (HasFlag(desc.gpuAccessFlags, GpuAccessFlags::DepthStencil) && HasFlag(desc.gpuAccessFlags, GpuAccessFlags::Read) && GetDepthFormats(desc.format, depthFormats))
+	{
+		createDesc.format = depthFormats.typeless;
+	}
+
+	entry->texture = device->CreateTexture2D(createDesc);
+	if (!entry->texture)
+	{
+		throw std::runtime_error("Failed to create a pooled texture.");
+	}
+	CreateViews(*entry);
+
+	frameStats.created++;
+	totalStats.created++;
+	textures.push_back(std::move(entry));
+	return textures.back().get();
+}
+
+PooledBuffer* TransientResourcePool::AcquireBuffer(const BufferDesc& desc)
+{
+	const size_t hash = Hash(desc);
+	auto it = freeBuffers.find(hash);
+	if (it != freeBuffers.end())
+	{
+		auto& list = it->second;
+		for (size_t i = list.size(); i-- > 0;)
+		{
+			BufferEntry* entry = list[i];
+			if (Equals(entry->desc, desc))
+			{
+				list.erase(list.begin() + static_cast<ptrdiff_t>(i));
+				entry->acquired = true;
+				entry->lastUsedFrame = frame;
+				frameStats.reused++;
+				totalStats.reused++;
+				return entry;
+			}
+		}
+	}
+
+	auto entry = std::make_unique<BufferEntry>();
+	entry->desc = desc;
+	entry->hash = hash;
+	entry->lastUsedFrame = frame;
+	entry->acquired = true;
+	entry->buffer = device->CreateBuffer(desc);
+	if (!entry->buffer)
+	{
+		throw std::runtime_error("Failed to create a pooled buffer.");
+	}
+
+	frameStats.created++;
+	totalStats.created++;
+	buffers.push_back(std::move(entry));
+	return buffers.back().get();
+}
+
+void TransientResourcePool::Release(PooledTexture* texture)
+{
+	auto entry = static_cast<TextureEntry*>(texture);
+	if (!entry || !entry->acquired)
+	{
+		throw std::invalid_argument("Texture is not acquired from this pool");
+	}
+
+	entry->acquired = false;
+	entry->lastUsedFrame = frame;
+	freeTextures[entry->hash].push_back(entry);
+}
+
+void TransientResourcePool::Release(PooledBuffer* buffer)
+{
+	auto entry = static_cast<BufferEntry*>(buffer);
+	if (!entry || !entry->acquired)
+	{
+		throw std::invalid_argument("Buffer is not acquired from this pool");
+	}
+
+	entry->acquired = false;
+	entry->lastUsedFrame = frame;
+	freeBuffers[entry->hash].push_back(entry);
+}
+
+template<typename TEntry>
+static uint32_t EvictEntries(std::vector<std::unique_ptr<TEntry>>& entries, std::unordered_map<size_t, std::vector<TEntry*>>& freeLists, uint64_t frame, uint64_t maxAge)
+{
+	auto expired = [&](const TEntry* entry) { return !entry->acquired && frame - entry->lastUsedFrame >= maxAge; };
+
+	// Free lists are kept even when empty, so a desc that comes back does not allocate a new list.
+	for (auto& [hash, list] : freeLists)
+	{
+		std::erase_if(list, expired);
+	}
+
+	const size_t before = entries.size();
+	std::erase_if(entries, [&](const std::unique_ptr<TEntry>& entry) { return expired(entry.get()); });
+	return static_cast<uint32_t>(before - entries.size());
+}
+
+void TransientResourcePool::Evict(uint64_t maxAge)
+{
+	uint32_t evicted = EvictEntries(textures, freeTextures, frame, maxAge);
+	evicted += EvictEntries(buffers, freeBuffers, frame, maxAge);
+	frameStats.evicted += evicted;
+	totalStats.evicted += evicted;
+}
+
+ResourcePoolStats TransientResourcePool::EndFrame()
+{
+	// The age is the number of frames since the last release, so a resource released this frame is at zero.
+	Evict(evictAfterFrames);
+	frame++;
+
+	const ResourcePoolStats stats = frameStats;
+	frameStats = {};
+	return stats;
+}
+
+void TransientResourcePool::Trim()
+{
+	Evict(0);
+}
+
+HEXA_PRISM_NAMESPACE_END
@@ -0,0 +1,148 @@
+#include "binding_tracker.hpp"
+#include "test_common.hpp"
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+// Stands in for a device context: records the (type, stage) ranges a commit submits, the way the backend walks the
+// dirty mask returned by the tracker.
+struct RecordingContext
+{
+	std::vector<uint32_t> submitted;
+
+	void Commit(BindingTracker& tracker, const BindingVersionTable& table, const BindingVersionTable* overrides = nullptr, uint32_t overrideRanges = 0)
+	{
+		submitted.clear();
+		const uint32_t dirty = tracker.Acquire(table, overrides, overrideRanges);
+		for (uint32_t i = 0; i < BindingVersionTable::RangeCount; i++)
+		{
+			if ((dirty & (1u << i)) != 0)
+			{
+				submitted.push_back(i);
+			}
+		}
+	}
+
+	bool SubmittedOnly(std::initializer_list<uint32_t> ranges) const
+	{
+		return submitted == std::vector<uint32_t>(ranges);
+	}
+};
+
+static constexpr uint32_t Index(ShaderParameterType type, ShaderStage stage)
+{
+	return BindingVersionTable::IndexOf(type, stage);
+}
+
+static void TestFirstCommitSubmitsEverything()
+{
+	BindingVersionTable table;
+	BindingTracker tracker;
+	RecordingContext context;
+
+	context.Commit(tracker, table);
+	CHECK(context.submitted.size() == BindingVersionTable::RangeCount);
+	CHECK(tracker.IsBound(table));
+
+	context.Commit(tracker, table);
+	CHECK(context.submitted.empty());
+}
+
+static void TestOnlyChangedRangesAreResubmitted()
+{
+	BindingVersionTable table;
+	BindingTracker tracker;
+	RecordingContext context;
+	context.Commit(tracker, table);
+
+	table.MarkDirty(ShaderParameterType::SRV, ShaderStage::Pixel);
+	context.Commit(tracker, table);
+	CHECK(context.SubmittedOnly({ Index(ShaderParameterType::SRV, ShaderStage::Pixel) }));
+
+	table.MarkDirty(ShaderParameterType::CBV, ShaderStage::Vertex);
+	table.MarkDirty(ShaderParameterType::Sampler, ShaderStage::Compute);
+	context.Commit(tracker, table);
+	CHECK(context.SubmittedOnly({ Index(ShaderParameterType::CBV, ShaderStage::Vertex), Index(ShaderParameterType::Sampler, ShaderStage::Compute) }));
+
+	table.MarkDirty(ShaderParameterType::UAV);
+	context.Commit(tracker, table);
+	CHECK(context.submitted.size() == BindingVersionTable::StageCount);
+	for (uint32_t range : context.submitted)
+	{
+		CHECK(((1u << range) & BindingVersionTable::MaskOf(ShaderParameterType::UAV)) != 0);
+	}
+}
+
+static void TestTwoContextsTrackIndependently()
+{
+	BindingVersionTable table;
+	BindingTracker first;
+	BindingTracker second;
+	RecordingContext context;
+
+	context.Commit(first, table);
+	table.MarkDirty(ShaderParameterType::SRV, ShaderStage::Vertex);
+
+	// The second context never saw the table, it gets everything, the first only the change.
+	context.Commit(second, table);
+	CHECK(context.submitted.size() == BindingVersionTable::RangeCount);
+	context.Commit(first, table);
+	CHECK(context.SubmittedOnly({ Index(ShaderParameterType::SRV, ShaderStage::Vertex) }));
+}
+
+static void TestSwitchingTablesAndInvalidation()
+{
+	BindingVersionTable a;
+	BindingVersionTable b;
+	BindingTracker tracker;
+	RecordingContext context;
+
+	context.Commit(tracker, a);
+	context.Commit(tracker, b);
+	CHECK(context.submitted.size() == BindingVersionTable::RangeCount);
+	CHECK(!tracker.IsBound(a));
+
+	context.Commit(tracker, b);
+	CHECK(context.submitted.empty());
+
+	tracker.Invalidate();
+	context.Commit(tracker, b);
+	CHECK(context.submitted.size() == BindingVersionTable::RangeCount);
+}
+
+static void TestOverrides()
+{
+	BindingVersionTable table;
+	BindingVersionTable overridesA;
+	BindingVersionTable overridesB;
+	BindingTracker tracker;
+	RecordingContext context;
+
+	const uint32_t pixelSrv = Index(ShaderParameterType::SRV, ShaderStage::Pixel);
+	const uint32_t pixelCbv = Index(ShaderParameterType::CBV, ShaderStage::Pixel);
+	context.Commit(tracker, table, &overridesA, 1u << pixelSrv);
+
+	// Unchanged overrides submit nothing, changes in the override table are picked up.
+	context.Commit(tracker, table, &overridesA, 1u << pixelSrv);
+	CHECK(context.submitted.empty());
+	overridesA.MarkDirty(ShaderParameterType::SRV, ShaderStage::Pixel);
+	context.Commit(tracker, table, &overridesA, 1u << pixelSrv);
+	CHECK(context.SubmittedOnly({ pixelSrv }));
+
+	// Swapping the override table resubmits what the old and the new one may patch.
+	context.Commit(tracker, table, &overridesB, 1u << pixelCbv);
+	CHECK(context.SubmittedOnly({ pixelSrv, pixelCbv }));
+
+	// Dropping the overrides restores the ranges they patched.
+	context.Commit(tracker, table);
+	CHECK(context.SubmittedOnly({ pixelCbv }));
+}
+
+int main()
+{
+	TestFirstCommitSubmitsEverything();
+	TestOnlyChangedRangesAreResubmitted();
+	TestTwoContextsTrackIndependently();
+	TestSwitchingTablesAndInvalidation();
+	TestOverrides();
+	return TestResult();
+}
@@ -0,0 +1,193 @@
+#include "frame_graph.hpp"
+#include "test_common.hpp"
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+// Compiling a graph never touches the device, only Execute acquires textures from the pool.
+class NullDevice : public GraphicsDevice
+{
+	[[noreturn]] static void Fail()
+	{
+		throw std::runtime_error("NullDevice does not create resources.");
+	}
+
+public:
+	CommandList* GetImmediateCommandList() override { Fail(); }
+	GlobalResourceList& GetGlobalResourceList() override { Fail(); }
+	PrismObj<Buffer> CreateBuffer(const BufferDesc&, const SubresourceData*) override { Fail(); }
+	PrismObj<Texture1D> CreateTexture1D(const Texture1DDesc&, const SubresourceData*) override { Fail(); }
+	PrismObj<Texture2D> CreateTexture2D(const Texture2DDesc&, const SubresourceData*) override { Fail(); }
+	PrismObj<Texture3D> CreateTexture3D(const Texture3DDesc&, const SubresourceData*) override { Fail(); }
+	PrismObj<RenderTargetView> CreateRenderTargetView(Resource*, const RenderTargetViewDesc&) override { Fail(); }
+	PrismObj<ShaderResourceView> CreateShaderResourceView(Resource*, const ShaderResourceViewDesc&) override { Fail(); }
+	PrismObj<DepthStencilView> CreateDepthStencilView(Resource*, const DepthStencilViewDesc&) override { Fail(); }
+	PrismObj<UnorderedAccessView> CreateUnorderedAccessView(Resource*, const UnorderedAccessViewDesc&) override { Fail(); }
+	PrismObj<SamplerState> CreateSamplerState(const SamplerDesc&) override { Fail(); }
+	PrismObj<CommandList> CreateCommandList() override { Fail(); }
+	PrismObj<BindingSet> CreateBindingSet() override { Fail(); }
+	PrismObj<BindingGroup> CreateBindingGroup(const BindingGroupDesc&) override { Fail(); }
+	PrismObj<GraphicsPipeline> CreateGraphicsPipeline(const GraphicsPipelineDesc&) override { Fail(); }
+	PrismObj<GraphicsPipelineState> CreateGraphicsPipelineState(GraphicsPipeline*, const GraphicsPipelineStateDesc&) override { Fail(); }
+	PrismObj<ComputePipeline> CreateComputePipeline(const ComputePipelineDesc&) override { Fail(); }
+	PrismObj<ComputePipelineState> CreateComputePipelineState(ComputePipeline*, const ComputePipelineStateDesc&) override { Fail(); }
+	PrismObj<SwapChain> CreateSwapChain(void*, const SwapChainDesc&, const SwapChainFullscreenDesc&) override { Fail(); }
+	PrismObj<SwapChain> CreateSwapChain(void*) override { Fail(); }
+	PrismObj<Query> CreateQuery(const QueryDesc&) override { Fail(); }
+	PrismObj<Fence> CreateFence(uint64_t) override { Fail(); }
+	PrismObj<NativeCommandBundle> CreateNativeBundle(const CommandStream&) override { Fail(); }
+	PrismObj<UploadContext> CreateUploadContext(uint32_t, uint32_t) override { Fail(); }
+	PrismObj<Readback> ReadbackAsync(Resource*, uint32_t, const Box*) override { Fail(); }
+};
+
+static Texture2DDesc MakeDesc(Format format, GpuAccessFlags access)
+{
+	Texture2DDesc desc = {};
+	desc.gpuAccessFlags = access;
+	desc.format = format;
+	desc.width = 1280;
+	desc.height = 720;
+	desc.arraySize = 1;
+	desc.mipLevels = 1;
+	desc.sampleDesc.count = 1;
+	return desc;
+}
+
+static const Texture2DDesc depthDesc = MakeDesc(Format::D24UNormS8UInt, GpuAccessFlags::DepthStencil);
+static const Texture2DDesc colorDesc = MakeDesc(Format::R16G16B16A16Float, GpuAccessFlags::RW);
+static const Texture2DDesc uavDesc = MakeDesc(Format::R16G16B16A16Float, GpuAccessFlags::All);
+
+static void Nothing(FrameGraphContext&)
+{
+}
+
+struct GraphFixture
+{
+	NullDevice device;
+	TransientResourcePool pool{ &device };
+	FrameGraph graph{ &pool };
+	FrameGraphResource backbuffer = graph.ImportTexture("Backbuffer", {});
+};
+
+// The main pass depth tests against the prepass output without reading it as a shader resource, the prepass must
+// survive and the depth texture must stay allocated across both passes.
+static void TestDepthPrepassIsKept()
+{
+	GraphFixture fixture;
+	FrameGraph& graph = fixture.graph;
+	const FrameGraphResource depth = graph.CreateTexture("Depth", depthDesc);
+
+	graph.AddPass("DepthPrepass", Nothing).Write(depth, FrameGraphAccess::DepthStencil);
+	graph.AddPass("Main", Nothing).Write(depth, FrameGraphAccess::DepthStencil).Write(fixture.backbuffer, FrameGraphAccess::RenderTarget);
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetStats().passes == 2);
+	CHECK(graph.GetStats().culledPasses == 0);
+	CHECK(graph.GetStats().transientTextures == 1);
+	CHECK(graph.GetStats().physicalTextures == 1);
+	CHECK(graph.GetStats().unbinds == 0);
+}
+
+// Blending onto a texture and accumulating into a UAV keep the passes that wrote the earlier contents.
+static void TestRenderTargetAndUnorderedAccessWritesLoad()
+{
+	GraphFixture fixture;
+	FrameGraph& graph = fixture.graph;
+	const FrameGraphResource color = graph.CreateTexture("Color", colorDesc);
+	const FrameGraphResource accumulation = graph.CreateTexture("Accumulation", uavDesc);
+
+	graph.AddPass("Opaque", Nothing).Write(color, FrameGraphAccess::RenderTarget);
+	graph.AddPass("Transparent", Nothing).Write(color, FrameGraphAccess::RenderTarget);
+	graph.AddPass("Clear", Nothing).Write(accumulation, FrameGraphAccess::UnorderedAccess);
+	graph.AddPass("Accumulate", Nothing).Read(color).Write(accumulation, FrameGraphAccess::UnorderedAccess);
+	graph.AddPass("Resolve", Nothing).Read(accumulation).Write(fixture.backbuffer, FrameGraphAccess::RenderTarget);
+
+	graph.Compile();
+	CHECK(graph.GetStats().passes == 5);
+	CHECK(graph.GetStats().culledPasses == 0);
+}
+
+// Passes whose outputs nothing accesses are still culled, along with the passes only they depend on.
+static void TestUnusedOutputsAreCulled()
+{
+	GraphFixture fixture;
+	FrameGraph& graph = fixture.graph;
+	const FrameGraphResource depth = graph.CreateTexture("Depth", depthDesc);
+	const FrameGraphResource debug = graph.CreateTexture("Debug", colorDesc);
+	const FrameGraphResource debugBlur = graph.CreateTexture("DebugBlur", colorDesc);
+
+	graph.AddPass("DepthPrepass", Nothing).Write(depth, FrameGraphAccess::DepthStencil);
+	graph.AddPass("Debug", Nothing).Read(depth).Write(debug, FrameGraphAccess::RenderTarget);
+	graph.AddPass("DebugBlur", Nothing).Read(debug).Write(debugBlur, FrameGraphAccess::RenderTarget);
+	graph.AddPass("Main", Nothing).Write(depth, FrameGraphAccess::DepthStencil).Write(fixture.backbuffer, FrameGraphAccess::RenderTarget);
+
+	graph.Compile();
+	CHECK(graph.GetStats().passes == 2);
+	CHECK(graph.GetStats().culledPasses == 2);
+	CHECK(graph.GetStats().transientTextures == 1);
+
+	// A side effect keeps the debug chain alive.
+	graph.Reset();
+	const FrameGraphResource depth2 = graph.CreateTexture("Depth", depthDesc);
+	const FrameGraphResource debug2 = graph.CreateTexture("Debug", colorDesc);
+	graph.AddPass("DepthPrepass", Nothing).Write(depth2, FrameGraphAccess::DepthStencil);
+	graph.AddPass("Debug", Nothing).Read(depth2).Write(debug2, FrameGraphAccess::RenderTarget).SetSideEffects();
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetStats().passes == 2);
+	CHECK(graph.GetStats().culledPasses == 0);
+	// The depth buffer is read after it was written as depth stencil.
+	CHECK(graph.GetStats().unbinds == 1);
+}
+
+// Reading a transient texture no live pass wrote is an error, the contents would be undefined.
+static void TestReadBeforeWriteThrows()
+{
+	GraphFixture fixture;
+	FrameGraph& graph = fixture.graph;
+	const FrameGraphResource color = graph.CreateTexture("Color", colorDesc);
+
+	graph.AddPass("Present", Nothing).Read(color).Write(fixture.backbuffer, FrameGraphAccess::RenderTarget);
+	CHECK_THROWS(graph.Compile());
+}
+
+// Textures with equal descs and disjoint lifetimes share a pooled texture.
+static void TestDisjointLifetimesAlias()
+{
+	GraphFixture fixture;
+	FrameGraph& graph = fixture.graph;
+	const FrameGraphResource a = graph.CreateTexture("A", colorDesc);
+	const FrameGraphResource b = graph.CreateTexture("B", colorDesc);
+	const FrameGraphResource c = graph.CreateTexture("C", colorDesc);
+
+	graph.AddPass("WriteA", Nothing).Write(a, FrameGraphAccess::RenderTarget);
+	graph.AddPass("AToB", Nothing).Read(a).Write(b, FrameGraphAccess::RenderTarget);
+	graph.AddPass("BToC", Nothing).Read(b).Write(c, FrameGraphAccess::RenderTarget);
+	graph.AddPass("Present", Nothing).Read(c).Write(fixture.backbuffer, FrameGraphAccess::RenderTarget);
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetStats().passes == 4);
+	CHECK(graph.GetStats().transientTextures == 3);
+	CHECK(graph.GetStats().physicalTextures == 2);
+
+	// The same declaration next frame reuses the compiled graph.
+	graph.Reset();
+	const FrameGraphResource backbuffer = graph.ImportTexture("Backbuffer", {});
+	const FrameGraphResource a2 = graph.CreateTexture("A", colorDesc);
+	const FrameGraphResource b2 = graph.CreateTexture("B", colorDesc);
+	const FrameGraphResource c2 = graph.CreateTexture("C", colorDesc);
+	graph.AddPass("WriteA", Nothing).Write(a2, FrameGraphAccess::RenderTarget);
+	graph.AddPass("AToB", Nothing).Read(a2).Write(b2, FrameGraphAccess::RenderTarget);
+	graph.AddPass("BToC", Nothing).Read(b2).Write(c2, FrameGraphAccess::RenderTarget);
+	graph.AddPass("Present", Nothing).Read(c2).Write(backbuffer, FrameGraphAccess::RenderTarget);
+	CHECK(!graph.Compile());
+}
+
+int main()
+{
+	TestDepthPrepassIsKept();
+	TestRenderTargetAndUnorderedAccessWritesLoad();
+	TestUnusedOutputsAreCulled();
+	TestReadBeforeWriteThrows();
+	TestDisjointLifetimesAlias();
+	return TestResult();
+}
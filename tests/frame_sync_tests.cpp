@@ -0,0 +1,160 @@
+#include "frame_sync.hpp"
+#include "test_common.hpp"
+#include <thread>
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+struct TestFrame
+{
+	int uses = 0;
+};
+
+// Records the signaled values in place of a command list, the test decides when the fence completes them.
+struct RecordingCommandList
+{
+	std::vector<uint64_t> signaled;
+
+	void Signal(Fence*, uint64_t value)
+	{
+		signaled.push_back(value);
+	}
+};
+
+static void TestCpuFence()
+{
+	CpuFence fence(5);
+	CHECK(fence.GetCompletedValue() == 5);
+	CHECK(fence.Wait(5, 0));
+	CHECK(!fence.Wait(6, 0));
+
+	fence.Signal(7);
+	CHECK(fence.GetCompletedValue() == 7);
+
+	// Values never go backwards.
+	fence.Signal(3);
+	CHECK(fence.GetCompletedValue() == 7);
+	CHECK(fence.Wait(6, 0));
+}
+
+static void TestInvalidUseThrows()
+{
+	CpuFence fence;
+	CHECK_THROWS(FrameRing<TestFrame>(&fence, 0));
+
+	FrameRing<TestFrame> ring(&fence, 2);
+	CHECK_THROWS(ring.EndFrame());
+	CHECK(ring.BeginFrame(0) != nullptr);
+	CHECK_THROWS(ring.BeginFrame(0));
+}
+
+static void TestFrameValuesContinueAfterFence()
+{
+	CpuFence fence(41);
+	FrameRing<TestFrame> ring(&fence, 3);
+	CHECK(ring.GetLastSubmittedValue() == 41);
+
+	CHECK(ring.BeginFrame(0) != nullptr);
+	CHECK(ring.GetFrameIndex() == 0);
+	CHECK(ring.EndFrame() == 42);
+	CHECK(ring.GetLastSubmittedValue() == 42);
+}
+
+// Every slot starts unused, the first lap never waits. The second lap waits for the frame that last used the slot,
+// and only for that one.
+static void TestSlotReuseWaits()
+{
+	CpuFence fence;
+	FrameRing<TestFrame> ring(&fence, 2);
+	RecordingCommandList commandList;
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		TestFrame* frame = ring.BeginFrame(0);
+		CHECK(frame != nullptr);
+		CHECK(ring.GetFrameIndex() == i);
+		frame->uses++;
+		ring.EndFrame(&commandList);
+	}
+	CHECK(commandList.signaled.size() == 2);
+	CHECK(commandList.signaled[0] == 1 && commandList.signaled[1] == 2);
+
+	// Slot 0 was last used by frame 1, which has not completed.
+	CHECK(ring.BeginFrame(0) == nullptr);
+
+	// Completing frame 1 frees slot 0 while frame 2 is still in flight.
+	fence.Signal(1);
+	TestFrame* frame = ring.BeginFrame(0);
+	CHECK(frame == &ring.GetFrame(0));
+	CHECK(frame->uses == 1);
+	frame->uses++;
+	CHECK(ring.EndFrame() == 3);
+
+	// Slot 1 waits for frame 2.
+	CHECK(ring.BeginFrame(0) == nullptr);
+	fence.Signal(2);
+	CHECK(ring.BeginFrame(0) == &ring.GetFrame(1));
+	ring.EndFrame();
+}
+
+// A timed out BeginFrame leaves the ring on the previous slot, so a retry waits for the same frame.
+static void TestBeginFrameTimeoutAndRetry()
+{
+	CpuFence fence;
+	FrameRing<TestFrame> ring(&fence, 1);
+
+	CHECK(ring.BeginFrame(0) != nullptr);
+	CHECK(ring.EndFrame() == 1);
+
+	CHECK(ring.BeginFrame(10) == nullptr);
+	CHECK(ring.GetFrameIndex() == 0);
+	CHECK(ring.BeginFrame(0) == nullptr);
+
+	// The retry blocks until another thread completes the frame.
+	std::thread signaler([&]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		fence.Signal(1);
+	});
+	CHECK(ring.BeginFrame() != nullptr);
+	signaler.join();
+	CHECK(ring.EndFrame() == 2);
+}
+
+static void TestWaitIdle()
+{
+	CpuFence fence;
+	FrameRing<TestFrame> ring(&fence, 3);
+
+	// Nothing in flight.
+	CHECK(ring.WaitIdle(0));
+
+	for (int i = 0; i < 3; i++)
+	{
+		CHECK(ring.BeginFrame(0) != nullptr);
+		ring.EndFrame();
+	}
+
+	// Waits for the last frame, not only the oldest one.
+	fence.Signal(2);
+	CHECK(!ring.WaitIdle(0));
+
+	std::thread signaler([&]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		fence.Signal(3);
+	});
+	CHECK(ring.WaitIdle());
+	signaler.join();
+	CHECK(fence.GetCompletedValue() == 3);
+}
+
+int main()
+{
+	TestCpuFence();
+	TestInvalidUseThrows();
+	TestFrameValuesContinueAfterFence();
+	TestSlotReuseWaits();
+	TestBeginFrameTimeoutAndRetry();
+	TestWaitIdle();
+	return TestResult();
+}
@@ -0,0 +1,142 @@
+#include "offset_allocator.hpp"
+#include "test_common.hpp"
+#include <map>
+#include <random>
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+// Best fit over ordered maps with neighbour merging, the usual allocator the TLSF bins replace.
+class MapAllocator
+{
+	std::map<uint32_t, uint32_t> freeByOffset;
+	std::multimap<uint32_t, uint32_t> freeBySize;
+
+	void Insert(uint32_t offset, uint32_t size)
+	{
+		freeByOffset.emplace(offset, size);
+		freeBySize.emplace(size, offset);
+	}
+
+	void Erase(std::map<uint32_t, uint32_t>::iterator it)
+	{
+		auto [first, last] = freeBySize.equal_range(it->second);
+		for (; first != last; ++first)
+		{
+			if (first->second == it->first)
+			{
+				freeBySize.erase(first);
+				break;
+			}
+		}
+		freeByOffset.erase(it);
+	}
+
+public:
+	explicit MapAllocator(uint32_t size)
+	{
+		Insert(0, size);
+	}
+
+	uint32_t Allocate(uint32_t size)
+	{
+		auto it = freeBySize.lower_bound(size);
+		if (it == freeBySize.end())
+		{
+			return UINT32_MAX;
+		}
+
+		const uint32_t offset = it->second;
+		const uint32_t remainder = it->first - size;
+		Erase(freeByOffset.find(offset));
+		if (remainder > 0)
+		{
+			Insert(offset + size, remainder);
+		}
+		return offset;
+	}
+
+	void Free(uint32_t offset, uint32_t size)
+	{
+		auto next = freeByOffset.lower_bound(offset);
+		if (next != freeByOffset.end() && next->first == offset + size)
+		{
+			size += next->second;
+			Erase(next);
+		}
+
+		next = freeByOffset.lower_bound(offset);
+		if (next != freeByOffset.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				size += prev->second;
+				Erase(prev);
+			}
+		}
+		Insert(offset, size);
+	}
+};
+
+// Replaces one random allocation of a fragmented working set per iteration, so every operation searches and merges.
+int main()
+{
+	constexpr uint64_t Iterations = 2'000'000;
+	constexpr uint32_t Capacity = 256u << 20;
+	constexpr size_t WorkingSet = 8192;
+
+	std::mt19937 random(42);
+	std::vector<uint32_t> sizes(Iterations + WorkingSet);
+	std::vector<uint32_t> victims(Iterations);
+	for (auto& size : sizes)
+	{
+		size = 16 + random() % (random() % 8 == 0 ? 65536 : 4096);
+	}
+	for (auto& victim : victims)
+	{
+		victim = static_cast<uint32_t>(random() % WorkingSet);
+	}
+
+	{
+		OffsetAllocator allocator(Capacity, static_cast<uint32_t>(WorkingSet * 2));
+		std::vector<OffsetAllocation> live(WorkingSet);
+		for (size_t i = 0; i < WorkingSet; i++)
+		{
+			live[i] = allocator.Allocate(sizes[i], 16);
+		}
+
+		Benchmark("OffsetAllocator free + allocate", Iterations, [&](uint64_t i)
+		{
+			OffsetAllocation& slot = live[victims[i]];
+			allocator.Free(slot);
+			slot = allocator.Allocate(sizes[WorkingSet + i], 16);
+			DoNotOptimize(slot.offset);
+		});
+	}
+
+	{
+		MapAllocator allocator(Capacity);
+		std::vector<uint32_t> offsets(WorkingSet);
+		std::vector<uint32_t> liveSizes(WorkingSet);
+		for (size_t i = 0; i < WorkingSet; i++)
+		{
+			liveSizes[i] = (sizes[i] + 15) & ~15u;
+			offsets[i] = allocator.Allocate(liveSizes[i]);
+		}
+
+		Benchmark("std::map best fit free + allocate", Iterations, [&](uint64_t i)
+		{
+			const uint32_t victim = victims[i];
+			if (offsets[victim] != UINT32_MAX)
+			{
+				allocator.Free(offsets[victim], liveSizes[victim]);
+			}
+			liveSizes[victim] = (sizes[WorkingSet + i] + 15) & ~15u;
+			offsets[victim] = allocator.Allocate(liveSizes[victim]);
+			DoNotOptimize(offsets[victim]);
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include "offset_allocator.hpp"
+#include "test_common.hpp"
+#include <map>
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+static void TestBinRounding()
+{
+	for (uint32_t size = 1; size < 1u << 20; size = size * 3 / 2 + 1)
+	{
+		CHECK(OffsetAllocator::BinToSize(OffsetAllocator::SizeToBinRoundUp(size)) >= size);
+		CHECK(OffsetAllocator::BinToSize(OffsetAllocator::SizeToBinRoundDown(size)) <= size);
+	}
+
+	// Small sizes and exact bin sizes map to themselves. The top bins lie beyond 32 bit sizes.
+	const uint32_t lastBin = OffsetAllocator::SizeToBinRoundDown(UINT32_MAX);
+	CHECK(OffsetAllocator::SizeToBinRoundUp(UINT32_MAX) == lastBin + 1);
+	for (uint32_t bin = 0; bin <= lastBin; bin++)
+	{
+		const uint32_t size = OffsetAllocator::BinToSize(bin);
+		CHECK(OffsetAllocator::SizeToBinRoundUp(size) == bin);
+		CHECK(OffsetAllocator::SizeToBinRoundDown(size) == bin);
+	}
+}
+
+static void TestSimpleAllocateAndFree()
+{
+	OffsetAllocator allocator(1024);
+
+	OffsetAllocation a = allocator.Allocate(100);
+	OffsetAllocation b = allocator.Allocate(200);
+	CHECK(a.IsValid() && b.IsValid());
+	CHECK(a.offset == 0);
+	CHECK(b.offset == 100);
+	CHECK(allocator.GetReport().totalFree == 1024 - 300);
+
+	CHECK(!allocator.Allocate(0).IsValid());
+	CHECK(!allocator.Allocate(2048).IsValid());
+
+	allocator.Free(a);
+	allocator.Free(b);
+	const OffsetAllocatorReport report = allocator.GetReport();
+	CHECK(report.totalFree == 1024);
+	CHECK(report.largestFree == 1024);
+
+	// Freeing an invalid allocation is a no-op, freeing twice throws.
+	allocator.Free(OffsetAllocation{});
+	CHECK_THROWS(allocator.Free(a));
+}
+
+static void TestNodeExhaustion()
+{
+	OffsetAllocator allocator(1024, 4);
+	OffsetAllocation allocations[4];
+	for (auto& allocation : allocations)
+	{
+		allocation = allocator.Allocate(16);
+		CHECK(allocation.IsValid());
+	}
+	CHECK(!allocator.Allocate(16).IsValid());
+
+	// An exact fit reuses the freed node, a smaller request would need a second one for the remainder.
+	allocator.Free(allocations[1]);
+	CHECK(!allocator.Allocate(8).IsValid());
+	CHECK(allocator.Allocate(16).offset == 16);
+}
+
+static void TestResetFreesEverything()
+{
+	OffsetAllocator allocator(4096);
+	for (int i = 0; i < 10; i++)
+	{
+		CHECK(allocator.Allocate(100, 64).IsValid());
+	}
+
+	allocator.Reset();
+	CHECK(allocator.GetReport().totalFree == 4096);
+	CHECK(allocator.Allocate(4096).offset == 0);
+}
+
+struct LiveRange
+{
+	OffsetAllocation allocation;
+	uint32_t size;
+};
+
+// Random allocations and frees against a map of the live ranges: no two ranges overlap, every range lies inside the
+// allocator and honours its alignment, and freeing everything merges the space back into one range.
+static void TestRandomStress()
+{
+	constexpr uint32_t capacity = 1u << 24;
+	OffsetAllocator allocator(capacity, 4096);
+
+	std::vector<LiveRange> live;
+	std::map<uint32_t, uint32_t> ranges;
+	uint32_t state = 0x2545f491u;
+	auto next = [&]() {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	};
+
+	const uint32_t alignments[] = { 1, 4, 16, 48, 256, 4096 };
+	uint32_t failed = 0;
+	for (int i = 0; i < 200000; i++)
+	{
+		if (live.empty() || (live.size() < 2000 && next() % 2 == 0))
+		{
+			const uint32_t size = 1 + next() % (next() % 8 == 0 ? 65536 : 1024);
+			const uint32_t alignment = alignments[next() % std::size(alignments)];
+			const OffsetAllocation allocation = allocator.Allocate(size, alignment);
+			if (!allocation.IsValid())
+			{
+				failed++;
+				continue;
+			}
+
+			CHECK(allocation.offset % alignment == 0);
+			CHECK(static_cast<uint64_t>(allocation.offset) + size <= capacity);
+			CHECK(allocator.GetAllocationSize(allocation) >= size);
+
+			auto after = ranges.lower_bound(allocation.offset);
+			CHECK(after == ranges.end() || after->first >= allocation.offset + size);
+			if (after != ranges.begin())
+			{
+				auto before = std::prev(after);
+				CHECK(before->first + before->second <= allocation.offset);
+			}
+
+			ranges.emplace(allocation.offset, size);
+			live.push_back({ allocation, size });
+		}
+		else
+		{
+			const size_t index = next() % live.size();
+			allocator.Free(live[index].allocation);
+			ranges.erase(live[index].allocation.offset);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	// The working set fills about half of the capacity, fragmentation may fail the odd large request.
+	CHECK(failed < 200000 / 1000);
+
+	for (const auto& range : live)
+	{
+		allocator.Free(range.allocation);
+	}
+
+	const OffsetAllocatorReport report = allocator.GetReport();
+	CHECK(report.totalFree == capacity);
+	CHECK(report.largestFree == capacity);
+}
+
+int main()
+{
+	TestBinRounding();
+	TestSimpleAllocateAndFree();
+	TestNodeExhaustion();
+	TestResetFreesEverything();
+	TestRandomStress();
+	return TestResult();
+}
@@ -0,0 +1,126 @@
+#include "radix_sort.hpp"
+#include "test_common.hpp"
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+static uint64_t NextRandom(uint64_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// Sorts a copy with RadixSort and with std::stable_sort on the key, both must agree on every index, which checks
+// the order and the stability of equal keys at once.
+static void CheckMatchesStableSort(std::vector<SortItem> items, uint32_t threadCount)
+{
+	std::vector<SortItem> expected = items;
+	std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+
+	std::vector<SortItem> scratch(items.size());
+	RadixSort(items, scratch, threadCount);
+
+	bool same = true;
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		same &= items[i].key == expected[i].key && items[i].index == expected[i].index;
+	}
+	CHECK(same);
+}
+
+// Builds 'count' items whose keys are random within 'mask', indices follow the input order.
+static std::vector<SortItem> MakeItems(size_t count, uint64_t mask, uint64_t seed)
+{
+	std::vector<SortItem> items(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		items[i] = { NextRandom(seed) & mask, static_cast<uint32_t>(i) };
+	}
+	return items;
+}
+
+static const uint32_t threadCounts[] = { 1, 2, 3, 8 };
+
+static void TestRandomKeys()
+{
+	for (uint32_t threads : threadCounts)
+	{
+		CheckMatchesStableSort(MakeItems(10007, ~uint64_t(0), 1), threads);
+	}
+}
+
+// Few distinct keys, so most items share their key with many others.
+static void TestEqualKeys()
+{
+	for (uint32_t threads : threadCounts)
+	{
+		CheckMatchesStableSort(MakeItems(5000, 0x0300'0000'0000'0007ull, 2), threads);
+	}
+}
+
+// All keys identical, every pass is skipped and the order is untouched.
+static void TestIdenticalKeys()
+{
+	for (uint32_t threads : threadCounts)
+	{
+		CheckMatchesStableSort(MakeItems(1000, 0, 3), threads);
+	}
+}
+
+// Keys that differ in a single digit sort in one pass, the result lands in the scratch buffer and is copied back.
+static void TestSingleActivePass()
+{
+	for (uint32_t threads : threadCounts)
+	{
+		CheckMatchesStableSort(MakeItems(4099, 0xff00, 4), threads);
+
+		// Three active passes, odd again, with the unused digits set to a constant.
+		auto items = MakeItems(4099, 0x00ff'0000'00ff'00ffull, 5);
+		for (auto& item : items)
+		{
+			item.key |= 0x1200'0000'0000'0000ull;
+		}
+		CheckMatchesStableSort(items, threads);
+	}
+}
+
+// Two active passes end in the input buffer without a copy.
+static void TestEvenActivePasses()
+{
+	for (uint32_t threads : threadCounts)
+	{
+		CheckMatchesStableSort(MakeItems(3001, 0xffff, 6), threads);
+	}
+}
+
+// More threads than items leaves some slices empty.
+static void TestSmallInputs()
+{
+	for (size_t count = 0; count < 12; count++)
+	{
+		for (uint32_t threads : threadCounts)
+		{
+			CheckMatchesStableSort(MakeItems(count, 0xff'ffff, 7 + count), threads);
+		}
+	}
+}
+
+static void TestSmallScratchThrows()
+{
+	auto items = MakeItems(16, ~uint64_t(0), 8);
+	std::vector<SortItem> scratch(15);
+	CHECK_THROWS(RadixSort(items, scratch));
+}
+
+int main()
+{
+	TestRandomKeys();
+	TestEqualKeys();
+	TestIdenticalKeys();
+	TestSingleActivePass();
+	TestEvenActivePasses();
+	TestSmallInputs();
+	TestSmallScratchThrows();
+	return TestResult();
+}
@@ -0,0 +1,60 @@
+#include "slot_mask.hpp"
+#include "test_common.hpp"
+#include <random>
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+// Compares the bit scan range walk against a per slot loop, for sparse, clustered and dense masks.
+int main()
+{
+	constexpr uint64_t Iterations = 2'000'000;
+	std::mt19937_64 random(42);
+
+	struct Case
+	{
+		const char* name;
+		SlotMask mask;
+	};
+
+	Case cases[3];
+	cases[0].name = "sparse (4 slots)";
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		cases[0].mask.Set(static_cast<uint32_t>(random() % SlotMask::MaxSlots));
+	}
+	cases[1].name = "clustered (3 runs)";
+	cases[1].mask.SetRange(0, 8);
+	cases[1].mask.SetRange(60, 8);
+	cases[1].mask.SetRange(100, 16);
+	cases[2].name = "dense (random)";
+	cases[2].mask.words[0] = random();
+	cases[2].mask.words[1] = random();
+
+	char name[64];
+	for (const auto& test : cases)
+	{
+		std::snprintf(name, sizeof(name), "ForEachRange %s", test.name);
+		Benchmark(name, Iterations, [&](uint64_t i)
+		{
+			uint32_t sum = 0;
+			SlotMask mask = test.mask;
+			mask.words[0] ^= i & 1;
+			mask.ForEachRange([&](const SlotRange& range) { sum += range.start + range.length; });
+			DoNotOptimize(sum);
+		});
+
+		std::snprintf(name, sizeof(name), "per slot loop %s", test.name);
+		Benchmark(name, Iterations, [&](uint64_t i)
+		{
+			uint32_t sum = 0;
+			SlotMask mask = test.mask;
+			mask.words[0] ^= i & 1;
+			for (uint32_t slot = 0; slot < SlotMask::MaxSlots; slot++)
+			{
+				sum += mask.Test(slot) ? slot : 0;
+			}
+			DoNotOptimize(sum);
+		});
+	}
+	return 0;
+}
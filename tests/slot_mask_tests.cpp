@@ -0,0 +1,155 @@
+#include "slot_mask.hpp"
+#include "test_common.hpp"
+#include <random>
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+static std::vector<SlotRange> CollectRanges(const SlotMask& mask)
+{
+	std::vector<SlotRange> ranges;
+	mask.ForEachRange([&](const SlotRange& range) { ranges.push_back(range); });
+	return ranges;
+}
+
+// Reference: walks the slots one by one.
+static std::vector<SlotRange> ReferenceRanges(const SlotMask& mask)
+{
+	std::vector<SlotRange> ranges;
+	for (uint32_t slot = 0; slot < SlotMask::MaxSlots; slot++)
+	{
+		if (!mask.Test(slot))
+		{
+			continue;
+		}
+		if (!ranges.empty() && ranges.back().start + ranges.back().length == slot)
+		{
+			ranges.back().length++;
+		}
+		else
+		{
+			ranges.push_back({ slot, 1 });
+		}
+	}
+	return ranges;
+}
+
+static bool SameRanges(const std::vector<SlotRange>& a, const std::vector<SlotRange>& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (a[i].start != b[i].start || a[i].length != b[i].length)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static SlotMask FromRange(uint32_t start, uint32_t length)
+{
+	SlotMask mask;
+	mask.SetRange(start, length);
+	return mask;
+}
+
+static void TestWordBoundaries()
+{
+	// Single slots at the edges of both words.
+	for (uint32_t slot : { 0u, 63u, 64u, 127u })
+	{
+		SlotMask mask;
+		mask.Set(slot);
+		const auto ranges = CollectRanges(mask);
+		CHECK(ranges.size() == 1 && ranges[0].start == slot && ranges[0].length == 1);
+		CHECK(mask.Count() == 1);
+	}
+
+	// A run crossing from the first word into the second is reported once.
+	{
+		const auto ranges = CollectRanges(FromRange(60, 10));
+		CHECK(ranges.size() == 1 && ranges[0].start == 60 && ranges[0].length == 10);
+	}
+
+	// 63 and 64 are adjacent across the word boundary.
+	{
+		SlotMask mask;
+		mask.Set(63);
+		mask.Set(64);
+		const auto ranges = CollectRanges(mask);
+		CHECK(ranges.size() == 1 && ranges[0].start == 63 && ranges[0].length == 2);
+	}
+
+	// A full word and a full mask.
+	{
+		const auto ranges = CollectRanges(FromRange(0, 64));
+		CHECK(ranges.size() == 1 && ranges[0].start == 0 && ranges[0].length == 64);
+	}
+	{
+		const auto ranges = CollectRanges(FromRange(64, 64));
+		CHECK(ranges.size() == 1 && ranges[0].start == 64 && ranges[0].length == 64);
+	}
+	{
+		const auto ranges = CollectRanges(FromRange(0, SlotMask::MaxSlots));
+		CHECK(ranges.size() == 1 && ranges[0].start == 0 && ranges[0].length == SlotMask::MaxSlots);
+	}
+
+	// Searching from inside or past a run.
+	{
+		const SlotMask mask = FromRange(62, 4);
+		SlotRange range{};
+		CHECK(mask.NextRange(64, range) && range.start == 64 && range.length == 2);
+		CHECK(!mask.NextRange(66, range));
+		CHECK(!mask.NextRange(SlotMask::MaxSlots, range));
+	}
+
+	CHECK(CollectRanges(SlotMask{}).empty());
+	CHECK(!SlotMask{}.Any());
+}
+
+static void TestShifts()
+{
+	const SlotMask mask = FromRange(60, 8);
+	CHECK((mask << 4) == FromRange(64, 8));
+	CHECK((mask >> 4) == FromRange(56, 8));
+	CHECK((mask << 64) == FromRange(124, 4));
+	CHECK((mask >> 64) == FromRange(0, 4));
+	CHECK((FromRange(120, 8) >> 64) == FromRange(56, 8));
+	CHECK((mask << 0) == mask);
+	CHECK((mask >> 0) == mask);
+	CHECK((FromRange(0, 1) << 127) == FromRange(127, 1));
+	CHECK((FromRange(127, 1) >> 127) == FromRange(0, 1));
+	CHECK((~SlotMask{}).Count() == SlotMask::MaxSlots);
+}
+
+static void TestRandomAgainstReference()
+{
+	std::mt19937_64 random(1234);
+	for (int i = 0; i < 20000; i++)
+	{
+		SlotMask mask;
+		// Mix sparse and dense masks so both long runs and isolated bits show up.
+		const uint64_t sparse = random() & random();
+		mask.words[0] = (i & 1) ? random() | random() : sparse;
+		mask.words[1] = (i & 2) ? random() | random() : random() & random();
+		CHECK(SameRanges(CollectRanges(mask), ReferenceRanges(mask)));
+
+		const uint32_t shift = static_cast<uint32_t>(random() % SlotMask::MaxSlots);
+		const SlotMask shifted = mask << shift;
+		for (uint32_t slot = 0; slot < SlotMask::MaxSlots; slot++)
+		{
+			CHECK(shifted.Test(slot) == (slot >= shift && mask.Test(slot - shift)));
+		}
+	}
+}
+
+int main()
+{
+	TestWordBoundaries();
+	TestShifts();
+	TestRandomAgainstReference();
+	return TestResult();
+}
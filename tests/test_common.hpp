@@ -0,0 +1,76 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Minimal check harness: a failed check prints its location and the test executable exits with a failure code.
+inline int& TestFailureCount()
+{
+	static int count = 0;
+	return count;
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			TestFailureCount()++; \
+		} \
+	} while (false)
+
+#define CHECK_THROWS(expression) \
+	do \
+	{ \
+		bool thrown = false; \
+		try \
+		{ \
+			expression; \
+		} \
+		catch (...) \
+		{ \
+			thrown = true; \
+		} \
+		if (!thrown) \
+		{ \
+			std::printf("%s:%d: expected an exception: %s\n", __FILE__, __LINE__, #expression); \
+			TestFailureCount()++; \
+		} \
+	} while (false)
+
+inline int TestResult()
+{
+	if (TestFailureCount() != 0)
+	{
+		std::printf("%d check(s) failed\n", TestFailureCount());
+		return 1;
+	}
+	return 0;
+}
+
+// Runs 'body' 'iterations' times and prints the average time per iteration.
+template<typename TBody>
+void Benchmark(const char* name, uint64_t iterations, TBody&& body)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		body(i);
+	}
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%-40s %10.2f ns/op\n", name, elapsed / static_cast<double>(iterations));
+}
+
+// Keeps the optimizer from dropping a computed value.
+template<typename T>
+void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	static volatile T sink;
+	sink = value;
+	(void)sink;
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
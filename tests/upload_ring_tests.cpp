@@ -0,0 +1,138 @@
+#include "upload_ring.hpp"
+#include "test_common.hpp"
+
+using namespace HEXA_PRISM_NAMESPACE;
+
+static void TestInvalidAlignmentThrows()
+{
+	CHECK_THROWS(UploadRing(1024, 0));
+	CHECK_THROWS(UploadRing(1024, 48));
+}
+
+static void TestFirstAllocationDiscards()
+{
+	UploadRing ring(1024, 256);
+	UploadRingAllocation allocation;
+
+	CHECK(ring.Allocate(16, allocation));
+	CHECK(allocation.discard);
+	CHECK(allocation.offset == 0);
+	CHECK(allocation.size == 256);
+
+	CHECK(ring.Allocate(16, allocation));
+	CHECK(!allocation.discard);
+	CHECK(allocation.offset == 256);
+	CHECK(ring.GetDiscardCount() == 1);
+	CHECK(ring.GetAllocationCount() == 2);
+}
+
+static void TestSizesAndOffsetsAreAligned()
+{
+	UploadRing ring(4096, 256);
+	UploadRingAllocation allocation;
+
+	const uint32_t sizes[] = { 1, 255, 256, 257, 511, 512, 1000 };
+	uint32_t expectedOffset = 0;
+	for (uint32_t size : sizes)
+	{
+		CHECK(ring.Allocate(size, allocation));
+		CHECK(allocation.offset % 256 == 0);
+		CHECK(allocation.size % 256 == 0);
+		CHECK(allocation.size >= size && allocation.size - size < 256);
+		CHECK(allocation.offset == expectedOffset);
+		expectedOffset += allocation.size;
+	}
+	CHECK(ring.GetHead() == expectedOffset);
+}
+
+static void TestWrapDiscardsAndRestartsAtZero()
+{
+	UploadRing ring(1024, 256);
+	UploadRingAllocation allocation;
+
+	CHECK(ring.Allocate(512, allocation));
+	CHECK(ring.Allocate(256, allocation));
+	CHECK(allocation.offset == 512 && !allocation.discard);
+
+	// 512 more bytes do not fit behind the head at 768.
+	CHECK(ring.Allocate(512, allocation));
+	CHECK(allocation.discard);
+	CHECK(allocation.offset == 0);
+	CHECK(ring.GetHead() == 512);
+	CHECK(ring.GetDiscardCount() == 2);
+
+	// An allocation ending exactly at the capacity still fits.
+	CHECK(ring.Allocate(512, allocation));
+	CHECK(!allocation.discard);
+	CHECK(allocation.offset == 512);
+	CHECK(ring.GetHead() == 1024);
+
+	CHECK(ring.Allocate(1, allocation));
+	CHECK(allocation.discard && allocation.offset == 0);
+}
+
+static void TestOversizedAllocationsFail()
+{
+	UploadRing ring(1024, 256);
+	UploadRingAllocation allocation;
+
+	CHECK(!ring.Allocate(0, allocation));
+	CHECK(!ring.Allocate(1025, allocation));
+	CHECK(!ring.Allocate(UINT32_MAX, allocation));
+	CHECK(ring.GetAllocationCount() == 0);
+
+	CHECK(ring.Allocate(1024, allocation));
+	CHECK(allocation.discard && allocation.size == 1024);
+}
+
+static void TestResetForcesDiscard()
+{
+	UploadRing ring(1024, 256);
+	UploadRingAllocation allocation;
+
+	CHECK(ring.Allocate(256, allocation));
+	CHECK(ring.Allocate(256, allocation));
+	ring.Reset();
+	CHECK(ring.GetHead() == 0);
+
+	CHECK(ring.Allocate(256, allocation));
+	CHECK(allocation.discard && allocation.offset == 0);
+	CHECK(ring.GetDiscardCount() == 2);
+}
+
+static void TestAllocationsBetweenDiscardsNeverOverlap()
+{
+	UploadRing ring(64 * 1024, 256);
+	UploadRingAllocation allocation;
+
+	uint32_t state = 12345;
+	uint32_t lastEnd = 0;
+	for (int i = 0; i < 10000; i++)
+	{
+		state = state * 1664525u + 1013904223u;
+		const uint32_t size = 1 + (state >> 8) % 4096;
+		CHECK(ring.Allocate(size, allocation));
+		CHECK(allocation.offset + allocation.size <= ring.GetCapacity());
+		if (allocation.discard)
+		{
+			CHECK(allocation.offset == 0);
+		}
+		else
+		{
+			CHECK(allocation.offset >= lastEnd);
+		}
+		lastEnd = allocation.offset + allocation.size;
+	}
+}
+
+int main()
+{
+	TestInvalidAlignmentThrows();
+	TestFirstAllocationDiscards();
+	TestSizesAndOffsetsAreAligned();
+	TestWrapDiscardsAndRestartsAtZero();
+	TestOversizedAllocationsFail();
+	TestResetForcesDiscard();
+	TestAllocationsBetweenDiscardsNeverOverlap();
+	return TestResult();
+}